@@ -97,6 +97,14 @@ void sunxi_ss_open(void);
 void sunxi_ss_close(void);
 int  sunxi_sha_calc(u8 *dst_addr, u32 dst_len,
 					u8 *src_addr, u32 src_len);
+#ifdef CONFIG_SUNXI_CE_23
+/* sha256 on the CE whatever the size, sunxi_sha_calc() may use the cpu */
+int sunxi_sha_calc_ce(u8 *dst_addr, u32 dst_len, u8 *src_addr, u32 src_len);
+#endif
+#ifdef CONFIG_SUNXI_CE_SHA_DISPATCH
+/* measure the cpu/CE crossover of sunxi_sha_calc(), use and return it */
+u32 sunxi_sha_calibrate(void);
+#endif
 int sunxi_md5_calc(u8 *dst_addr, u32 dst_len, u8 *src_addr, u32 src_len);
 int sunxi_hash_test(u8 *dst_addr, u32 dst_len,
 					u8 *src_addr, u32 src_leni, u32 sha_type);
@@ -112,6 +120,53 @@ s32 sunxi_sm2_sign_verify_test(struct sunxi_sm2_ctx_t *sm2_ctx);
 s32 sm2_crypto_gen_cxy_kxy(struct sunxi_sm2_ctx_t *sm2_ctx);
 s32 sm2_ecdh_gen_key_rx_ry(struct sunxi_sm2_ctx_t *sm2_ctx, int flag);
 s32 sm2_ecdh_gen_ux_uy(struct sunxi_sm2_ctx_t *sm2_ctx);
+
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+/* one task takes the carried over tail and up to this many entries */
+#define SUNXI_HASH_SG_MAX	(7)
+#define SUNXI_HASH_BLOCK_MAX	(128)
+
+struct sunxi_ce_hash_sg {
+	void *addr;
+	u32 len;
+};
+
+/*
+ * state of an incremental hash. the engine reads iv and tail and writes
+ * state while a task is running, so keep them on their own cache lines.
+ */
+struct sunxi_ce_hash_ctx {
+	struct hash_task_descriptor task __aligned(CACHE_LINE_SIZE);
+	u8 state[CACHE_LINE_SIZE] __aligned(CACHE_LINE_SIZE);
+	u8 iv[CACHE_LINE_SIZE] __aligned(CACHE_LINE_SIZE);
+	u8 tail[2][SUNXI_HASH_BLOCK_MAX] __aligned(CACHE_LINE_SIZE);
+	int cur;		/* tail[cur] holds the bytes short of a block */
+	u32 tail_len;
+	u64 total;		/* bytes handed to the engine so far */
+	u32 type;		/* SUNXI_SHA256, SUNXI_SM3, ... */
+	u32 block;
+	u32 md_size;
+	int chained;		/* state holds the hash of a previous task */
+	int busy;
+};
+
+int sunxi_ce_hash_init(struct sunxi_ce_hash_ctx *ctx, u32 type);
+/*
+ * queue sg[0..nents) behind what was hashed so far and return without
+ * waiting for the engine. only whole blocks go to the engine, the last
+ * block (or what is short of one) is copied into the context straight
+ * away, so the buffers may be reused once sunxi_ce_hash_poll() reported
+ * the task done. entries must start on a word boundary.
+ */
+int sunxi_ce_hash_update_async(struct sunxi_ce_hash_ctx *ctx,
+			       const struct sunxi_ce_hash_sg *sg, int nents);
+/* 1 while the engine is busy, 0 once the task is done, < 0 on error */
+int sunxi_ce_hash_poll(struct sunxi_ce_hash_ctx *ctx);
+int sunxi_ce_hash_wait(struct sunxi_ce_hash_ctx *ctx);
+int sunxi_ce_hash_update(struct sunxi_ce_hash_ctx *ctx, void *buf, u32 len);
+/* pad and hash what is left, the message must not be empty */
+int sunxi_ce_hash_final(struct sunxi_ce_hash_ctx *ctx, u8 *dst);
+#endif
 #endif
 
 #endif /* _SUNXI_CE_H */
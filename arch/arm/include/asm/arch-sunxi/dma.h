@@ -191,6 +191,7 @@ int sunxi_dma_release(unsigned long hdma);
 int sunxi_dma_setting(unsigned long hdma, sunxi_dma_set *cfg);
 int sunxi_dma_start(unsigned long hdma, unsigned int saddr, unsigned int daddr,
 		    unsigned int bytes);
+int sunxi_dma_start_desc(unsigned long hdma, sunxi_dma_desc *desc);
 int sunxi_dma_stop(unsigned long hdma);
 int sunxi_dma_querystatus(unsigned long hdma);
 
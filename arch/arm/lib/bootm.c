@@ -31,6 +31,7 @@
 #include <asm/armv7.h>
 #endif
 #include <asm/setup.h>
+#include <sunxi_boot_record.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -86,6 +87,10 @@ __weak void board_quiesce_devices(void)
  */
 static void announce_and_cleanup(int fake)
 {
+	sunxi_boot_record(BOOT_REC_HANDOFF, sunxi_boot_record_begin(), 0, 0);
+	if (!fake)
+		sunxi_boot_record_save();
+
 	pr_emerg("Starting kernel ...%s\n\n", fake ?
 		"(fake run for tracing)" : "");
 	bootstage_mark_name(BOOTSTAGE_ID_BOOTM_HANDOFF, "start_kernel");
@@ -228,11 +233,14 @@ static void boot_prep_linux(bootm_headers_t *images)
 
 	if (IMAGE_ENABLE_OF_LIBFDT && images->ft_len) {
 #ifdef CONFIG_OF_LIBFDT
+		ulong rec = sunxi_boot_record_begin();
+
 		debug("using: FDT\n");
 		if (image_setup_linux(images)) {
 			printf("FDT creation failed! hanging...");
 			hang();
 		}
+		sunxi_boot_record(BOOT_REC_FDT_FIXUP, rec, images->ft_len, 0);
 #endif
 	} else if (BOOTM_ENABLE_TAGS) {
 		debug("using: ATAGS\n");
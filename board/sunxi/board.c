@@ -39,6 +39,7 @@
 #include <private_uboot.h>
 #include <sys_config.h>
 #include <sunxi_board.h>
+#include <sunxi_boot_record.h>
 #ifdef CONFIG_SUNXI_POWER
 #include <sunxi_power/axp.h>
 #include <sunxi_power/power_manage.h>
@@ -459,6 +460,10 @@ int ft_board_setup(void *blob, bd_t *bd)
 	 */
 	setup_environment(blob);
 
+	r = sunxi_boot_record_fdt_reserve(blob);
+	if (r)
+		return r;
+
 #ifdef CONFIG_VIDEO_DT_SIMPLEFB
 	r = sunxi_simplefb_setup(blob);
 	if (r)
@@ -61,6 +61,7 @@
 #endif
 #include <fastlogo.h>
 #include <sunxi_eink.h>
+#include <sunxi_boot_record.h>
 
 int  __attribute__((weak)) sunxi_platform_power_off(void)
 {
@@ -639,7 +640,10 @@ int board_env_late_init(void)
 
 #ifdef CONFIG_BOOT_GUI
 		void board_bootlogo_display(void);
+		ulong rec = sunxi_boot_record_begin();
+
 		board_bootlogo_display();
+		sunxi_boot_record(BOOT_REC_LOGO, rec, 0, 0);
 #else
 #ifdef CONFIG_SUNXI_SPINOR_JPEG
 		int sunxi_jpeg_display(const char *filename);
@@ -798,6 +802,7 @@ int board_late_init(void)
 			p_fastlogo->reserve_memory(p_fastlogo);
 		}
 #endif
+		sys_config_lookup_report();
 	}
 	return 0;
 }
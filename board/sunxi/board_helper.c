@@ -11,6 +11,7 @@
 #include <sunxi_board.h>
 #include <sunxi_flash.h>
 #include <fdt_support.h>
+#include <fdt_batch.h>
 #include <blk.h>
 #include <part.h>
 #include <asm/arch/rtc.h>
@@ -49,9 +50,10 @@ int disp_update_lcd_param(int lcd_param_index);
 int update_fdt_dram_para(void *dtb_base)
 {
 	/*fix dram para*/
-	int i, nodeoffset = 0;
+	int i, nodeoffset = 0, ret;
 	char dram_str[16] = {0};
 	uint32_t *dram_para = NULL;
+	struct fdt_batch batch;
 	dram_para = (uint32_t *)uboot_spare_head.boot_data.dram_para;
 
 	pr_msg("(weak)update dtb dram start\n");
@@ -61,27 +63,33 @@ int update_fdt_dram_para(void *dtb_base)
 		return -1;
 	}
 
-	nodeoffset = fdt_path_offset(dtb_base, "/dram");
+	fdt_batch_begin(&batch, dtb_base);
+	nodeoffset = fdt_batch_path_offset(&batch, "/dram");
 	if (nodeoffset < 0) {
 		pr_err("## error: %s : %s\n", __func__, fdt_strerror(nodeoffset));
+		fdt_batch_abort(&batch);
 		return -1;
 	}
 	for (i = 31; i >= 0; i--) {
 		sprintf(dram_str, "dram_para[%02d]", i);
-		fdt_setprop_u32(dtb_base, nodeoffset, dram_str, dram_para[i]);
+		fdt_batch_setprop_u32(&batch, "/dram", dram_str, dram_para[i]);
+	}
+	ret = fdt_batch_apply(&batch, gd->fdt_size);
+	/* the batch rebuilds the blob, node offsets all move */
+	sys_config_cache_invalidate();
+	if (ret) {
+		pr_err("## error: %s : %s\n", __func__, fdt_strerror(ret));
+		return -1;
 	}
 	pr_msg("update dtb dram  end\n");
 	return 0;
 }
 
-static int fdt_enable_node(char *name, int onoff)
+static int fdt_enable_node(struct fdt_batch *batch, char *name, int onoff)
 {
-	int nodeoffset = 0;
 	int ret = 0;
 
-	nodeoffset = fdt_path_offset(working_fdt, name);
-	ret = fdt_set_node_status(working_fdt, nodeoffset,
-		onoff ? FDT_STATUS_OKAY: FDT_STATUS_DISABLED, 0);
+	ret = fdt_batch_enable_node(batch, name, onoff);
 
 	if (ret < 0) {
 		printf("disable nand error: %s\n", fdt_strerror(ret));
@@ -703,6 +711,9 @@ int sunxi_update_fdt_para_for_kernel(void)
 {
 	uint storage_type = 0;
 	__maybe_unused int ret = 0;
+	__maybe_unused int dragonboard = 0;
+	struct fdt_batch batch;
+	int nr_ops;
 #ifdef CONFIG_SUNXI_SDMMC
 	struct mmc *mmc = NULL;
 	int dev_num = 0;
@@ -731,76 +742,6 @@ int sunxi_update_fdt_para_for_kernel(void)
 		}
 	}
 #endif
-	/* creat udc dbt para when in charger_mode */
-	if (gd->chargemode == 1) {
-		fdt_find_and_setprop(working_fdt, "/soc/udc-controller",
-					"charger_mode", NULL, 0, 1);
-	}
-
-	/* fix nand&sdmmc */
-	switch (storage_type) {
-	case STORAGE_NAND:
-		fdt_enable_node("nand0", 1);
-		fdt_enable_node("spi0", 0);
-		break;
-	case STORAGE_SPI_NAND:
-#ifdef CONFIG_SUNXI_UBIFS
-#ifdef CONFIG_MACH_SUN8IW18
-		if (nand_use_ubi() == 0) {
-			/* sun8iw18 aw-nftl config */
-			fdt_enable_node("spinand", 1);
-			fdt_enable_node("spi0", 0);
-		}
-#else
-		/* sun50iw11 config */
-		fdt_enable_node("spi0", 1);
-		fdt_enable_node("/soc/spi/spi-nand", 1);
-#endif
-#else
-		/* legacy config */
-		fdt_enable_node("spinand", 1);
-		fdt_enable_node("spi0", 0);
-#endif
-		break;
-	case STORAGE_EMMC:
-		fdt_enable_node("mmc2", 1);
-		fdt_enable_node("sunxi-mmc2", 1);
-		break;
-	case STORAGE_EMMC0:
-		fdt_enable_node("mmc0", 1);
-		fdt_enable_node("sunxi-mmc0", 1);
-		break;
-	case STORAGE_EMMC3:
-		fdt_enable_node("mmc3", 1);
-		fdt_enable_node("sunxi-mmc3", 1);
-		break;
-	case STORAGE_SD:
-		fdt_enable_node("mmc0", 1);
-		fdt_enable_node("sunxi-mmc0", 1);
-		{
-			uint32_t dragonboard_test = 0;
-			script_parser_fetch("/soc/target", "dragonboard_test",
-						(int *)&dragonboard_test, 0);
-			if (dragonboard_test == 1) {
-				fdt_enable_node("mmc2", 1);
-				fdt_enable_node("sunxi-mmc2", 1);
-#ifdef CONFIG_SUNXI_SDMMC
-				mmc_update_config_for_dragonboard(2);
-#ifdef CONFIG_MMC3_SUPPORT
-				mmc_update_config_for_dragonboard(3);
-#endif
-#endif
-			}
-		}
-		break;
-	case STORAGE_NOR:
-		fdt_enable_node("/soc/spi", 1);
-		fdt_enable_node("/soc/spi/spi_board0", 1);
-		break;
-	default:
-		break;
-	}
-
 #if defined(CONFIG_SUNXI_DRM_SUPPORT)
 	ulong drm_base = 0, drm_size = 0;
 	if (gd->securemode == SUNXI_SECURE_MODE_WITH_SECUREOS) {
@@ -844,12 +785,85 @@ int sunxi_update_fdt_para_for_kernel(void)
 			pr_err("##add mem rsv error: %s : %s\n", __func__,
 			       fdt_strerror(ret));
 	}
+	/*
+	 * property changes below are queued and written out in one go,
+	 * nothing else may touch working_fdt until the batch is applied
+	 */
+	fdt_batch_begin(&batch, working_fdt);
+
+	/* creat udc dbt para when in charger_mode */
+	if (gd->chargemode == 1) {
+		fdt_batch_setprop(&batch, "/soc/udc-controller",
+				  "charger_mode", NULL, 0);
+	}
+
+	/* fix nand&sdmmc */
+	switch (storage_type) {
+	case STORAGE_NAND:
+		fdt_enable_node(&batch, "nand0", 1);
+		fdt_enable_node(&batch, "spi0", 0);
+		break;
+	case STORAGE_SPI_NAND:
+#ifdef CONFIG_SUNXI_UBIFS
+#ifdef CONFIG_MACH_SUN8IW18
+		if (nand_use_ubi() == 0) {
+			/* sun8iw18 aw-nftl config */
+			fdt_enable_node(&batch, "spinand", 1);
+			fdt_enable_node(&batch, "spi0", 0);
+		}
+#else
+		/* sun50iw11 config */
+		fdt_enable_node(&batch, "spi0", 1);
+		fdt_enable_node(&batch, "/soc/spi/spi-nand", 1);
+#endif
+#else
+		/* legacy config */
+		fdt_enable_node(&batch, "spinand", 1);
+		fdt_enable_node(&batch, "spi0", 0);
+#endif
+		break;
+	case STORAGE_EMMC:
+		fdt_enable_node(&batch, "mmc2", 1);
+		fdt_enable_node(&batch, "sunxi-mmc2", 1);
+		break;
+	case STORAGE_EMMC0:
+		fdt_enable_node(&batch, "mmc0", 1);
+		fdt_enable_node(&batch, "sunxi-mmc0", 1);
+		break;
+	case STORAGE_EMMC3:
+		fdt_enable_node(&batch, "mmc3", 1);
+		fdt_enable_node(&batch, "sunxi-mmc3", 1);
+		break;
+	case STORAGE_SD:
+		fdt_enable_node(&batch, "mmc0", 1);
+		fdt_enable_node(&batch, "sunxi-mmc0", 1);
+		{
+			uint32_t dragonboard_test = 0;
+			script_parser_fetch("/soc/target", "dragonboard_test",
+						(int *)&dragonboard_test, 0);
+			if (dragonboard_test == 1) {
+				fdt_enable_node(&batch, "mmc2", 1);
+				fdt_enable_node(&batch, "sunxi-mmc2", 1);
+				dragonboard = 1;
+			}
+		}
+		break;
+	case STORAGE_NOR:
+		fdt_enable_node(&batch, "/soc/spi", 1);
+		fdt_enable_node(&batch, "/soc/spi/spi_board0", 1);
+		break;
+	default:
+		break;
+	}
+
 #ifdef CONFIG_SPI_SAMP_DL_EN
 	int nodeoffset = 0;
-	nodeoffset = fdt_path_offset(working_fdt, "spi0");
+	const char *spi_node = "spi0";
+	nodeoffset = fdt_batch_path_offset(&batch, spi_node);
 	if (nodeoffset < 0) {
 		pr_err("## error: %s : %s\n", __func__,
 				fdt_strerror(nodeoffset));
+		fdt_batch_abort(&batch);
 		return -1;
 	}
 
@@ -859,18 +873,20 @@ int sunxi_update_fdt_para_for_kernel(void)
 	{
 #ifdef CONFIG_SUNXI_SPIF
 		struct sunxi_spif_slave *sspi = get_sspif();
-		nodeoffset = fdt_path_offset(working_fdt, "spif");
+		spi_node = "spif";
+		nodeoffset = fdt_batch_path_offset(&batch, spi_node);
 		if (nodeoffset < 0) {
 			pr_err("## error: %s : %s\n", __func__,
 					fdt_strerror(nodeoffset));
+			fdt_batch_abort(&batch);
 			return -1;
 		}
 #else
 		struct sunxi_spi_slave *sspi = get_sspi();
 #endif
-		fdt_setprop_u32(working_fdt, nodeoffset,
+		fdt_batch_setprop_u32(&batch, spi_node,
 				"sample_mode", sspi->right_sample_mode);
-		fdt_setprop_u32(working_fdt, nodeoffset,
+		fdt_batch_setprop_u32(&batch, spi_node,
 				"sample_delay", sspi->right_sample_delay);
 		pr_msg("spinor update sample_mode:%x right_sample_mod:%x\n",
 				sspi->right_sample_mode,
@@ -882,9 +898,9 @@ int sunxi_update_fdt_para_for_kernel(void)
 #ifdef CONFIG_SUNXI_NAND
 	{
 		struct aw_spinand *spinand = get_spinand();
-		fdt_setprop_u32(working_fdt, nodeoffset,
+		fdt_batch_setprop_u32(&batch, spi_node,
 				"sample_mode", spinand->right_sample_mode);
-		fdt_setprop_u32(working_fdt, nodeoffset,
+		fdt_batch_setprop_u32(&batch, spi_node,
 				"sample_delay", spinand->right_sample_delay);
 		pr_msg("spinand update sample_mode:%x right_sample_mod:%x\n",
 				spinand->right_sample_mode,
@@ -899,6 +915,22 @@ int sunxi_update_fdt_para_for_kernel(void)
 
 #endif /* CONFIG_SPI_SAMP_DL_EN */
 
+	nr_ops = batch.nr_ops;
+	ret = fdt_batch_apply(&batch, gd->fdt_size);
+	sys_config_cache_invalidate();
+	if (ret)
+		pr_err("## error: %s : %s\n", __func__, fdt_strerror(ret));
+	pr_msg("fdt fixup: %d props in %lu us\n", nr_ops, batch.apply_us);
+
+#ifdef CONFIG_SUNXI_SDMMC
+	if (dragonboard) {
+		mmc_update_config_for_dragonboard(2);
+#ifdef CONFIG_MMC3_SUPPORT
+		mmc_update_config_for_dragonboard(3);
+#endif
+	}
+#endif
+
 	/* fix dram para */
 	update_fdt_dram_para(working_fdt);
 #ifdef CONFIG_SUNXI_SPINOR_JPEG
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * (C) Copyright 2007-2026
+ * Allwinner Technology Co., Ltd. <www.allwinnertech.com>
+ *
+ * Boot stage record ring, see include/sunxi_boot_record.h.
+ *
+ * With CONFIG_SUNXI_BOOT_RECORD_ADDR the ring lives in dram that is also
+ * reserved in the kernel fdt, so it is still valid after a warm reboot.
+ * Without it the ring is a u-boot static and only the flash copy, if
+ * any, carries older runs over.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <linux/libfdt.h>
+#include <sunxi_flash.h>
+#include <sys_partition.h>
+#include <sunxi_boot_record.h>
+
+static const char * const boot_rec_names[BOOT_REC_MAX] = {
+	[BOOT_REC_NONE]		= "none",
+	[BOOT_REC_FLASH_PROBE]	= "flash_probe",
+	[BOOT_REC_GPT_PARSE]	= "gpt_parse",
+	[BOOT_REC_ENV]		= "env",
+	[BOOT_REC_LOGO]		= "logo",
+	[BOOT_REC_IMAGE_READ]	= "image_read",
+	[BOOT_REC_VERIFY]	= "verify",
+	[BOOT_REC_DECOMP]	= "decompress",
+	[BOOT_REC_FDT_FIXUP]	= "fdt_fixup",
+	[BOOT_REC_HANDOFF]	= "handoff",
+};
+
+static struct sunxi_boot_rec_ring *ring;
+/* the dram ring was rebuilt this boot, older runs can only be on flash */
+static int ring_cold;
+
+#if !CONFIG_SUNXI_BOOT_RECORD_ADDR
+static __attribute__((section(".data")))
+u8 ring_buf[SUNXI_BOOT_REC_SIZE] __aligned(ARCH_DMA_MINALIGN);
+#endif
+
+static int boot_rec_valid(struct sunxi_boot_rec_ring *r)
+{
+	return r->magic == SUNXI_BOOT_REC_MAGIC &&
+	       r->version == SUNXI_BOOT_REC_VERSION &&
+	       r->nr_runs == SUNXI_BOOT_REC_RUNS &&
+	       r->nr_recs == SUNXI_BOOT_REC_PER_RUN &&
+	       r->cur < SUNXI_BOOT_REC_RUNS;
+}
+
+static const char *boot_rec_name(int stage)
+{
+	if (stage < 0 || stage >= BOOT_REC_MAX)
+		return "unknown";
+
+	return boot_rec_names[stage];
+}
+
+int sunxi_boot_record_init(void)
+{
+	struct sunxi_boot_run *run;
+
+	BUILD_BUG_ON(sizeof(struct sunxi_boot_rec_ring) > SUNXI_BOOT_REC_SIZE);
+
+	if (ring)
+		return 0;
+
+#if CONFIG_SUNXI_BOOT_RECORD_ADDR
+	ring = (struct sunxi_boot_rec_ring *)CONFIG_SUNXI_BOOT_RECORD_ADDR;
+	sunxi_mem_info("boot_record", ring, SUNXI_BOOT_REC_SIZE);
+#else
+	ring = (struct sunxi_boot_rec_ring *)ring_buf;
+#endif
+	if (!boot_rec_valid(ring)) {
+		memset(ring, 0, SUNXI_BOOT_REC_SIZE);
+		ring->magic   = SUNXI_BOOT_REC_MAGIC;
+		ring->version = SUNXI_BOOT_REC_VERSION;
+		ring->nr_runs = SUNXI_BOOT_REC_RUNS;
+		ring->nr_recs = SUNXI_BOOT_REC_PER_RUN;
+		ring->cur     = SUNXI_BOOT_REC_RUNS - 1;
+		ring_cold     = 1;
+	}
+
+	ring->cur = (ring->cur + 1) % SUNXI_BOOT_REC_RUNS;
+	run = &ring->runs[ring->cur];
+	memset(run, 0, sizeof(*run));
+	run->seq = ++ring->seq;
+
+	return 0;
+}
+
+ulong sunxi_boot_record_begin(void)
+{
+	return timer_get_us();
+}
+
+void sunxi_boot_record(int stage, ulong start, ulong bytes, int err)
+{
+	struct sunxi_boot_run *run;
+	struct sunxi_boot_rec *rec;
+
+	if (!ring)
+		return;
+
+	run = &ring->runs[ring->cur];
+	if (run->count >= SUNXI_BOOT_REC_PER_RUN) {
+		run->lost++;
+		return;
+	}
+
+	rec = &run->recs[run->count++];
+	rec->stage    = stage;
+	rec->flags    = err ? SUNXI_BOOT_REC_FAIL : 0;
+	rec->start_us = start;
+	rec->time_us  = timer_get_us() - start;
+	rec->bytes    = bytes;
+}
+
+static int boot_rec_part(uint *start)
+{
+	uint size;
+
+	if (!CONFIG_SUNXI_BOOT_RECORD_PART[0])
+		return -1;
+	if (sunxi_partition_get_info_byname(CONFIG_SUNXI_BOOT_RECORD_PART,
+					    start, &size))
+		return -1;
+	if (size < SUNXI_BOOT_REC_SIZE / 512) {
+		pr_err("boot record: partition %s too small\n",
+		       CONFIG_SUNXI_BOOT_RECORD_PART);
+		return -1;
+	}
+
+	return 0;
+}
+
+int sunxi_boot_record_load(void)
+{
+	struct sunxi_boot_rec_ring *old;
+	uint start;
+	int slot;
+
+	if (!ring || !ring_cold)
+		return 0;
+	ring_cold = 0;
+	if (boot_rec_part(&start))
+		return 0;
+
+	old = malloc_cache_aligned(SUNXI_BOOT_REC_SIZE);
+	if (!old)
+		return -1;
+
+	if (sunxi_flash_read(start, SUNXI_BOOT_REC_SIZE / 512, old) &&
+	    boot_rec_valid(old)) {
+		/* this boot becomes the run after the newest one on flash */
+		slot = (old->cur + 1) % SUNXI_BOOT_REC_RUNS;
+		old->runs[slot] = ring->runs[ring->cur];
+		old->runs[slot].seq = ++old->seq;
+		old->cur = slot;
+		memcpy(ring, old, SUNXI_BOOT_REC_SIZE);
+	}
+	free(old);
+
+	return 0;
+}
+
+int sunxi_boot_record_save(void)
+{
+	uint start;
+
+	if (!ring)
+		return 0;
+
+	flush_cache((ulong)ring, SUNXI_BOOT_REC_SIZE);
+	if (boot_rec_part(&start))
+		return 0;
+
+	if (!sunxi_flash_write(start, SUNXI_BOOT_REC_SIZE / 512, ring)) {
+		pr_err("boot record: write %s failed\n",
+		       CONFIG_SUNXI_BOOT_RECORD_PART);
+		return -1;
+	}
+	sunxi_flash_flush();
+
+	return 0;
+}
+
+int sunxi_boot_record_fdt_reserve(void *blob)
+{
+#if CONFIG_SUNXI_BOOT_RECORD_ADDR
+	int ret;
+
+	ret = fdt_add_mem_rsv(blob, CONFIG_SUNXI_BOOT_RECORD_ADDR,
+			      SUNXI_BOOT_REC_SIZE);
+	if (ret) {
+		pr_err("boot record: reserve dram failed: %s\n",
+		       fdt_strerror(ret));
+		return ret;
+	}
+#endif
+
+	return 0;
+}
+
+static void boot_rec_dump_run(struct sunxi_boot_run *run, int cur)
+{
+	struct sunxi_boot_rec *rec;
+	int i;
+
+	printf("run %u%s: %u records, %u lost\n", run->seq,
+	       cur ? " (this boot)" : "", run->count, run->lost);
+	for (i = 0; i < run->count && i < SUNXI_BOOT_REC_PER_RUN; i++) {
+		rec = &run->recs[i];
+		printf("  %-12s start %10u us  %8u us  %10u bytes%s\n",
+		       boot_rec_name(rec->stage), rec->start_us, rec->time_us,
+		       rec->bytes,
+		       (rec->flags & SUNXI_BOOT_REC_FAIL) ? "  FAIL" : "");
+	}
+}
+
+static int do_sunxi_boot_record(cmd_tbl_t *cmdtp, int flag, int argc,
+				char *const argv[])
+{
+	int i, slot;
+
+	if (!ring) {
+		printf("boot record not initialized\n");
+		return CMD_RET_FAILURE;
+	}
+
+	if (argc < 2 || !strcmp(argv[1], "list")) {
+		/* oldest first */
+		for (i = 1; i <= SUNXI_BOOT_REC_RUNS; i++) {
+			slot = (ring->cur + i) % SUNXI_BOOT_REC_RUNS;
+			if (ring->runs[slot].seq)
+				boot_rec_dump_run(&ring->runs[slot],
+						  slot == ring->cur);
+		}
+		return CMD_RET_SUCCESS;
+	}
+	if (!strcmp(argv[1], "save"))
+		return sunxi_boot_record_save() ? CMD_RET_FAILURE :
+						  CMD_RET_SUCCESS;
+	if (!strcmp(argv[1], "clear")) {
+		/* keep this boot, drop the older runs */
+		for (i = 0; i < SUNXI_BOOT_REC_RUNS; i++)
+			if (i != ring->cur)
+				memset(&ring->runs[i], 0,
+				       sizeof(struct sunxi_boot_run));
+		return CMD_RET_SUCCESS;
+	}
+
+	return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(sunxi_boot_record, 2, 0, do_sunxi_boot_record,
+	   "boot stage records",
+	   "[list]  - show the runs in the ring, oldest first\n"
+	   "sunxi_boot_record save  - write the ring to flash now\n"
+	   "sunxi_boot_record clear - drop all runs but this boot\n");
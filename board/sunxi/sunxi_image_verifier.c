@@ -33,6 +33,7 @@ static int sunxi_verify_embed_signature(void *buff, unsigned int len,
 					const char *cert_name, void *cert,
 					unsigned cert_len);
 static int sunxi_verify_signature(void *buff, uint len, const char *cert_name);
+static int sunxi_verify_hash(u8 *hash_of_file, const char *cert_name);
 static int android_image_get_signature(const struct andr_img_hdr *hdr,
 				       ulong *sign_data, ulong *sign_len);
 
@@ -289,6 +290,13 @@ static int sunxi_verify_signature(void *buff, uint len, const char *cert_name)
 	}
 	pr_msg("show hash of file\n");
 
+	return sunxi_verify_hash(hash_of_file, cert_name);
+}
+
+static int sunxi_verify_hash(u8 *hash_of_file, const char *cert_name)
+{
+	int ret;
+
 	ret = smc_tee_check_hash(cert_name, hash_of_file);
 	if (ret == 0xFFFF000F) {
 		sunxi_dump(hash_of_file, 32);
@@ -948,6 +956,39 @@ int sunxi_verify_riscv(ulong img_addr, u32 image_len, u32 riscv_id)
 
 	return 0;
 }
+
+/*
+ * same check as sunxi_verify_riscv() for a loader that hashed the image
+ * while streaming it from flash: hash is the sha256 of the signed range,
+ * tlv the tlv area behind the payload when CONFIG_SUNXI_IMAGE_HEADER
+ */
+int sunxi_verify_riscv_hash(u8 *hash, const void *tlv, u32 riscv_id)
+{
+	int ret = 0;
+	char *cert_name = NULL;
+
+	if (gd->securemode) {
+		if (riscv_id == 0) {
+			cert_name = env_get("riscv0_partition");
+			pr_msg("cert_name = %s\n", cert_name);
+		}
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+		if (sunxi_image_verify_tlv(tlv, hash, cert_name) != 0) {
+			pr_error("riscv %s verify failed\n", cert_name);
+			return -1;
+		}
+		printf("riscv %d verify success!\n", riscv_id);
+#else
+		ret = sunxi_verify_hash(hash, cert_name);
+		if (ret < 0) {
+			pr_error("riscv: sunxi_verify_hash fail: %d\n", ret);
+			return -2;
+		}
+#endif
+	}
+
+	return 0;
+}
 #endif
 
 #ifdef CONFIG_SUNXI_IMAGE_HEADER
@@ -1023,23 +1064,26 @@ static int sunxi_ecc_pk_check(uint8_t *ecc_pkey, uint32_t ecc_pkey_len, const ch
 	return 0;
 }
 
-int sunxi_image_verify(ulong os_load_addr, const char *cert_name)
+/*
+ * check the tlv area of a sunxi image (tlv header, public key, signature)
+ * against hash_of_file, the sha256 of the image from its header up to the
+ * signature
+ */
+int sunxi_image_verify_tlv(const void *tlv_buf, uint8_t *hash_of_file,
+			   const char *cert_name)
 {
 	int ret = 0;
-	uint8_t *src = (uint8_t *)(os_load_addr);
+	const uint8_t *src = tlv_buf;
 	uint8_t key_n[256] = {0};
 	uint8_t key_e[256] = {0};
 	uint8_t ecc_pkey[64] = {0};
 	uint8_t sign[256] = {0};
-	uint8_t hash_of_file[32] = {0};
 	uint8_t sign_of_hash[32] = {0};
 
-	sunxi_image_header_t *ih = (sunxi_image_header_t *)src;
 	sunxi_tlv_header_t tlv_tmp = {0};
-	sunxi_tlv_header_t *tlv = &tlv_tmp; //(sunxi_tlv_header_t *)(src + ih->ih_hsize + ih->ih_psize);
-
+	sunxi_tlv_header_t *tlv = &tlv_tmp;
 
-	memcpy(tlv, src + ih->ih_hsize + ih->ih_psize, sizeof(sunxi_tlv_header_t));
+	memcpy(tlv, src, sizeof(sunxi_tlv_header_t));
 
 	ret = sunxi_tlv_header_check(tlv);
 	if (ret) {
@@ -1049,16 +1093,16 @@ int sunxi_image_verify(ulong os_load_addr, const char *cert_name)
 	sunxi_ss_open();
 	/*Approvel certificate by trust-chain*/
 	if (tlv->th_pkey_type == PKEY_TYPE_RSA) {
-		memcpy(key_n, src + ih->ih_hsize + ih->ih_psize + tlv->th_size, 256);
-		memcpy(key_e, src + ih->ih_hsize + ih->ih_psize + tlv->th_size + 256, 256);
-		memcpy(sign, src + ih->ih_hsize + ih->ih_psize + tlv->th_size + tlv->th_pkey_size, 256);
+		memcpy(key_n, src + tlv->th_size, 256);
+		memcpy(key_e, src + tlv->th_size + 256, 256);
+		memcpy(sign, src + tlv->th_size + tlv->th_pkey_size, 256);
 		ret = sunxi_rsa_pk_check(key_n, 256, key_e, 3, cert_name);
 		if (ret) {
 			return ret;
 		}
 	} else if (tlv->th_pkey_type == PKEY_TYPE_ECC) {
-		memcpy(ecc_pkey, src + ih->ih_hsize + ih->ih_psize + tlv->th_size, 64);
-		memcpy(sign, src + ih->ih_hsize + ih->ih_psize + tlv->th_size + tlv->th_pkey_size, 64);
+		memcpy(ecc_pkey, src + tlv->th_size, 64);
+		memcpy(sign, src + tlv->th_size + tlv->th_pkey_size, 64);
 		ret = sunxi_ecc_pk_check(ecc_pkey, 64, cert_name);
 		if (ret) {
 			return ret;
@@ -1068,15 +1112,6 @@ int sunxi_image_verify(ulong os_load_addr, const char *cert_name)
 		return -1;
 	}
 
-	/*calc payload hash*/
-	memset(hash_of_file, 0, sizeof(hash_of_file));
-	ret = sunxi_sha_calc(hash_of_file, sizeof(hash_of_file), src,
-			ih->ih_hsize + ih->ih_psize + tlv->th_size + tlv->th_pkey_size);
-	if (ret) {
-		pr_error("calc file sha256 with hardware err\n");
-		return -1;
-	}
-
 	/*verify*/
 	if (tlv->th_pkey_type == PKEY_TYPE_RSA) {
 		ret = sunxi_rsa_calc(key_n, 256,
@@ -1107,6 +1142,42 @@ int sunxi_image_verify(ulong os_load_addr, const char *cert_name)
 #endif
 	}
 
+	return 0;
+}
+
+int sunxi_image_verify(ulong os_load_addr, const char *cert_name)
+{
+	int ret = 0;
+	uint8_t *src = (uint8_t *)(os_load_addr);
+	uint8_t hash_of_file[32] = {0};
+
+	sunxi_image_header_t *ih = (sunxi_image_header_t *)src;
+	sunxi_tlv_header_t tlv_tmp = {0};
+	sunxi_tlv_header_t *tlv = &tlv_tmp; //(sunxi_tlv_header_t *)(src + ih->ih_hsize + ih->ih_psize);
+
+
+	memcpy(tlv, src + ih->ih_hsize + ih->ih_psize, sizeof(sunxi_tlv_header_t));
+
+	ret = sunxi_tlv_header_check(tlv);
+	if (ret) {
+		return ret;
+	}
+
+	sunxi_ss_open();
+	/*calc payload hash*/
+	memset(hash_of_file, 0, sizeof(hash_of_file));
+	ret = sunxi_sha_calc(hash_of_file, sizeof(hash_of_file), src,
+			ih->ih_hsize + ih->ih_psize + tlv->th_size + tlv->th_pkey_size);
+	if (ret) {
+		pr_error("calc file sha256 with hardware err\n");
+		return -1;
+	}
+
+	ret = sunxi_image_verify_tlv(src + ih->ih_hsize + ih->ih_psize,
+				     hash_of_file, cert_name);
+	if (ret)
+		return ret;
+
 	memcpy(src, src + ih->ih_hsize, ih->ih_psize);
 	return 0;
 }
@@ -10,6 +10,7 @@
 #include <sys_partition.h>
 #include <image.h>
 #include <android_image.h>
+#include <sys_config.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -71,6 +72,7 @@ static int __sunxi_replace_fdt(void *buffer)
 
 	/* fdt_size is the space reserved by uboot for fdt, now set to new fdt */
 	fdt_set_totalsize((void *)gd->fdt_blob, gd->fdt_size);
+	sys_config_cache_invalidate();
 
 	return 0;
 }
@@ -265,6 +267,7 @@ static int __sunxi_replace_fdt_v2(void *buffer)
 	memcpy((void *)gd->new_ext_fdt, buffer, new_fdt_totalsize);
 	/* fdt_size is the space reserved by uboot for fdt, now set to new fdt */
 	fdt_set_totalsize((void *)gd->new_ext_fdt, gd->fdt_ext_size);
+	sys_config_cache_invalidate();
 
 	return 0;
 }
@@ -312,6 +315,7 @@ int do_set_working_fdt(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 		printf("change working_fdt 0x%lx to ", (ulong)working_fdt);
 		working_fdt = (struct fdt_header *)simple_strtoul(argv[1], NULL, 16);
 		printf("0x%lx\n", (ulong)working_fdt);
+		sys_config_cache_invalidate();
 	}
 	return 0;
 }
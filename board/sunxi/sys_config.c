@@ -1305,6 +1305,349 @@ __s32 gpio_release(ulong p_handler, __s32 unused_para)
 #define FDT_INFO(fmt,args...) printf("FDT INFO:"fmt,##args);
 #define FDT_ERR(fmt,args...) printf("FDT ERROR:"fmt,##args);
 
+/*
+ * Board init asks the same questions of working_fdt again and again: the
+ * offset of a node path, the pins behind a pinctrl property and the cells
+ * of a u32 property. The answers stay good as long as the blob is neither
+ * moved nor changes its structure size, so they are kept keyed on the blob
+ * address and header sizes and dropped as soon as any of those differ.
+ * u32 properties keep a pointer to the cells, not a copy, so values that
+ * are rewritten in place are read back as they are now.
+ *
+ * The cache lives in .bss and is only used after relocation.
+ */
+static struct {
+	ulong us;
+	u32 lookups;
+	u32 hits;
+} sys_config_stat;
+
+static ulong sys_config_lookup_begin(void)
+{
+	if (!(gd->flags & GD_FLG_RELOC))
+		return 0;
+
+	sys_config_stat.lookups++;
+	return timer_get_us();
+}
+
+static void sys_config_lookup_end(ulong start)
+{
+	if (gd->flags & GD_FLG_RELOC)
+		sys_config_stat.us += timer_get_us() - start;
+}
+
+void sys_config_lookup_report(void)
+{
+	pr_msg("sys_config: %u fdt lookups, %u cached, %lu us\n",
+	       sys_config_stat.lookups, sys_config_stat.hits,
+	       sys_config_stat.us);
+}
+
+#define SYS_CONFIG_CACHE_PATHS	(64)
+#define SYS_CONFIG_CACHE_PROPS	(128)
+#define SYS_CONFIG_CACHE_PINS	(32)
+#define SYS_CONFIG_CACHE_PATH	(64)
+#define SYS_CONFIG_CACHE_NAME	(32)
+
+struct sys_config_path {
+	u32 hash;
+	int offset;
+	char path[SYS_CONFIG_CACHE_PATH];
+};
+
+struct sys_config_prop {
+	u32 hash;
+	int node;
+	const fdt32_t *data;	/* NULL: missing or not u32 cells */
+	int len;
+	char name[SYS_CONFIG_CACHE_NAME];
+};
+
+struct sys_config_pins {
+	u32 hash;
+	int node;
+	int count;
+	user_gpio_set_t *pins;
+	char name[SYS_CONFIG_CACHE_NAME];
+};
+
+#ifdef CONFIG_SUNXI_SYS_CONFIG_CACHE
+static struct {
+	const void *fdt;
+	u32 totalsize;
+	u32 off_dt_struct;
+	u32 off_dt_strings;
+	u32 size_dt_struct;
+	u32 size_dt_strings;
+	/* once full, entries are replaced round robin from next_* */
+	int nr_paths, next_path;
+	int nr_props, next_prop;
+	int nr_pins, next_pin;
+	struct sys_config_path paths[SYS_CONFIG_CACHE_PATHS];
+	struct sys_config_prop props[SYS_CONFIG_CACHE_PROPS];
+	struct sys_config_pins pins[SYS_CONFIG_CACHE_PINS];
+} sc_cache;
+
+static u32 sys_config_cache_hash(const char *name, int node)
+{
+	u32 hash = 2166136261u ^ node;
+
+	while (*name)
+		hash = (hash ^ (u8)*name++) * 16777619u;
+
+	return hash;
+}
+
+static int sys_config_cache_slot(int *nr, int *next, int max)
+{
+	int slot;
+
+	if (*nr < max)
+		return (*nr)++;
+	slot = *next;
+	*next = (slot + 1) % max;
+
+	return slot;
+}
+
+void sys_config_cache_invalidate(void)
+{
+	int i;
+
+	if (!(gd->flags & GD_FLG_RELOC))
+		return;
+
+	for (i = 0; i < sc_cache.nr_pins; i++)
+		free(sc_cache.pins[i].pins);
+	memset(&sc_cache, 0, sizeof(sc_cache));
+}
+
+/* 1 when the cache may be used, after dropping it if the blob changed */
+static int sys_config_cache_ready(void)
+{
+	if (!(gd->flags & GD_FLG_RELOC) || !working_fdt)
+		return 0;
+
+	if (sc_cache.fdt != working_fdt ||
+	    sc_cache.totalsize != fdt_totalsize(working_fdt) ||
+	    sc_cache.off_dt_struct != fdt_off_dt_struct(working_fdt) ||
+	    sc_cache.off_dt_strings != fdt_off_dt_strings(working_fdt) ||
+	    sc_cache.size_dt_struct != fdt_size_dt_struct(working_fdt) ||
+	    sc_cache.size_dt_strings != fdt_size_dt_strings(working_fdt)) {
+		sys_config_cache_invalidate();
+		sc_cache.fdt = working_fdt;
+		sc_cache.totalsize = fdt_totalsize(working_fdt);
+		sc_cache.off_dt_struct = fdt_off_dt_struct(working_fdt);
+		sc_cache.off_dt_strings = fdt_off_dt_strings(working_fdt);
+		sc_cache.size_dt_struct = fdt_size_dt_struct(working_fdt);
+		sc_cache.size_dt_strings = fdt_size_dt_strings(working_fdt);
+	}
+
+	return 1;
+}
+
+static struct sys_config_path *sys_config_cache_path(const char *path,
+						     int *hit)
+{
+	struct sys_config_path *p;
+	u32 hash;
+	int i;
+
+	*hit = 0;
+	if (!sys_config_cache_ready() || strlen(path) >= SYS_CONFIG_CACHE_PATH)
+		return NULL;
+
+	hash = sys_config_cache_hash(path, 0);
+	for (i = 0; i < sc_cache.nr_paths; i++) {
+		p = &sc_cache.paths[i];
+		if (p->hash == hash && !strcmp(p->path, path)) {
+			*hit = 1;
+			return p;
+		}
+	}
+
+	p = &sc_cache.paths[sys_config_cache_slot(&sc_cache.nr_paths,
+						  &sc_cache.next_path,
+						  SYS_CONFIG_CACHE_PATHS)];
+	p->hash = hash;
+	strcpy(p->path, path);
+
+	return p;
+}
+
+static struct sys_config_prop *sys_config_cache_prop(int node,
+						     const char *name,
+						     int *hit)
+{
+	struct sys_config_prop *p;
+	u32 hash;
+	int i;
+
+	*hit = 0;
+	if (!sys_config_cache_ready() || strlen(name) >= SYS_CONFIG_CACHE_NAME)
+		return NULL;
+
+	hash = sys_config_cache_hash(name, node);
+	for (i = 0; i < sc_cache.nr_props; i++) {
+		p = &sc_cache.props[i];
+		if (p->hash == hash && p->node == node &&
+		    !strcmp(p->name, name)) {
+			*hit = 1;
+			return p;
+		}
+	}
+
+	p = &sc_cache.props[sys_config_cache_slot(&sc_cache.nr_props,
+						  &sc_cache.next_prop,
+						  SYS_CONFIG_CACHE_PROPS)];
+	p->hash = hash;
+	p->node = node;
+	strcpy(p->name, name);
+
+	return p;
+}
+
+/*
+ * pins are cached decoded, not as pointers into the blob. the header check
+ * does not see a pinctrl property rewritten in place (same length, e.g.
+ * fdt_setprop_inplace()), whoever does that has to call
+ * sys_config_cache_invalidate() or the old pins are handed out.
+ */
+static int sys_config_cache_get_pins(int node, const char *name,
+				     user_gpio_set_t *gpio_list)
+{
+	struct sys_config_pins *p;
+	u32 hash;
+	int i;
+
+	if (!sys_config_cache_ready())
+		return -1;
+
+	hash = sys_config_cache_hash(name, node);
+	for (i = 0; i < sc_cache.nr_pins; i++) {
+		p = &sc_cache.pins[i];
+		if (p->hash == hash && p->node == node &&
+		    !strcmp(p->name, name)) {
+			memcpy(gpio_list, p->pins, p->count * sizeof(*p->pins));
+			return p->count;
+		}
+	}
+
+	return -1;
+}
+
+static void sys_config_cache_put_pins(int node, const char *name,
+				      user_gpio_set_t *gpio_list, int count)
+{
+	struct sys_config_pins *p;
+	user_gpio_set_t *pins;
+
+	if (!sys_config_cache_ready() || strlen(name) >= SYS_CONFIG_CACHE_NAME)
+		return;
+
+	pins = malloc(count * sizeof(*pins) + 1);
+	if (!pins)
+		return;
+	memcpy(pins, gpio_list, count * sizeof(*pins));
+
+	p = &sc_cache.pins[sys_config_cache_slot(&sc_cache.nr_pins,
+						 &sc_cache.next_pin,
+						 SYS_CONFIG_CACHE_PINS)];
+	if (p->pins)
+		free(p->pins);
+	p->hash = sys_config_cache_hash(name, node);
+	p->node = node;
+	p->count = count;
+	p->pins = pins;
+	strcpy(p->name, name);
+}
+#else
+void sys_config_cache_invalidate(void)
+{
+}
+
+static struct sys_config_path *sys_config_cache_path(const char *path,
+						     int *hit)
+{
+	*hit = 0;
+	return NULL;
+}
+
+static struct sys_config_prop *sys_config_cache_prop(int node,
+						     const char *name,
+						     int *hit)
+{
+	*hit = 0;
+	return NULL;
+}
+
+static int sys_config_cache_get_pins(int node, const char *name,
+				     user_gpio_set_t *gpio_list)
+{
+	return -1;
+}
+
+static void sys_config_cache_put_pins(int node, const char *name,
+				      user_gpio_set_t *gpio_list, int count)
+{
+}
+#endif
+
+static int sys_config_path_offset(const char *path)
+{
+	ulong start = sys_config_lookup_begin();
+	struct sys_config_path *p;
+	int hit, offset;
+
+	p = sys_config_cache_path(path, &hit);
+	if (hit) {
+		sys_config_stat.hits++;
+		offset = p->offset;
+	} else {
+		offset = fdt_path_offset(working_fdt, path);
+		if (p)
+			p->offset = offset;
+	}
+	sys_config_lookup_end(start);
+
+	return offset;
+}
+
+/* fdt_getprop_u32() on working_fdt */
+static int sys_config_getprop_u32(int node, const char *name, u32 *val)
+{
+	ulong start = sys_config_lookup_begin();
+	struct sys_config_prop *p;
+	const fdt32_t *data;
+	int hit, len, j;
+
+	p = sys_config_cache_prop(node, name, &hit);
+	if (hit) {
+		sys_config_stat.hits++;
+		data = p->data;
+		len = p->len;
+	} else {
+		data = fdt_getprop(working_fdt, node, name, &len);
+		if (!data || !len || len % 4)
+			data = NULL;
+		if (p) {
+			p->data = data;
+			p->len = len;
+		}
+	}
+	sys_config_lookup_end(start);
+
+	if (!data)
+		return -FDT_ERR_INTERNAL;
+	if (val) {
+		for (j = 0; j < len / 4; j++)
+			val[j] = fdt32_to_cpu(data[j]);
+	}
+
+	return len / 4;
+}
+
 static int fdt_get_new_pull(int nodeoffset)
 {
 	if (fdt_getprop_string(working_fdt, nodeoffset,
@@ -1327,7 +1670,7 @@ static int fdt_get_new_pull(int nodeoffset)
  * @prop_name:  pin property name--ex "pinctrl-0"
  * @gpio_list:  recevice the gpio data
  */
-int fdt_get_all_pin(int nodeoffset,const char* pinctrl_name,user_gpio_set_t* gpio_list)
+static int __fdt_get_all_pin(int nodeoffset,const char* pinctrl_name,user_gpio_set_t* gpio_list)
 {
 	//int  nodeoffset;	/* node offset from libfdt */
 	char *pins = NULL;
@@ -1535,6 +1878,25 @@ int fdt_get_all_pin(int nodeoffset,const char* pinctrl_name,user_gpio_set_t* gpi
 	return gpio_list_index;
 }
 
+int fdt_get_all_pin(int nodeoffset,const char* pinctrl_name,user_gpio_set_t* gpio_list)
+{
+	ulong start = sys_config_lookup_begin();
+	int count;
+
+	count = sys_config_cache_get_pins(nodeoffset, pinctrl_name, gpio_list);
+	if (count >= 0) {
+		sys_config_stat.hits++;
+	} else {
+		count = __fdt_get_all_pin(nodeoffset, pinctrl_name, gpio_list);
+		if (count >= 0)
+			sys_config_cache_put_pins(nodeoffset, pinctrl_name,
+						  gpio_list, count);
+	}
+	sys_config_lookup_end(start);
+
+	return count;
+}
+
 /**
  * fdt_get_pin_num - get pin num from  device node
  *
@@ -1609,7 +1971,7 @@ int fdt_set_all_pin(const char* node_path,const char* pinctrl_name)
 	int nodeoffset;
 
 	//get property vaule by handle
-	nodeoffset = fdt_path_offset (working_fdt,node_path );
+	nodeoffset = sys_config_path_offset(node_path);
 	if(nodeoffset < 0)
 	{
 		FDT_ERR("%s:[%s]-->%s\n",__func__,node_path,fdt_strerror(nodeoffset));
@@ -1727,7 +2089,7 @@ int fdt_get_one_gpio_by_offset(int nodeoffset, const char* prop_name,user_gpio_s
 		return -1;
 	}
 
-	ret = fdt_getprop_u32(working_fdt,nodeoffset,prop_name,data);
+	ret = sys_config_getprop_u32(nodeoffset,prop_name,data);
 	if(ret < 0 )
 	{
 		debug("%s : err returned %s\n",__func__,fdt_strerror(ret));
@@ -1763,14 +2125,14 @@ int fdt_get_one_gpio(const char* node_path, const char* prop_name,user_gpio_set_
 
 	memset(data, 0, sizeof(data));
 	//get property vaule by handle
-	nodeoffset = fdt_path_offset (working_fdt,node_path );
+	nodeoffset = sys_config_path_offset(node_path);
 	if(nodeoffset < 0)
 	{
 		debug ("fdt err returned %s\n",fdt_strerror(nodeoffset));
 		return -1;
 	}
 
-	ret = fdt_getprop_u32(working_fdt,nodeoffset,prop_name,data);
+	ret = sys_config_getprop_u32(nodeoffset,prop_name,data);
 	if(ret < 0 )
 	{
 		debug("%s :%s|%s err returned %s\n",__func__,node_path,prop_name,fdt_strerror(ret));
@@ -1825,14 +2187,14 @@ int script_parser_fetch(char *node_path, char *prop_name, int value[], int def_v
 	int ret;
 
 	//get property vaule by handle
-	nodeoffset = fdt_path_offset (working_fdt, node_path );
+	nodeoffset = sys_config_path_offset(node_path);
 	if(nodeoffset < 0) {
 		debug ("fdt err returned %s\n",fdt_strerror(nodeoffset));
 		value[0] = def_val;
 		return -1;
 	}
 
-	ret = fdt_getprop_u32(working_fdt,nodeoffset, prop_name, (u32*)value);
+	ret = sys_config_getprop_u32(nodeoffset, prop_name, (u32 *)value);
 	if(ret < 0 ) {
 		debug("%s :%s|%s err returned %s\n",__func__,node_path,prop_name,fdt_strerror(ret));
 		value[0] = def_val;
@@ -24,6 +24,7 @@
 #include <android_image.h>
 #include <fdt_support.h>
 #include <sunxi_eink.h>
+#include <sunxi_boot_record.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -232,6 +233,7 @@ int do_bootm(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 #ifdef CONFIG_SUNXI_SECURE_BOOT
 	/* verify image before booting in secure boot*/
 	if (gd->securemode) {
+		ulong rec = sunxi_boot_record_begin();
 
 #if defined(CONFIG_SUNXI_DM_VERITY)
 		if (sunxi_verity_hash_tree("rootfs", "rootfs") != 0) {
@@ -267,8 +269,10 @@ int do_bootm(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 
 		if (sunxi_verify_os(os_load_addr,
 				    env_get("boot_from_partion")) != 0) {
+			sunxi_boot_record(BOOT_REC_VERIFY, rec, 0, -1);
 			return -1;
 		}
+		sunxi_boot_record(BOOT_REC_VERIFY, rec, 0, 0);
 	}
 #endif /*CONFIG_SUNXI_SECURE_BOOT*/
 
@@ -0,0 +1,271 @@
+/*
+ * Burst versions of the memtester pattern tests.
+ *
+ * Every test writes the same values to the same words and checks the
+ * same pairs as its counterpart in mem_tests.c; only the access width
+ * differs. Fills and compares are unrolled over MEMTEST_BURST words on
+ * plain pointers, which the compiler turns into ldm/stm bursts, and the
+ * compare only walks word by word again to report a chunk that differs.
+ * The u-boot build is soft float and never enables VFP/NEON, so 128-bit
+ * vector moves are not available here.
+ *
+ * Licensed under the terms of the GNU General Public License version 2 (only).
+ */
+
+#include <common.h>
+#include <sunxi_dma_memcpy.h>
+#include "types.h"
+#include "sizes.h"
+#include "tests.h"
+
+#define MEMTEST_BURST	8	/* words per ldm/stm */
+#define MEMTEST_CHUNK	1024	/* words checked before looking at the diff */
+#define ONE 0x00000001L
+
+extern void flush_dcache_all(void);
+
+/* bytes moved by the fast tests, for the bandwidth report */
+ull memtest_fast_bytes;
+/* fill the block sequential patterns with the dma engine */
+int memtest_use_dma;
+
+static void fast_report(ul *bufa, ul *bufb, size_t start, size_t end) {
+    size_t i;
+
+    for (i = start; i < end; i++) {
+        if (bufa[i] != bufb[i]) {
+            printf(
+                    "FAILURE: 0x%08lx != 0x%08lx at offset 0x%08lx.\n",
+                    bufa[i], bufb[i], (ul) (i * sizeof(ul)));
+        }
+    }
+}
+
+static int fast_compare_regions(ul *bufa, ul *bufb, size_t count) {
+    size_t i, start, end;
+    ul diff;
+    int r = 0;
+
+    flush_dcache_all();
+    for (start = 0; start < count; start = end) {
+        end = min(start + MEMTEST_CHUNK, count);
+        diff = 0;
+        for (i = start; i + MEMTEST_BURST <= end; i += MEMTEST_BURST) {
+            diff |= (bufa[i] ^ bufb[i]) | (bufa[i + 1] ^ bufb[i + 1]) |
+                    (bufa[i + 2] ^ bufb[i + 2]) | (bufa[i + 3] ^ bufb[i + 3]) |
+                    (bufa[i + 4] ^ bufb[i + 4]) | (bufa[i + 5] ^ bufb[i + 5]) |
+                    (bufa[i + 6] ^ bufb[i + 6]) | (bufa[i + 7] ^ bufb[i + 7]);
+        }
+        for (; i < end; i++)
+            diff |= bufa[i] ^ bufb[i];
+        if (diff) {
+            fast_report(bufa, bufb, start, end);
+            r = -1;
+        }
+    }
+    memtest_fast_bytes += 2 * count * sizeof(ul);
+    return r;
+}
+
+/* even words get q0, odd words q1, in both halves */
+static void fast_fill(ul *bufa, ul *bufb, size_t count, ul q0, ul q1) {
+    size_t i;
+
+    for (i = 0; i + MEMTEST_BURST <= count; i += MEMTEST_BURST) {
+        bufa[i] = q0; bufa[i + 1] = q1; bufa[i + 2] = q0; bufa[i + 3] = q1;
+        bufa[i + 4] = q0; bufa[i + 5] = q1; bufa[i + 6] = q0; bufa[i + 7] = q1;
+        bufb[i] = q0; bufb[i + 1] = q1; bufb[i + 2] = q0; bufb[i + 3] = q1;
+        bufb[i + 4] = q0; bufb[i + 5] = q1; bufb[i + 6] = q0; bufb[i + 7] = q1;
+    }
+    for (; i < count; i++)
+        bufa[i] = bufb[i] = (i % 2) == 0 ? q0 : q1;
+    memtest_fast_bytes += 2 * count * sizeof(ul);
+}
+
+/* run passes pattern passes, pattern() returns the even/odd words of pass j */
+static int fast_pattern_test(ulv *bufa, ulv *bufb, size_t count,
+                             unsigned int passes,
+                             void (*pattern)(unsigned int j, ul *q0, ul *q1)) {
+    unsigned int j;
+    ul q0, q1;
+
+    printf("           ");
+    for (j = 0; j < passes; j++) {
+        printf("\b\b\b\b\b\b\b\b\b\b\b");
+        printf("setting %3u", j);
+        pattern(j, &q0, &q1);
+        fast_fill((ul *)bufa, (ul *)bufb, count, q0, q1);
+        printf("\b\b\b\b\b\b\b\b\b\b\b");
+        printf("testing %3u", j);
+        if (fast_compare_regions((ul *)bufa, (ul *)bufb, count)) {
+            return -1;
+        }
+    }
+    printf("\b\b\b\b\b\b\b\b\b\b\b           \b\b\b\b\b\b\b\b\b\b\b");
+    return 0;
+}
+
+int fast_test_stuck_address(ulv *bufa, size_t count) {
+    ul *p = (ul *)bufa;
+    unsigned int j;
+    size_t i, k;
+    ul m0, m1, diff;
+
+    printf("           ");
+    for (j = 0; j < 16; j++) {
+        printf("\b\b\b\b\b\b\b\b\b\b\b");
+        printf("setting %3u", j);
+        /* even offsets hold the address on even passes, ~address on odd */
+        m0 = (j % 2) == 0 ? 0 : UL_ONEBITS;
+        m1 = ~m0;
+        for (i = 0; i + MEMTEST_BURST <= count; i += MEMTEST_BURST) {
+            p[i] = (ul) &p[i] ^ m0;
+            p[i + 1] = (ul) &p[i + 1] ^ m1;
+            p[i + 2] = (ul) &p[i + 2] ^ m0;
+            p[i + 3] = (ul) &p[i + 3] ^ m1;
+            p[i + 4] = (ul) &p[i + 4] ^ m0;
+            p[i + 5] = (ul) &p[i + 5] ^ m1;
+            p[i + 6] = (ul) &p[i + 6] ^ m0;
+            p[i + 7] = (ul) &p[i + 7] ^ m1;
+        }
+        for (; i < count; i++)
+            p[i] = (ul) &p[i] ^ ((i % 2) == 0 ? m0 : m1);
+        flush_dcache_all();
+        printf("\b\b\b\b\b\b\b\b\b\b\b");
+        printf("testing %3u", j);
+        diff = 0;
+        for (i = 0; i + MEMTEST_BURST <= count; i += MEMTEST_BURST) {
+            diff |= (p[i] ^ (ul) &p[i] ^ m0) |
+                    (p[i + 1] ^ (ul) &p[i + 1] ^ m1) |
+                    (p[i + 2] ^ (ul) &p[i + 2] ^ m0) |
+                    (p[i + 3] ^ (ul) &p[i + 3] ^ m1) |
+                    (p[i + 4] ^ (ul) &p[i + 4] ^ m0) |
+                    (p[i + 5] ^ (ul) &p[i + 5] ^ m1) |
+                    (p[i + 6] ^ (ul) &p[i + 6] ^ m0) |
+                    (p[i + 7] ^ (ul) &p[i + 7] ^ m1);
+        }
+        for (; i < count; i++)
+            diff |= p[i] ^ (ul) &p[i] ^ ((i % 2) == 0 ? m0 : m1);
+        memtest_fast_bytes += 2 * count * sizeof(ul);
+        if (diff) {
+            for (k = 0; k < count; k++)
+                if (p[k] != ((ul) &p[k] ^ ((k % 2) == 0 ? m0 : m1)))
+                    break;
+            printf(
+                    "FAILURE: possible bad address line at offset "
+                    "0x%08lx.\n",
+                    (ul) (k * sizeof(ul)));
+            printf("Skipping to next test...\n");
+            return -1;
+        }
+    }
+    printf("\b\b\b\b\b\b\b\b\b\b\b           \b\b\b\b\b\b\b\b\b\b\b");
+    return 0;
+}
+
+int fast_test_random_value(ulv *bufa, ulv *bufb, size_t count) {
+    ul *p1 = (ul *)bufa;
+    ul *p2 = (ul *)bufb;
+    ul x = rand_ul() | 1;
+    size_t i;
+
+    /* xorshift, seeded from the timer like rand_ul() */
+    for (i = 0; i < count; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        p1[i] = p2[i] = x;
+    }
+    memtest_fast_bytes += 2 * count * sizeof(ul);
+    return fast_compare_regions(p1, p2, count);
+}
+
+static void solidbits_pattern(unsigned int j, ul *q0, ul *q1) {
+    *q0 = (j % 2) == 0 ? UL_ONEBITS : 0;
+    *q1 = ~*q0;
+}
+
+int fast_test_solidbits_comparison(ulv *bufa, ulv *bufb, size_t count) {
+    return fast_pattern_test(bufa, bufb, count, 64, solidbits_pattern);
+}
+
+static void checkerboard_pattern(unsigned int j, ul *q0, ul *q1) {
+    *q0 = (j % 2) == 0 ? CHECKERBOARD1 : CHECKERBOARD2;
+    *q1 = ~*q0;
+}
+
+int fast_test_checkerboard_comparison(ulv *bufa, ulv *bufb, size_t count) {
+    return fast_pattern_test(bufa, bufb, count, 64, checkerboard_pattern);
+}
+
+int fast_test_blockseq_comparison(ulv *bufa, ulv *bufb, size_t count) {
+    unsigned int j;
+
+    printf("           ");
+    for (j = 0; j < 256; j++) {
+        printf("\b\b\b\b\b\b\b\b\b\b\b");
+        printf("setting %3u", j);
+        /* UL_BYTE(j) in every word is a byte fill */
+        if (memtest_use_dma) {
+            sunxi_dma_memset((void *)bufa, j, count * sizeof(ul));
+            sunxi_dma_memset((void *)bufb, j, count * sizeof(ul));
+            memtest_fast_bytes += 2 * count * sizeof(ul);
+        } else {
+            fast_fill((ul *)bufa, (ul *)bufb, count, (ul) UL_BYTE(j),
+                      (ul) UL_BYTE(j));
+        }
+        printf("\b\b\b\b\b\b\b\b\b\b\b");
+        printf("testing %3u", j);
+        if (fast_compare_regions((ul *)bufa, (ul *)bufb, count)) {
+            return -1;
+        }
+    }
+    printf("\b\b\b\b\b\b\b\b\b\b\b           \b\b\b\b\b\b\b\b\b\b\b");
+    return 0;
+}
+
+static ul walk_bit(unsigned int j) {
+    return j < UL_LEN ? ONE << j : ONE << (UL_LEN * 2 - j - 1);
+}
+
+static void walkbits0_pattern(unsigned int j, ul *q0, ul *q1) {
+    *q0 = *q1 = walk_bit(j);
+}
+
+int fast_test_walkbits0_comparison(ulv *bufa, ulv *bufb, size_t count) {
+    return fast_pattern_test(bufa, bufb, count, UL_LEN * 2,
+                             walkbits0_pattern);
+}
+
+static void walkbits1_pattern(unsigned int j, ul *q0, ul *q1) {
+    *q0 = *q1 = UL_ONEBITS ^ walk_bit(j);
+}
+
+int fast_test_walkbits1_comparison(ulv *bufa, ulv *bufb, size_t count) {
+    return fast_pattern_test(bufa, bufb, count, UL_LEN * 2,
+                             walkbits1_pattern);
+}
+
+static void bitspread_pattern(unsigned int j, ul *q0, ul *q1) {
+    if (j < UL_LEN) { /* Walk it up. */
+        *q0 = (ONE << j) | (ONE << (j + 2));
+    } else { /* Walk it back down. */
+        *q0 = (ONE << (UL_LEN * 2 - 1 - j)) | (ONE << (UL_LEN * 2 + 1 - j));
+    }
+    *q1 = UL_ONEBITS ^ *q0;
+}
+
+int fast_test_bitspread_comparison(ulv *bufa, ulv *bufb, size_t count) {
+    return fast_pattern_test(bufa, bufb, count, UL_LEN * 2,
+                             bitspread_pattern);
+}
+
+/* pass k * 8 + j of test_bitflip_comparison() */
+static void bitflip_pattern(unsigned int j, ul *q0, ul *q1) {
+    *q0 = (ONE << (j / 8)) ^ (((j % 8) % 2) == 0 ? UL_ONEBITS : 0);
+    *q1 = ~*q0;
+}
+
+int fast_test_bitflip_comparison(ulv *bufa, ulv *bufb, size_t count) {
+    return fast_pattern_test(bufa, bufb, count, UL_LEN * 8, bitflip_pattern);
+}
@@ -33,4 +33,15 @@ extern int test_walkbits1_comparison(unsigned long volatile *bufa, unsigned long
 extern int test_bitspread_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
 extern int test_bitflip_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
 
-
+/* burst versions, mem_tests_fast.c */
+extern unsigned long long memtest_fast_bytes;
+extern int memtest_use_dma;
+extern int fast_test_stuck_address(unsigned long volatile *bufa, size_t count);
+extern int fast_test_random_value(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
+extern int fast_test_solidbits_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
+extern int fast_test_checkerboard_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
+extern int fast_test_blockseq_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
+extern int fast_test_walkbits0_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
+extern int fast_test_walkbits1_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
+extern int fast_test_bitspread_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
+extern int fast_test_bitflip_comparison(unsigned long volatile *bufa, unsigned long volatile *bufb, size_t count);
@@ -29,6 +29,25 @@ int do_bootr(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	__attribute__((unused)) u32 id = 0;
 	__attribute__((unused)) u32 img_addr = 0;
 
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+#ifdef CONFIG_RISCV_E907
+	/* load, verify and release straight from the partition */
+	if (!strcmp(argv[1], "part")) {
+		if (argc < 3)
+			return CMD_RET_USAGE;
+		if (argc > 3)
+			run_addr = simple_strtoul(argv[3], NULL, 16);
+		if (argc > 4)
+			id = simple_strtoul(argv[4], NULL, 16);
+		return sunxi_riscv_boot_part(argv[2], run_addr, id) ?
+		       CMD_RET_FAILURE : 0;
+	}
+#endif
+	if (argc < 4)
+		return CMD_RET_USAGE;
+
 	img_addr = simple_strtoul(argv[1], NULL, 16);
 	run_addr = simple_strtoul(argv[2], NULL, 16);
 	id = simple_strtoul(argv[3], NULL, 16);
@@ -47,7 +66,12 @@ static char bootr_help_text[] =
 	"\tpassing arguments 'arg ...'; when booting a rtos image,\n"
 	"\t'arg[1]' can be the loader address of image\n"
 	"\t'arg[2]' can be the run address of image\n"
-	"\t'arg[3]' can be cpu id of the ip\n";
+	"\t'arg[3]' can be cpu id of the ip\n"
+#ifdef CONFIG_RISCV_E907
+	"bootr part <partition> [run_addr] [id]\n"
+	"    - stream a riscv elf from a partition, verify it and boot it\n"
+#endif
+	;
 #endif
 
 U_BOOT_CMD(
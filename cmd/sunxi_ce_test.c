@@ -5,11 +5,16 @@
  */
 
 #include <common.h>
+#include <malloc.h>
 #include <securestorage.h>
 #include <sunxi_board.h>
 #include <asm/arch/ce.h>
 #include <sunxi_board.h>
 #include <asm/arch/timer.h>
+#include <linux/math64.h>
+#include <u-boot/sha256.h>
+#include <u-boot/rsa-mod-exp.h>
+#include <uboot_aes.h>
 
 int do_hash_test(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 {
@@ -230,6 +235,40 @@ static s32 sunxi_sm2_ecdh_test(struct sunxi_sm2_ctx_t *sm2_ctx)
 	return 0;
 }
 
+/*
+ * one line of "sunxi_ce_test bench" output:
+ * bench,<alg>,<impl>,<bytes per op>,<ops>,<us>,<KB/s>,<ops/s>
+ */
+static void ce_bench_row(const char *alg, const char *impl, u32 bytes,
+			 u32 iters, ulong us)
+{
+	u64 total = (u64)bytes * iters;
+
+	if (!us)
+		us = 1;
+	printf("bench,%s,%s,%u,%u,%lu,%llu,%llu\n", alg, impl, bytes, iters,
+	       us, div64_u64(total * 1000000, (u64)us * 1024),
+	       div64_u64((u64)iters * 1000000, us));
+}
+
+static void sm2_bench(struct sunxi_sm2_ctx_t *sm2_ctx, u32 loops)
+{
+	ulong start;
+	u32 i;
+
+	sm2_ctx->mode = 2;
+	start = timer_get_us();
+	for (i = 0; i < loops; i++)
+		sunxi_sm2_sign_verify_test(sm2_ctx);
+	ce_bench_row("sm2", "ce-sign", 32, loops, timer_get_us() - start);
+
+	sm2_ctx->mode = 3;
+	start = timer_get_us();
+	for (i = 0; i < loops; i++)
+		sunxi_sm2_sign_verify_test(sm2_ctx);
+	ce_bench_row("sm2", "ce-verify", 32, loops, timer_get_us() - start);
+}
+
 int do_sm2_test(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 {
 	u32 sm2_Fp_256_k[8] = {0x59276e27, 0xd506861a, 0x16680f3a, 0xd9c02dcc,
@@ -390,6 +429,10 @@ int do_sm2_test(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 		return -1;
 	}
 
+	/* sunxi_ce_test sm2 <loops>: time sign and verify once the vectors pass */
+	if (argc > 1)
+		sm2_bench(&sm2_ctx, simple_strtoul(argv[1], NULL, 10));
+
 	return CMD_RET_SUCCESS;
 }
 
@@ -651,6 +694,493 @@ int do_aes_perf_test(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 	return CMD_RET_SUCCESS;
 }
 
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+static void hash_perf_show(const char *name, u32 bs, u32 bytes, ulong us,
+			   int ok)
+{
+	us = max(us, 1UL);
+	/* bytes per us is MB/s */
+	printf("%-9s %7u: %4lu.%lu MB/s%s\n", name, bs,
+	       (ulong)bytes / us, (ulong)bytes * 10 / us % 10,
+	       ok ? "" : "  digest mismatch");
+}
+
+/*
+ * hash the first len bytes of buf in pieces of the given sizes, cycling
+ * through them and putting up to SUNXI_HASH_SG_MAX pieces in one update,
+ * and compare with sunxi_sha_calc(). pieces stay multiples of 4 so every
+ * entry starts on a word boundary, only the last one may be odd.
+ */
+static int hash_split_check(struct sunxi_ce_hash_ctx *ctx, u8 *buf, u32 len,
+			    const u32 *piece, int npiece)
+{
+	struct sunxi_ce_hash_sg sg[SUNXI_HASH_SG_MAX];
+	u8 ref[32], md[32];
+	u32 off = 0;
+	int k = 0, p = 0;
+
+	sunxi_sha_calc(ref, 32, buf, len);
+	sunxi_ce_hash_init(ctx, SUNXI_SHA256);
+	while (off < len) {
+		sg[k].addr = buf + off;
+		sg[k].len  = min(piece[p], len - off);
+		off += sg[k].len;
+		p = (p + 1) % npiece;
+		if (++k == SUNXI_HASH_SG_MAX || off == len) {
+			if (sunxi_ce_hash_update_async(ctx, sg, k))
+				return -1;
+			k = 0;
+		}
+	}
+	if (sunxi_ce_hash_final(ctx, md))
+		return -1;
+
+	return memcmp(md, ref, 32) ? -1 : 0;
+}
+
+/* message lengths around the block size against several ways to cut them */
+static void hash_split_test(struct sunxi_ce_hash_ctx *ctx, u8 *buf, u32 len)
+{
+	static const u32 lens[] = { 1, 3, 63, 64, 65, 128, 129, 0x1000,
+				    0x1001, 0x10000 };
+	static const u32 pieces[][4] = {
+		{ 4 }, { 60 }, { 64 }, { 68 }, { 128 }, { 0x1000 },
+		{ 4, 64, 60, 132 }, { 128, 8, 0x1000, 64 },
+	};
+	int i, j, npiece, runs = 0, bad = 0;
+
+	for (i = 0; i < ARRAY_SIZE(lens) && lens[i] <= len; i++) {
+		for (j = 0; j < ARRAY_SIZE(pieces); j++) {
+			for (npiece = 1; npiece < ARRAY_SIZE(pieces[j]) &&
+					 pieces[j][npiece]; npiece++)
+				;
+			runs++;
+			if (hash_split_check(ctx, buf, lens[i], pieces[j],
+					     npiece)) {
+				printf("split: len %u piece %u.. mismatch\n",
+				       lens[i], pieces[j][0]);
+				bad++;
+			}
+		}
+	}
+	printf("split: %d of %d digests match\n", runs - bad, runs);
+}
+
+/*
+ * sunxi_ce_test hash_perf <addr> <len>: check the chained digests for a
+ * number of split patterns, then sha256 over len bytes at addr, cut
+ * into blocks of 4K..1M, through the one-shot call per block, one
+ * incremental update per block and scatter lists submitted without waiting
+ */
+int do_hash_perf_test(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
+{
+	static const u32 sizes[] = { 0x1000, 0x4000, 0x10000, 0x40000,
+				     0x100000 };
+	struct sunxi_ce_hash_sg sg[SUNXI_HASH_SG_MAX];
+	struct sunxi_ce_hash_ctx *ctx;
+	u8 ref[32], md[32];
+	u8 *buf;
+	u32 len, bs, total;
+	ulong start;
+	int i, j, k, n;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+
+	buf = (u8 *)IOMEM_ADDR(simple_strtoul(argv[1], NULL, 16));
+	len = simple_strtoul(argv[2], NULL, 16);
+	ctx = memalign(CACHE_LINE_SIZE, sizeof(*ctx));
+	if (!ctx)
+		return CMD_RET_FAILURE;
+
+	sunxi_ss_open();
+	hash_split_test(ctx, buf, len);
+
+	start = timer_get_us();
+	sunxi_sha_calc(ref, 32, buf, len);
+	hash_perf_show("one-shot", len, len, timer_get_us() - start, 1);
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		bs = sizes[i];
+		n = len / bs;
+		total = n * bs;
+		if (!n)
+			break;
+		sunxi_sha_calc(ref, 32, buf, total);
+
+		/* the existing path, one call per block */
+		start = timer_get_us();
+		for (j = 0; j < n; j++)
+			sunxi_sha_calc(md, 32, buf + j * bs, bs);
+		hash_perf_show("per-block", bs, total,
+			       timer_get_us() - start, 1);
+
+		start = timer_get_us();
+		sunxi_ce_hash_init(ctx, SUNXI_SHA256);
+		for (j = 0; j < n; j++)
+			sunxi_ce_hash_update(ctx, buf + j * bs, bs);
+		sunxi_ce_hash_final(ctx, md);
+		hash_perf_show("update", bs, total, timer_get_us() - start,
+			       !memcmp(md, ref, 32));
+
+		start = timer_get_us();
+		sunxi_ce_hash_init(ctx, SUNXI_SHA256);
+		for (j = 0; j < n; j += k) {
+			for (k = 0; k < SUNXI_HASH_SG_MAX && j + k < n; k++) {
+				sg[k].addr = buf + (j + k) * bs;
+				sg[k].len  = bs;
+			}
+			sunxi_ce_hash_update_async(ctx, sg, k);
+		}
+		sunxi_ce_hash_final(ctx, md);
+		hash_perf_show("sg-async", bs, total, timer_get_us() - start,
+			       !memcmp(md, ref, 32));
+	}
+
+	free(ctx);
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
+#define CE_BENCH_MIN_US		200000
+#define CE_BENCH_CHUNK		0x10000
+#define CE_BENCH_MIN_LEN	64
+#define CE_BENCH_DEF_MAX	0x100000
+#define CE_BENCH_SM2_LOOPS	16
+
+#define AES_128_CBC_USERKEY_CFG                                              \
+	((SS_AES_KEY_128BIT << 0) | (SS_AES_MODE_CBC << 8) |  \
+	 (SS_KEY_SELECT_INPUT << 20))
+
+#define AES_128_CTR_USERKEY_CFG                                              \
+	((SS_AES_KEY_128BIT << 0) | (SS_AES_MODE_CTR << 8) |  \
+	 (SS_KEY_SELECT_INPUT << 20))
+
+struct ce_bench {
+	u8 *src;
+	u8 *dst;
+	u32 len;
+	u32 s_ctl;
+	u8 md[32];
+	u8 key[AES_KEY_LENGTH];
+#ifdef CONFIG_AES
+	u8 key_exp[AES_EXPAND_KEY_LENGTH];
+#endif
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	struct sunxi_ce_hash_ctx *hctx;
+#endif
+#ifdef CONFIG_RSA_SOFTWARE_EXP
+	struct key_prop prop;
+#endif
+	u8 *n;
+	u8 *e;
+};
+
+typedef void (*ce_bench_fn_t)(struct ce_bench *b);
+
+/* repeat fn until CE_BENCH_MIN_US has passed, so small sizes are not noise */
+static void ce_bench_run(const char *alg, const char *impl, ce_bench_fn_t fn,
+			 struct ce_bench *b)
+{
+	ulong start, us;
+	u32 iters = 0;
+
+	start = timer_get_us();
+	do {
+		fn(b);
+		iters++;
+		us = timer_get_us() - start;
+	} while (us < CE_BENCH_MIN_US);
+
+	ce_bench_row(alg, impl, b->len, iters, us);
+}
+
+/*
+ * the ce rows include the cache maintenance done by the driver; time the
+ * same flush (of dirty lines) and invalidate on their own so it can be
+ * taken out again
+ */
+static void ce_bench_cache(struct ce_bench *b)
+{
+	ulong flush_us = 0, inval_us = 0, start;
+	u32 iters = 0, off;
+
+	do {
+		for (off = 0; off < b->len; off += CACHE_LINE_SIZE)
+			writeb(readb(b->src + off), b->src + off);
+		start = timer_get_us();
+		flush_cache((ulong)b->src, b->len);
+		flush_us += timer_get_us() - start;
+
+		start = timer_get_us();
+		invalidate_dcache_range((ulong)b->dst, (ulong)b->dst + b->len);
+		inval_us += timer_get_us() - start;
+		iters++;
+	} while (flush_us + inval_us < CE_BENCH_MIN_US / 4 && iters < 100000);
+
+	ce_bench_row("cache", "flush", b->len, iters, flush_us);
+	ce_bench_row("cache", "inval", b->len, iters, inval_us);
+}
+
+static void ce_bench_sha_ce(struct ce_bench *b)
+{
+	sunxi_sha_calc_ce(b->md, 32, b->src, b->len);
+}
+
+#ifdef CONFIG_SUNXI_CE_SHA_DISPATCH
+static void ce_bench_sha_auto(struct ce_bench *b)
+{
+	sunxi_sha_calc(b->md, 32, b->src, b->len);
+}
+#endif
+
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+static void ce_bench_sha_chunk(struct ce_bench *b)
+{
+	u32 off, n;
+
+	sunxi_ce_hash_init(b->hctx, SUNXI_SHA256);
+	for (off = 0; off < b->len; off += n) {
+		n = min_t(u32, b->len - off, CE_BENCH_CHUNK);
+		sunxi_ce_hash_update(b->hctx, b->src + off, n);
+	}
+	sunxi_ce_hash_final(b->hctx, b->md);
+}
+#endif
+
+#ifdef CONFIG_SHA256
+static void ce_bench_sha_cpu(struct ce_bench *b)
+{
+	sha256_csum_wd(b->src, b->len, b->md, CHUNKSZ_SHA256);
+}
+#endif
+
+static void ce_bench_sha256(struct ce_bench *b)
+{
+	ce_bench_run("sha256", "ce", ce_bench_sha_ce, b);
+#ifdef CONFIG_SUNXI_CE_SHA_DISPATCH
+	/* sunxi_sha_calc(), small sizes go to the cpu */
+	ce_bench_run("sha256", "auto", ce_bench_sha_auto, b);
+#endif
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	if (b->hctx)
+		ce_bench_run("sha256", "ce-chunk", ce_bench_sha_chunk, b);
+#endif
+#ifdef CONFIG_SHA256
+	{
+		u8 md[32];
+
+		sunxi_sha_calc_ce(md, 32, b->src, b->len);
+		ce_bench_run("sha256", "cpu", ce_bench_sha_cpu, b);
+		if (memcmp(md, b->md, 32))
+			printf("# sha256 %u: ce and cpu digests differ\n",
+			       b->len);
+	}
+#endif
+}
+
+static void ce_bench_aes_ce(struct ce_bench *b)
+{
+	sunxi_aes_with_hardware(b->dst, b->src, b->len, b->key,
+				AES_KEY_LENGTH, b->s_ctl,
+				ALG_AES | (SS_DIR_ENCRYPT << 8));
+}
+
+/* ecb only, the driver starts every call from a zero iv */
+static void ce_bench_aes_chunk(struct ce_bench *b)
+{
+	u32 off, n;
+
+	for (off = 0; off < b->len; off += n) {
+		n = min_t(u32, b->len - off, CE_BENCH_CHUNK);
+		sunxi_aes_with_hardware(b->dst + off, b->src + off, n, b->key,
+					AES_KEY_LENGTH, b->s_ctl,
+					ALG_AES | (SS_DIR_ENCRYPT << 8));
+	}
+}
+
+#ifdef CONFIG_AES
+static void ce_bench_aes_cpu_ecb(struct ce_bench *b)
+{
+	u32 off;
+
+	for (off = 0; off < b->len; off += AES_KEY_LENGTH)
+		aes_encrypt(b->src + off, b->key_exp, b->dst + off);
+}
+
+static void ce_bench_aes_cpu_cbc(struct ce_bench *b)
+{
+	u8 iv[AES_KEY_LENGTH] = { 0 };
+
+	aes_cbc_encrypt_blocks(b->key_exp, iv, b->src, b->dst,
+			       b->len / AES_KEY_LENGTH);
+}
+
+/* lib/aes.c has no ctr mode, build it from the block cipher */
+static void ce_bench_aes_cpu_ctr(struct ce_bench *b)
+{
+	u8 ctr[AES_KEY_LENGTH] = { 0 };
+	u8 ks[AES_KEY_LENGTH];
+	u32 off;
+	int i;
+
+	for (off = 0; off < b->len; off += AES_KEY_LENGTH) {
+		aes_encrypt(ctr, b->key_exp, ks);
+		for (i = 0; i < AES_KEY_LENGTH; i++)
+			b->dst[off + i] = b->src[off + i] ^ ks[i];
+		for (i = AES_KEY_LENGTH - 1; i >= 0 && !++ctr[i]; i--)
+			;
+	}
+}
+#endif
+
+static void ce_bench_aes(struct ce_bench *b)
+{
+	b->s_ctl = AES_128_ECB_USERKEY_CFG;
+	ce_bench_run("aes128-ecb", "ce", ce_bench_aes_ce, b);
+	ce_bench_run("aes128-ecb", "ce-chunk", ce_bench_aes_chunk, b);
+	b->s_ctl = AES_128_CBC_USERKEY_CFG;
+	ce_bench_run("aes128-cbc", "ce", ce_bench_aes_ce, b);
+	b->s_ctl = AES_128_CTR_USERKEY_CFG;
+	ce_bench_run("aes128-ctr", "ce", ce_bench_aes_ce, b);
+#ifdef CONFIG_AES
+	ce_bench_run("aes128-ecb", "cpu", ce_bench_aes_cpu_ecb, b);
+	ce_bench_run("aes128-cbc", "cpu", ce_bench_aes_cpu_cbc, b);
+	ce_bench_run("aes128-ctr", "cpu", ce_bench_aes_cpu_ctr, b);
+#endif
+}
+
+static void ce_bench_rsa_ce(struct ce_bench *b)
+{
+	sunxi_normal_rsa(b->n, 256, b->e, 3, b->dst, 256, b->src, 256);
+}
+
+#ifdef CONFIG_RSA_SOFTWARE_EXP
+static void ce_bench_rsa_cpu(struct ce_bench *b)
+{
+	rsa_mod_exp_sw(b->src, 256, &b->prop, b->dst);
+}
+#endif
+
+/*
+ * rsa-2048 public key operation (verify), e = 65537. the modulus is
+ * 2^2048 - 1: it costs the same as a real key, and R^2 mod n = 1 and
+ * n0inv = 1 let the software path run without a bignum library.
+ */
+static void ce_bench_rsa(struct ce_bench *b)
+{
+	static const u8 e[3] = { 0x01, 0x00, 0x01 };
+	u32 len = b->len;
+	u8 *n, *rr;
+
+	n = memalign(CACHE_LINE_SIZE, 2 * 256 + 8);
+	if (!n)
+		return;
+	rr = n + 256;
+	memset(n, 0xff, 256);
+	memset(rr, 0, 256);
+	rr[255] = 1;
+	memcpy(rr + 256, "\0\0\0\0\0\x01\0\x01", 8);
+	b->n = n;
+	b->e = (u8 *)e;
+	/* keep the input below the modulus */
+	b->src[0] &= 0x7f;
+	b->len = 256;
+
+	ce_bench_run("rsa2048", "ce", ce_bench_rsa_ce, b);
+#ifdef CONFIG_RSA_SOFTWARE_EXP
+	b->prop.modulus = n;
+	b->prop.rr = rr;
+	b->prop.public_exponent = rr + 256;
+	b->prop.n0inv = 1;
+	b->prop.num_bits = 2048;
+	b->prop.exp_len = 8;
+	ce_bench_run("rsa2048", "cpu", ce_bench_rsa_cpu, b);
+#endif
+
+	b->len = len;
+	free(n);
+}
+
+/*
+ * sunxi_ce_test bench <addr> [max] [sha256|aes|rsa|sm2|all]: sweep the
+ * buffer size from 64 bytes to max (default 1M, up to 64M) in steps of 4
+ * and print one csv row per algorithm, implementation and size (see
+ * ce_bench_row()). 2 * max bytes at addr are used, source then destination.
+ */
+int do_ce_bench(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
+{
+	struct ce_bench *b;
+	const char *alg = "all";
+	char loops[12];
+	char *sm2_argv[] = { "sm2", loops };
+	int all, i, ret = CMD_RET_SUCCESS;
+	u32 max = CE_BENCH_DEF_MAX;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	if (argc > 2)
+		max = simple_strtoul(argv[2], NULL, 16);
+	if (argc > 3)
+		alg = argv[3];
+	all = !strcmp(alg, "all");
+
+	b = memalign(CACHE_LINE_SIZE, sizeof(*b));
+	if (!b)
+		return CMD_RET_FAILURE;
+	memset(b, 0, sizeof(*b));
+	b->src = (u8 *)IOMEM_ADDR(simple_strtoul(argv[1], NULL, 16));
+	b->dst = b->src + ALIGN(max, CACHE_LINE_SIZE);
+	if ((ulong)b->src & (CACHE_LINE_SIZE - 1)) {
+		pr_err("addr not aligned with cache line size 0x%x\n",
+		       CACHE_LINE_SIZE);
+		ret = CMD_RET_FAILURE;
+		goto out;
+	}
+	for (i = 0; i < AES_KEY_LENGTH; i++)
+		b->key[i] = i;
+#ifdef CONFIG_AES
+	aes_expand_key(b->key, b->key_exp);
+#endif
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	b->hctx = memalign(CACHE_LINE_SIZE, sizeof(*b->hctx));
+#endif
+
+	sunxi_ss_open();
+#ifdef CONFIG_SUNXI_CE_SHA_DISPATCH
+	if (all || !strcmp(alg, "sha256"))
+		printf("# sha256: cpu up to %u bytes, set SUNXI_CE_SHA_CPU_MAX to match\n",
+		       sunxi_sha_calibrate());
+#endif
+	printf("bench,alg,impl,bytes,ops,us,KBps,ops_per_s\n");
+
+	for (b->len = CE_BENCH_MIN_LEN; b->len && b->len <= max;
+	     b->len <<= 2) {
+		ce_bench_cache(b);
+		if (all || !strcmp(alg, "sha256"))
+			ce_bench_sha256(b);
+		if (all || !strcmp(alg, "aes"))
+			ce_bench_aes(b);
+	}
+
+	b->len = max;
+	if ((all || !strcmp(alg, "rsa")) && max >= 256)
+		ce_bench_rsa(b);
+	if (all || !strcmp(alg, "sm2")) {
+		snprintf(loops, sizeof(loops), "%u", CE_BENCH_SM2_LOOPS);
+		do_sm2_test(cmdtp, flag, 2, sm2_argv);
+	}
+
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	free(b->hctx);
+#endif
+out:
+	free(b);
+
+	return ret;
+}
+
 static cmd_tbl_t cmd_ce_test[] = {
 	U_BOOT_CMD_MKENT(hash, 5, 0, do_hash_test, "", ""),
 	U_BOOT_CMD_MKENT(rsa, 10, 0, do_rsa_test, "", ""),
@@ -658,6 +1188,10 @@ static cmd_tbl_t cmd_ce_test[] = {
 	U_BOOT_CMD_MKENT(aes, 10, 0, do_aes_test, "", ""),
 	U_BOOT_CMD_MKENT(sm2, 10, 0, do_sm2_test, "", ""),
 	U_BOOT_CMD_MKENT(aes_perf_test, 10, 0, do_aes_perf_test, "", ""),
+	U_BOOT_CMD_MKENT(bench, 5, 0, do_ce_bench, "", ""),
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	U_BOOT_CMD_MKENT(hash_perf, 5, 0, do_hash_perf_test, "", ""),
+#endif
 };
 
 int do_sunxi_ce_test(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
@@ -83,3 +83,71 @@ U_BOOT_CMD(
 	"do dma test",
 	"sunxi_dma src_addr dst_addr"
 );
+
+#ifdef CONFIG_SUNXI_DMA_MEMCPY
+#include <sunxi_dma_memcpy.h>
+
+/* keep every measurement above ~16MB moved so the timer resolution is fine */
+#define DMA_BENCH_BYTES		(16 << 20)
+
+static ulong dma_bench_run(void *(*copy)(void *, const void *, size_t),
+			   void *dst, void *src, uint len)
+{
+	ulong start, us;
+	uint i, loops;
+
+	loops = max(DMA_BENCH_BYTES / len, 1U);
+	start = timer_get_us();
+	for (i = 0; i < loops; i++)
+		copy(dst, src, len);
+	us = timer_get_us() - start;
+
+	/* bytes per us is MB/s */
+	return us ? (ulong)((u64)len * loops / us) : 0;
+}
+
+static void *dma_bench_cpu_memcpy(void *dst, const void *src, size_t len)
+{
+	memcpy(dst, src, len);
+	/* the dma result has to be visible in dram, charge the cpu the same */
+	flush_cache((ulong)dst, len);
+
+	return dst;
+}
+
+static int do_sunxi_dma_bench(cmd_tbl_t *cmdtp, int flag, int argc,
+			      char *const argv[])
+{
+	ulong src_addr, dst_addr;
+	uint max_len = 4 << 20, len;
+	ulong cpu, dma;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+
+	src_addr = simple_strtoul(argv[1], NULL, 16);
+	dst_addr = simple_strtoul(argv[2], NULL, 16);
+	if (argc == 4)
+		max_len = simple_strtoul(argv[3], NULL, 16);
+
+	printf("%10s %12s %12s\n", "size", "cpu(MB/s)", "dma(MB/s)");
+	for (len = 4 << 10; len <= max_len; len <<= 1) {
+		cpu = dma_bench_run(dma_bench_cpu_memcpy, (void *)dst_addr,
+				    (void *)src_addr, len);
+		dma = dma_bench_run(sunxi_dma_memcpy, (void *)dst_addr,
+				    (void *)src_addr, len);
+		printf("%10u %12lu %12lu%s\n", len, cpu, dma,
+		       len < CONFIG_SUNXI_DMA_MEMCPY_THRESHOLD ?
+		       "  (cpu fallback)" : "");
+	}
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	sunxi_dma_bench,	4,	1,	do_sunxi_dma_bench,
+	"compare cpu and dma memcpy throughput",
+	"src_addr dst_addr [max_len]\n"
+	"  - copy 4K..max_len (default 4M) bytes with the cpu and the dma"
+);
+#endif
@@ -14,9 +14,11 @@
 #include <memalign.h>
 #include <sunxi_flash.h>
 #include <part.h>
+#include <mmc.h>
 #include <image.h>
 #include <android_image.h>
 #include <rtos_image.h>
+#include <sunxi_boot_record.h>
 #include <sys_partition.h>
 #include <sprite_download.h>
 #include "../sprite/sparse/sparse.h"
@@ -33,6 +35,7 @@ static int sunxi_flash_read_part(struct blk_desc *desc, disk_partition_t *info,
 	u32 start_block;
 	u8 *addr;
 	image_header_t *uz_hdr;
+	ulong rec = sunxi_boot_record_begin();
 
 	addr	= (void *)buffer;
 	start_block = (uint)info->start;
@@ -84,6 +87,7 @@ static int sunxi_flash_read_part(struct blk_desc *desc, disk_partition_t *info,
 
 	ret = blk_dread(desc, start_block, rblock, (u_char *)addr);
 	ret = (ret == rblock) ? 0 : 1;
+	sunxi_boot_record(BOOT_REC_IMAGE_READ, rec, rbytes, ret);
 	sunxi_mem_info((char *)info->name, (void *)buffer, rbytes);
 	debug("sunxi flash read :offset %x, %d bytes %s\n", (u32)info->start,
 	      rbytes, ret == 0 ? "OK" : "ERROR");
@@ -184,6 +188,163 @@ int do_sunxi_flash_boot0(cmd_tbl_t *cmdtp, int flag, int argc,
 	return -1;
 }
 
+#ifdef CONFIG_SUNXI_SPINOR_READAHEAD
+#include <u-boot/crc.h>
+
+static int nor_bench_crc(void *priv, void *buf, u32 len)
+{
+	u32 *crc = priv;
+
+	*crc = crc32(*crc, buf, len);
+
+	return 0;
+}
+
+static void nor_bench_show(const char *name, u64 bytes, ulong us)
+{
+	ulong kbps = us ? (ulong)(bytes * 1000 / us) : 0;
+
+	printf("%-10s %lld bytes in %lu us, %lu.%03lu MB/s\n", name, bytes, us,
+	       kbps / 1000, kbps % 1000);
+}
+
+/*
+ * compare a plain chunked read against the read-ahead stream, both with
+ * a crc32 consumer so the overlap has something to hide
+ */
+static int do_sunxi_flash_nor_bench(int argc, char *const argv[])
+{
+	struct sunxi_flash_stream_stat st;
+	uint start, nblock, chunk, i, n;
+	u32 crc_sync = 0, crc_stream = 0;
+	ulong t, us;
+	void *buf;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	if (sunxi_partition_get_info_byname(argv[1], &start, &nblock)) {
+		printf("partition %s not found\n", argv[1]);
+		return CMD_RET_FAILURE;
+	}
+	if (argc > 2)
+		nblock = min(nblock, (uint)(ALIGN(simple_strtoul(argv[2], NULL,
+							       16), 512) / 512));
+
+	chunk = CONFIG_SUNXI_SPINOR_READAHEAD_CHUNK / 512;
+	buf = malloc_align(chunk * 512, 64);
+	if (!buf)
+		return CMD_RET_FAILURE;
+
+	t = timer_get_us();
+	for (i = 0; i < nblock; i += n) {
+		n = min(chunk, nblock - i);
+		if (!sunxi_flash_read(start + i, n, buf)) {
+			printf("sync read failed at block 0x%x\n", start + i);
+			free_align(buf);
+			return CMD_RET_FAILURE;
+		}
+		crc_sync = crc32(crc_sync, buf, n * 512);
+	}
+	us = timer_get_us() - t;
+	free_align(buf);
+
+	if (sunxi_spinor_read_stream(start, nblock, nor_bench_crc,
+				     &crc_stream, &st)) {
+		printf("stream read failed\n");
+		return CMD_RET_FAILURE;
+	}
+
+	nor_bench_show("sync", (u64)nblock * 512, us);
+	nor_bench_show("readahead", st.bytes, st.total_us);
+	printf("readahead: wait %lu us, consumer %lu us\n", st.wait_us,
+	       st.cb_us);
+	printf("bus limit: %u.%03u MB/s (%u Hz x%d)\n",
+	       st.bus_hz / 8 * st.buswidth / 1000000,
+	       st.bus_hz / 8 * st.buswidth / 1000 % 1000, st.bus_hz,
+	       st.buswidth);
+	if (crc_sync != crc_stream) {
+		printf("crc mismatch: sync 0x%08x, readahead 0x%08x\n",
+		       crc_sync, crc_stream);
+		return CMD_RET_FAILURE;
+	}
+	printf("crc 0x%08x\n", crc_sync);
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
+#ifdef CONFIG_AW_RAWNAND_READ_PREFETCH
+static int do_sunxi_flash_nand_bench(int argc, char *const argv[])
+{
+	loff_t from;
+	size_t len;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+	from = simple_strtoull(argv[1], NULL, 16);
+	len = simple_strtoul(argv[2], NULL, 16);
+
+	return rawnand_mtd_read_bench(from, len) ? CMD_RET_FAILURE :
+						   CMD_RET_SUCCESS;
+}
+#endif
+
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+/* the region is read first and written back, nothing is lost */
+static int do_sunxi_flash_mmc_bench(int argc, char *const argv[])
+{
+	struct mmc *mmc;
+	lbaint_t start, blkcnt;
+
+	if (argc < 4)
+		return CMD_RET_USAGE;
+	mmc = find_mmc_device(simple_strtoul(argv[1], NULL, 10));
+	if (!mmc || mmc_init(mmc)) {
+		printf("no mmc device %s\n", argv[1]);
+		return CMD_RET_FAILURE;
+	}
+	start = simple_strtoul(argv[2], NULL, 16);
+	blkcnt = simple_strtoul(argv[3], NULL, 16);
+
+	return mmc_write_bench(mmc, start, blkcnt) ? CMD_RET_FAILURE :
+						     CMD_RET_SUCCESS;
+}
+#endif
+
+#ifdef CONFIG_MMC_SUNXI
+static int do_sunxi_flash_mmc_dma_bench(int argc, char *const argv[])
+{
+	struct mmc *mmc;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+	mmc = find_mmc_device(simple_strtoul(argv[1], NULL, 10));
+	if (!mmc || mmc_init(mmc)) {
+		printf("no mmc device %s\n", argv[1]);
+		return CMD_RET_FAILURE;
+	}
+
+	return sunxi_mmc_dma_bench(mmc, simple_strtoul(argv[2], NULL, 16)) ?
+		CMD_RET_FAILURE : CMD_RET_SUCCESS;
+}
+#endif
+
+#if defined(CONFIG_AW_MTD_RAWNAND) || defined(CONFIG_AW_MTD_SPINAND)
+static int do_sunxi_flash_nand_stat(int argc, char *const argv[])
+{
+	int reset = argc > 1 && !strcmp(argv[1], "reset");
+
+#ifdef CONFIG_AW_MTD_RAWNAND
+	rawnand_mtd_wait_stat(reset);
+#endif
+#ifdef CONFIG_AW_MTD_SPINAND
+	spinand_mtd_wait_stat(reset);
+#endif
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
 int do_sunxi_flash(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 {
 	struct blk_desc *desc;
@@ -203,6 +364,42 @@ int do_sunxi_flash(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 		argv++;
 		return do_sunxi_flash_boot0(cmdtp, flag, argc, argv);
 	}
+#ifdef CONFIG_SUNXI_SPINOR_READAHEAD
+	if (!strcmp("nor_bench", argv[1])) {
+		ret = do_sunxi_flash_nor_bench(argc - 1, argv + 1);
+		if (ret == CMD_RET_USAGE)
+			goto usage;
+		return ret;
+	}
+#endif
+#ifdef CONFIG_AW_RAWNAND_READ_PREFETCH
+	if (!strcmp("nand_bench", argv[1])) {
+		ret = do_sunxi_flash_nand_bench(argc - 1, argv + 1);
+		if (ret == CMD_RET_USAGE)
+			goto usage;
+		return ret;
+	}
+#endif
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+	if (!strcmp("mmc_bench", argv[1])) {
+		ret = do_sunxi_flash_mmc_bench(argc - 1, argv + 1);
+		if (ret == CMD_RET_USAGE)
+			goto usage;
+		return ret;
+	}
+#endif
+#ifdef CONFIG_MMC_SUNXI
+	if (!strcmp("mmc_dma_bench", argv[1])) {
+		ret = do_sunxi_flash_mmc_dma_bench(argc - 1, argv + 1);
+		if (ret == CMD_RET_USAGE)
+			goto usage;
+		return ret;
+	}
+#endif
+#if defined(CONFIG_AW_MTD_RAWNAND) || defined(CONFIG_AW_MTD_SPINAND)
+	if (!strcmp("nand_stat", argv[1]))
+		return do_sunxi_flash_nand_stat(argc - 1, argv + 1);
+#endif
 
 	/* at least four arguments please */
 	if (argc < 4)
@@ -287,4 +484,20 @@ U_BOOT_CMD(sunxi_flash, 6, 1, do_sunxi_flash, "sunxi_flash sub-system",
 	   "sunxi_flash write <mem_addr> <part_name> [size]\n"
 	   "sunxi_flash write <mem_addr> <part_name> [offset] [size]\n"
 	   "sunxi_flash boot0 force_dram_update_size <new_val> \n"
-	   "sunxi_flash boot0 force_dram_update_flag <new_val> \n");
+	   "sunxi_flash boot0 force_dram_update_flag <new_val> \n"
+#ifdef CONFIG_SUNXI_SPINOR_READAHEAD
+	   "sunxi_flash nor_bench <part_name> [size]\n"
+#endif
+#ifdef CONFIG_AW_RAWNAND_READ_PREFETCH
+	   "sunxi_flash nand_bench <mtd_offset> <size>\n"
+#endif
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+	   "sunxi_flash mmc_bench <dev> <start_sector> <sectors>\n"
+#endif
+#ifdef CONFIG_MMC_SUNXI
+	   "sunxi_flash mmc_dma_bench <dev> <start_sector>\n"
+#endif
+#if defined(CONFIG_AW_MTD_RAWNAND) || defined(CONFIG_AW_MTD_SPINAND)
+	   "sunxi_flash nand_stat [reset]\n"
+#endif
+	   );
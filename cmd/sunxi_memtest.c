@@ -27,6 +27,7 @@
 #include <common.h>
 #include <command.h>
 #include <malloc.h>
+#include <div64.h>
 
 #include "./memtest/types.h"
 /*#include "./memtest/sizes.h"*/
@@ -57,6 +58,26 @@ struct test tests[] = {
     { NULL, NULL }
 };
 
+/* same suite, pattern tests run with burst accesses */
+struct test fast_tests[] = {
+    { "Random Value", fast_test_random_value },
+    { "Compare XOR", test_xor_comparison },
+    { "Compare SUB", test_sub_comparison },
+    { "Compare MUL", test_mul_comparison },
+    { "Compare DIV",test_div_comparison },
+    { "Compare OR", test_or_comparison },
+    { "Compare AND", test_and_comparison },
+    { "Sequential Increment", test_seqinc_comparison },
+    { "Solid Bits", fast_test_solidbits_comparison },
+    { "Block Sequential", fast_test_blockseq_comparison },
+    { "Checkerboard", fast_test_checkerboard_comparison },
+    { "Bit Spread", fast_test_bitspread_comparison },
+    { "Bit Flip", fast_test_bitflip_comparison },
+    { "Walking Ones", fast_test_walkbits1_comparison },
+    { "Walking Zeroes", fast_test_walkbits0_comparison },
+    { NULL, NULL }
+};
+
 /* Sanity checks and portability helper macros. */
 #ifdef _SC_VERSION
 void check_posix_system(void) {
@@ -96,6 +117,22 @@ int memtester_pagesize(void) {
 /* Function declarations */
 void usage(char *me);
 
+/* bytes the fast tests wrote and read back, over the time they took */
+static void memtest_print_bw(ulong start)
+{
+    ulong ms = get_timer(start);
+    ull rate;
+
+    if (!memtest_fast_bytes)
+        return;
+    if (!ms)
+        ms = 1;
+    /* GB/s * 100 */
+    rate = ((memtest_fast_bytes >> 20) * 100000) >> 10;
+    do_div(rate, ms);
+    printf("  %lu.%02lu GB/s", (ulong)rate / 100, (ulong)rate % 100);
+}
+
 
 
 static int do_memtester(cmd_tbl_t * cmdtp, int flag, int argc, char * const argv[])
@@ -114,6 +151,9 @@ static int do_memtester(cmd_tbl_t * cmdtp, int flag, int argc, char * const argv
     int  memshift;
     size_t maxbytes = CONFIG_SYS_MALLOC_LEN; /* addressable memory, in bytes */
     size_t maxmb = (maxbytes >> 20) + 1; /* addressable memory, in MB */
+    struct test *suite = tests;
+    int (*stuck_address)(ulv *bufa, size_t count) = test_stuck_address;
+    ulong start;
 
     printf("memtester version 4.2.1 (%d-bit)\n", UL_LEN);
     printf("Copyright (C) 2010 Charles Cazabon.\n");
@@ -189,6 +229,16 @@ static int do_memtester(cmd_tbl_t * cmdtp, int flag, int argc, char * const argv
 
 
     loops = simple_strtoul(argv[2], NULL, 10);
+
+    if (argc > 3) {
+        if (strcmp(argv[3], "fast") && strcmp(argv[3], "dma")) {
+            usage(argv[0]);
+            return -1;
+        }
+        suite = fast_tests;
+        stuck_address = fast_test_stuck_address;
+        memtest_use_dma = !strcmp(argv[3], "dma");
+    }
     
     
     printf("want %uMB (%u bytes)\n", wantmb, wantbytes);
@@ -227,16 +277,24 @@ static int do_memtester(cmd_tbl_t * cmdtp, int flag, int argc, char * const argv
         printf(":\n");
         printf("  %-20s: ", "Stuck Address");
         //fflush(stdout);
-        if (!test_stuck_address(aligned, bufsize / sizeof(ul))) {
-             printf("ok\n");
+        memtest_fast_bytes = 0;
+        start = get_timer(0);
+        if (!stuck_address(aligned, bufsize / sizeof(ul))) {
+             printf("ok");
+             memtest_print_bw(start);
+             printf("\n");
         } else {
             exit_code |= EXIT_FAIL_ADDRESSLINES;
         }
         for (i=0;;i++) {
-            if (!tests[i].name) break;
-            printf("  %-20s: ", tests[i].name);
-            if (!tests[i].fp(bufa, bufb, count)) {
-                printf("ok\n");
+            if (!suite[i].name) break;
+            printf("  %-20s: ", suite[i].name);
+            memtest_fast_bytes = 0;
+            start = get_timer(0);
+            if (!suite[i].fp(bufa, bufb, count)) {
+                printf("ok");
+                memtest_print_bw(start);
+                printf("\n");
             } else {
                 exit_code |= EXIT_FAIL_OTHERTEST;
             }
@@ -254,7 +312,7 @@ static int do_memtester(cmd_tbl_t * cmdtp, int flag, int argc, char * const argv
 
 /* Function definitions */
 void usage(char *me) {
-    printf("\nUsage: %s [-p physaddrbase] <mem>[B|K|M|G] [loops]\n", me);
+    printf("\nUsage: %s [-p physaddrbase] <mem>[B|K|M|G] [loops] [fast|dma]\n", me);
 }
 
 /* -------------------------------------------------------------------- */
@@ -262,5 +320,7 @@ void usage(char *me) {
 U_BOOT_CMD(
 	memtester, CONFIG_SYS_MAXARGS, 1,	do_memtester,
 	"start application at address 'addr'",
-	"memtester size[M] loop\n"
+	"memtester size[M] loop [fast|dma]\n"
+	"  fast: pattern tests with burst accesses, GB/s per test\n"
+	"  dma:  fast, block sequential fills by the dma engine\n"
 );
@@ -13,6 +13,13 @@
 #include <private_uboot.h>
 #include <sunxi_image_verifier.h>
 #include <mapmem.h>
+#ifdef CONFIG_SUNXI_RTOS_STREAM
+#include <sunxi_flash.h>
+#include <sunxi_board.h>
+#include <sys_partition.h>
+#include <u-boot/zlib.h>
+#include <asm/unaligned.h>
+#endif
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -22,13 +29,412 @@ struct spare_rtos_head_t {
 	unsigned int rtos_dram_size;     /* rtos dram size, passed by uboot*/
 };
 
+static void sunxi_rtos_jump(unsigned long dst_addr)
+{
+	void (*rtos_entry)(void);
+
+	// prepare for rtos
+	board_quiesce_devices();
+	cleanup_before_linux();
+
+	// save dram_size and rotpk_hash to rtos header
+	((struct spare_rtos_head_t *)dst_addr)->rtos_dram_size = uboot_spare_head.boot_data.dram_scan_size;
+	memcpy(((struct spare_rtos_head_t *)dst_addr)->rotpk_hash, uboot_spare_head.hash, 32);
+
+	printf("jump to rtos!\n\n\n");
+	rtos_entry = (void (*)(void))dst_addr;
+	rtos_entry();
+}
+
+#ifdef CONFIG_SUNXI_RTOS_STREAM
+#define RTOS_STREAM_CHUNK	(64 * 1024)
+#define RTOS_LZ4_MAGIC		0x184D2204
+
+enum {
+	RTOS_FMT_NONE,
+	RTOS_FMT_GZIP,
+	RTOS_FMT_LZ4,
+};
+
+/* lz4 frame parser states */
+enum {
+	LZ4S_FRAME,
+	LZ4S_BHDR,
+	LZ4S_BLOCK,
+	LZ4S_BSUM,
+	LZ4S_DONE,
+};
+
+struct rtos_stream {
+	u8 *dst;
+	ulong dst_len;
+	ulong out;
+	ulong gz_len;		/* from the gzip trailer */
+	ulong skip;		/* partition bytes in front of the payload */
+	ulong left;		/* payload bytes not seen yet */
+	int fmt;
+	int done;
+	ulong dec_us;
+	z_stream zs;
+	int zs_init;
+#ifdef CONFIG_LZ4
+	int state;
+	u32 need;		/* bytes the current state collects */
+	u32 have;
+	u8 hdr[16];
+	u32 bsize;
+	int raw;
+	int bsum;
+	u8 *blk;
+	u32 blk_max;
+#endif
+};
+
+static int rtos_gz_feed(struct rtos_stream *st, u8 *in, u32 len)
+{
+	int off, r;
+
+	if (!st->zs_init) {
+		/* the first chunk always holds the whole gzip header */
+		off = gzip_parse_header(in, len);
+		if (off < 0)
+			return -1;
+		st->zs.zalloc = gzalloc;
+		st->zs.zfree = gzfree;
+		r = inflateInit2(&st->zs, -MAX_WBITS);
+		if (r != Z_OK) {
+			printf("Error: inflateInit2() returned %d\n", r);
+			return -1;
+		}
+		st->zs_init = 1;
+		st->zs.next_out = st->dst;
+		st->zs.avail_out = st->dst_len;
+		in += off;
+		len -= off;
+	}
+
+	st->zs.next_in = in;
+	st->zs.avail_in = len;
+	r = inflate(&st->zs, Z_NO_FLUSH);
+	st->out = st->zs.next_out - st->dst;
+	if (r == Z_STREAM_END) {
+		st->done = 1;
+		return 0;
+	}
+	if ((r != Z_OK && r != Z_BUF_ERROR) || st->zs.avail_in) {
+		printf("Error: inflate() returned %d, 0x%lx bytes out\n", r,
+		       st->out);
+		return -1;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_LZ4
+/* collect st->need bytes of a header into st->hdr */
+static int rtos_lz4_take(struct rtos_stream *st, u8 **in, u32 *len)
+{
+	u32 n = min(*len, st->need - st->have);
+
+	memcpy(st->hdr + st->have, *in, n);
+	st->have += n;
+	*in += n;
+	*len -= n;
+
+	return st->have == st->need;
+}
+
+static int rtos_lz4_block(struct rtos_stream *st, u8 *src)
+{
+	int ret;
+
+	if (st->raw) {
+		if (st->bsize > st->dst_len - st->out)
+			return -1;
+		memcpy(st->dst + st->out, src, st->bsize);
+		st->out += st->bsize;
+		return 0;
+	}
+
+	ret = ulz4fn_block(src, st->bsize, st->dst + st->out,
+			   st->dst_len - st->out);
+	if (ret < 0) {
+		printf("Error: lz4 block at 0x%lx: %d\n", st->out, ret);
+		return -1;
+	}
+	st->out += ret;
+
+	return 0;
+}
+
+/*
+ * walk the frame as it streams in. blocks are independent, a block that
+ * sits completely inside the chunk is decompressed in place, one that
+ * spans two chunks is collected in st->blk first.
+ */
+static int rtos_lz4_feed(struct rtos_stream *st, u8 *in, u32 len)
+{
+	u8 flg, bd;
+	u32 raw, n;
+
+	while (len && st->state != LZ4S_DONE) {
+		switch (st->state) {
+		case LZ4S_FRAME:
+			if (!rtos_lz4_take(st, &in, &len))
+				break;
+			flg = st->hdr[4];
+			bd = st->hdr[5];
+			if (st->need == 6) {
+				if ((flg >> 6) != 1 || !(flg & 0x20) ||
+				    !(flg & 0x08) || (flg & 0x01)) {
+					printf("Error: lz4 frame needs v1, independent blocks, content size and no dict id\n");
+					return -1;
+				}
+				/* content size and header checksum follow */
+				st->need += 9;
+				break;
+			}
+			st->dst_len = min(st->dst_len,
+					  (ulong)get_unaligned_le64(st->hdr + 6));
+			st->bsum = flg & 0x10;
+			st->blk_max = 1 << (8 + 2 * ((bd >> 4) & 7));
+			st->blk = malloc(st->blk_max);
+			if (!st->blk)
+				return -1;
+			st->state = LZ4S_BHDR;
+			st->need = 4;
+			st->have = 0;
+			break;
+		case LZ4S_BHDR:
+			if (!rtos_lz4_take(st, &in, &len))
+				break;
+			raw = get_unaligned_le32(st->hdr);
+			st->bsize = raw & 0x7fffffff;
+			st->raw = raw >> 31;
+			st->have = 0;
+			if (!st->bsize) {
+				st->state = LZ4S_DONE;
+				st->done = 1;
+			} else if (st->bsize > st->blk_max) {
+				printf("Error: lz4 block of 0x%x bytes\n",
+				       st->bsize);
+				return -1;
+			} else {
+				st->state = LZ4S_BLOCK;
+			}
+			break;
+		case LZ4S_BLOCK:
+			if (!st->have && len >= st->bsize) {
+				if (rtos_lz4_block(st, in))
+					return -1;
+				in += st->bsize;
+				len -= st->bsize;
+			} else {
+				n = min(len, st->bsize - st->have);
+				memcpy(st->blk + st->have, in, n);
+				st->have += n;
+				in += n;
+				len -= n;
+				if (st->have < st->bsize)
+					break;
+				if (rtos_lz4_block(st, st->blk))
+					return -1;
+			}
+			st->have = 0;
+			st->need = 4;
+			st->state = st->bsum ? LZ4S_BSUM : LZ4S_BHDR;
+			break;
+		case LZ4S_BSUM:
+			if (!rtos_lz4_take(st, &in, &len))
+				break;
+			st->have = 0;
+			st->state = LZ4S_BHDR;
+			break;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+static int rtos_stream_cb(void *priv, void *buf, u32 len)
+{
+	struct rtos_stream *st = priv;
+	u8 *in = buf;
+	ulong t;
+	u32 n;
+	int ret;
+
+	if (st->skip) {
+		n = min((ulong)len, st->skip);
+		st->skip -= n;
+		in += n;
+		len -= n;
+	}
+	len = min((ulong)len, st->left);
+	st->left -= len;
+	if (!len || st->done)
+		return 0;
+
+	if (st->fmt == RTOS_FMT_NONE) {
+		if (len >= 4 && get_unaligned_le32(in) == RTOS_LZ4_MAGIC) {
+#ifdef CONFIG_LZ4
+			st->fmt = RTOS_FMT_LZ4;
+			st->need = 6;
+			st->dst_len = ~0UL - (ulong)st->dst;
+#else
+			printf("rtos: lz4 image, but lz4 is not enabled\n");
+			return -1;
+#endif
+		} else {
+			st->fmt = RTOS_FMT_GZIP;
+			st->dst_len = st->gz_len;
+		}
+	}
+
+	t = timer_get_us();
+#ifdef CONFIG_LZ4
+	if (st->fmt == RTOS_FMT_LZ4)
+		ret = rtos_lz4_feed(st, in, len);
+	else
+#endif
+		ret = rtos_gz_feed(st, in, len);
+	st->dec_us += timer_get_us() - t;
+
+	return ret;
+}
+
+/* feed [start, start + nblock) of the flash to cb, chunk by chunk */
+static int rtos_stream_read(uint start, uint nblock, sunxi_flash_stream_cb cb,
+			    void *priv, struct sunxi_flash_stream_stat *stat)
+{
+	uint chunk = RTOS_STREAM_CHUNK / 512, i, n;
+	ulong begin, t;
+	void *buf;
+	int ret = 0;
+
+#ifdef CONFIG_SUNXI_SPINOR_READAHEAD
+	if (get_boot_storage_type() == STORAGE_NOR)
+		return sunxi_spinor_read_stream(start, nblock, cb, priv, stat);
+#endif
+
+	memset(stat, 0, sizeof(*stat));
+	buf = memalign(CONFIG_SYS_CACHELINE_SIZE, RTOS_STREAM_CHUNK);
+	if (!buf)
+		return -1;
+
+	begin = timer_get_us();
+	for (i = 0; i < nblock && !ret; i += n) {
+		n = min(chunk, nblock - i);
+		t = timer_get_us();
+		if (!sunxi_flash_read(start + i, n, buf)) {
+			ret = -1;
+			break;
+		}
+		stat->wait_us += timer_get_us() - t;
+		stat->bytes += n * 512;
+		ret = cb(priv, buf, n * 512);
+	}
+	stat->total_us = timer_get_us() - begin;
+	free(buf);
+
+	return ret;
+}
+
+/*
+ * read the compressed image from part_name and decompress it to dst_addr
+ * while it is being read, without staging it in dram
+ */
+static int sunxi_rtos_stream_part(const char *part_name, unsigned long dst_addr)
+{
+	struct sunxi_flash_stream_stat stat;
+	struct rtos_img_hdr *rtos_hdr;
+	struct rtos_stream *st;
+	uint start, size, pos, tail;
+	u32 src_len;
+	ulong t;
+	u8 *page;
+	int ret = -1;
+
+	t = get_timer(0);
+	if (sunxi_partition_get_info_byname(part_name, &start, &size)) {
+		printf("rtos: no partition %s\n", part_name);
+		return -1;
+	}
+
+	st = calloc(1, sizeof(*st));
+	page = memalign(CONFIG_SYS_CACHELINE_SIZE, sizeof(*rtos_hdr));
+	if (!st || !page)
+		goto out;
+
+	if (!sunxi_flash_read(start, sizeof(*rtos_hdr) / 512, page))
+		goto out;
+	rtos_hdr = (struct rtos_img_hdr *)page;
+	src_len = rtos_hdr->rtos_size;
+	if (memcmp(rtos_hdr->rtos_magic, RTOS_BOOT_MAGIC, 8) || src_len < 8 ||
+	    DIV_ROUND_UP(rtos_hdr->rtos_offset + src_len, 512) > size) {
+		printf("rtos: bad image in %s\n", part_name);
+		goto out;
+	}
+
+	st->dst = (u8 *)dst_addr;
+	st->skip = rtos_hdr->rtos_offset % 512;
+	st->left = src_len;
+	pos = start + rtos_hdr->rtos_offset / 512;
+	size = DIV_ROUND_UP(st->skip + src_len, 512);
+
+	/* a gzip image keeps its output size in the trailer, read just that */
+	tail = st->skip + src_len - 4;
+	if (!sunxi_flash_read(pos + tail / 512, tail % 512 > 508 ? 2 : 1, page))
+		goto out;
+	st->gz_len = get_unaligned_le32(page + tail % 512);
+
+	ret = rtos_stream_read(pos, size, rtos_stream_cb, st, &stat);
+	if (!ret && (!st->done || (st->fmt == RTOS_FMT_GZIP &&
+				   st->out != st->gz_len))) {
+		printf("rtos: truncated image, 0x%lx bytes out\n", st->out);
+		ret = -1;
+	}
+	if (ret) {
+		printf("Error uncompressing %s\n", part_name);
+		goto out;
+	}
+
+	printf("rtos: %s 0x%x -> 0x%lx bytes in %lu ms (flash wait %lu ms, decompress %lu ms)\n",
+	       st->fmt == RTOS_FMT_LZ4 ? "lz4" : "gzip", src_len, st->out,
+	       get_timer(t), stat.wait_us / 1000, st->dec_us / 1000);
+out:
+	if (st) {
+		if (st->zs_init)
+			inflateEnd(&st->zs);
+#ifdef CONFIG_LZ4
+		free(st->blk);
+#endif
+		free(st);
+	}
+	free(page);
+
+	return ret;
+}
+#endif
+
 static int do_sunxi_boot_rtos(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 {
 	unsigned long src_addr = 0, dst_addr = 0;
 	unsigned long src_len = 0, dst_len = 0;
 	struct rtos_img_hdr *rtos_hdr;
 	int ret = 0;
-	void (*rtos_entry)(void);
+
+#ifdef CONFIG_SUNXI_RTOS_STREAM
+	if (argc == 4 && !strcmp(argv[1], "part")) {
+		dst_addr = simple_strtoul(argv[3], NULL, 16);
+		if (sunxi_rtos_stream_part(argv[2], dst_addr))
+			return CMD_RET_FAILURE;
+		printf("boot to rtos entry: %lu ms\n", get_timer(0));
+		sunxi_rtos_jump(dst_addr);
+		return 0;
+	}
+#endif
 
 	if (argc < 3) {
 		printf("parameters error\n");
@@ -54,24 +460,18 @@ static int do_sunxi_boot_rtos(cmd_tbl_t *cmdtp, int flag, int argc, char *const
 		return ret;
 	}
 
-	// prepare for rtos
-	board_quiesce_devices();
-	cleanup_before_linux();
-
-	// save dram_size and rotpk_hash to rtos header
-	((struct spare_rtos_head_t *)dst_addr)->rtos_dram_size = uboot_spare_head.boot_data.dram_scan_size;
-	memcpy(((struct spare_rtos_head_t *)dst_addr)->rotpk_hash, uboot_spare_head.hash, 32);
-
-	printf("jump to rtos!\n\n\n");
-	rtos_entry = (void (*)(void))dst_addr;
-	rtos_entry();
+	sunxi_rtos_jump(dst_addr);
 
 	return 0;
 }
 
 
 U_BOOT_CMD(
-	boot_rtos,	3,	1,	do_sunxi_boot_rtos,
+	boot_rtos,	4,	1,	do_sunxi_boot_rtos,
 	"boot rtos",
-	"rtos_gz_addr rtos_addr"
+	"rtos_gz_addr rtos_addr\n"
+#ifdef CONFIG_SUNXI_RTOS_STREAM
+	"boot_rtos part <partition> <rtos_addr>\n"
+	"    - read and decompress the image from the partition in one pass"
+#endif
 );
@@ -55,6 +55,7 @@
 #include <sunxi_board.h>
 #include <sunxi_flash.h>
 #endif
+#include <sunxi_boot_record.h>
 #ifdef CONFIG_SOUND_SUNXI_BOOT_TONE
 #include <sunxi_boot_tone.h>
 #endif
@@ -512,6 +513,9 @@ static int initr_sunxi_plat(void)
 {
 	__maybe_unused int ret = 0;
 	__maybe_unused int workmode = get_boot_work_mode();
+	__maybe_unused ulong rec;
+
+	sunxi_boot_record_init();
 #ifdef CONFIG_IR_BOOT_RECOVERY
 	check_ir_boot_recovery();
 #endif
@@ -527,7 +531,9 @@ static int initr_sunxi_plat(void)
 
 		tick_printf("flash init start\n");
 #ifdef CONFIG_SUNXI_FLASH
+		rec = sunxi_boot_record_begin();
 		ret = sunxi_flash_init_ext();
+		sunxi_boot_record(BOOT_REC_FLASH_PROBE, rec, 0, ret);
 		if (ret)
 			return ret;
 #endif
@@ -547,7 +553,9 @@ static int initr_sunxi_plat(void)
 #endif
 
 #ifdef CONFIG_BOOT_GUI
+	rec = sunxi_boot_record_begin();
 	sunxi_early_logo_display();
+	sunxi_boot_record(BOOT_REC_LOGO, rec, 0, 0);
 #endif
 
 #ifdef CONFIG_SUNXI_BOX_STANDBY
@@ -561,7 +569,9 @@ static int initr_sunxi_plat(void)
 	if (gd->boot_logo_addr) {
 		tick_printf("flash init start\n");
 #ifdef CONFIG_SUNXI_FLASH
+		rec = sunxi_boot_record_begin();
 		ret = sunxi_flash_init_ext();
+		sunxi_boot_record(BOOT_REC_FLASH_PROBE, rec, 0, ret);
 		if (ret)
 			return ret;
 #endif
@@ -576,7 +586,10 @@ static int initr_sunxi_plat(void)
 	initr_env();
 #endif
 
-		sunxi_probe_partition_map();
+		rec = sunxi_boot_record_begin();
+		sunxi_boot_record(BOOT_REC_GPT_PARSE, rec, 0,
+				  sunxi_probe_partition_map());
+		sunxi_boot_record_load();
 	}
 
 #ifdef CONFIG_SUNXI_ROTPK_BURN_ENABLE_BY_TOOL
@@ -664,11 +677,14 @@ static int should_load_env(void)
 
 static int initr_env(void)
 {
+	ulong rec = sunxi_boot_record_begin();
+
 	/* initialize environment */
 	if (should_load_env())
 		env_relocate();
 	else
 		set_default_env(NULL);
+	sunxi_boot_record(BOOT_REC_ENV, rec, 0, 0);
 #ifdef CONFIG_OF_CONTROL
 	env_set_addr("fdtcontroladdr", gd->fdt_blob);
 #endif
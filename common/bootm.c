@@ -18,6 +18,7 @@
 #include <lzma/LzmaTypes.h>
 #include <lzma/LzmaDec.h>
 #include <lzma/LzmaTools.h>
+#include <sunxi_boot_record.h>
 #if defined(CONFIG_CMD_USB)
 #include <usb.h>
 #endif
@@ -541,6 +542,7 @@ static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 	bool no_overlap;
 	void *load_buf, *image_buf;
 	int err;
+	ulong rec;
 
 #ifdef CONFIG_ENV_IS_IN_SUNXI_FLASH
 	ulong bootm_len = env_get_hex("load_boot_len_max", CONFIG_SYS_BOOTM_LEN);
@@ -550,9 +552,11 @@ static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 	load_buf = map_sysmem(load, 0);
 	image_buf = map_sysmem(os.image_start, image_len);
 	sunxi_mem_info("kernel", load_buf, image_len);
+	rec = sunxi_boot_record_begin();
 	err = bootm_decomp_image(os.comp, load, os.image_start, os.type,
 				 load_buf, image_buf, image_len,
 				 bootm_len, load_end);
+	sunxi_boot_record(BOOT_REC_DECOMP, rec, *load_end - load, err);
 	if (err) {
 		bootstage_error(BOOTSTAGE_ID_DECOMP_IMAGE);
 		return err;
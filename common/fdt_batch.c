@@ -0,0 +1,417 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Batched device tree fixups
+ *
+ * Every fdt_setprop()/fdt_delprop() on a live blob looks the node up from
+ * the root again and memmove()s everything behind the change. With a few
+ * dozen fixups before boot that adds up to many passes over the blob.
+ *
+ * Here the changes are only recorded. fdt_batch_apply() replays them on
+ * their (node, property) pairs to work out the final state, then copies
+ * the structure block once into a scratch buffer, substituting, dropping
+ * and inserting properties on the way, and finally copies the result back.
+ * Property placement and string table appends follow libfdt exactly:
+ * new properties go to the front of their node, the latest first, and new
+ * names are appended to the strings block in the order they were created.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <fdt_batch.h>
+
+#define FDT_BATCH_GROW		16
+
+struct fdt_batch_op {
+	int node;
+	int del;
+	char *name;
+	void *val;
+	int len;
+};
+
+/* final state of one (node, property) pair */
+struct fdt_batch_prop {
+	int node;
+	const char *name;
+	int exists;
+	int created;		/* (re)added, lives at the front of the node */
+	int seq;		/* op index of the last creation */
+	int nameoff;
+	const void *val;
+	int len;
+};
+
+static void *fdt_batch_grow(void *array, int *max, int size)
+{
+	void *p = realloc(array, (*max + FDT_BATCH_GROW) * size);
+
+	if (p)
+		*max += FDT_BATCH_GROW;
+
+	return p;
+}
+
+static void fdt_batch_release(struct fdt_batch *b)
+{
+	int i;
+
+	for (i = 0; i < b->nr_ops; i++)
+		free(b->ops[i].name);
+	for (i = 0; i < b->nr_paths; i++)
+		free(b->paths[i].path);
+	free(b->ops);
+	free(b->paths);
+	b->ops = NULL;
+	b->paths = NULL;
+	b->nr_ops = 0;
+	b->nr_paths = 0;
+	b->max_ops = 0;
+	b->max_paths = 0;
+}
+
+int fdt_batch_begin(struct fdt_batch *b, void *fdt)
+{
+	memset(b, 0, sizeof(*b));
+	b->fdt = fdt;
+
+	return fdt_check_header(fdt);
+}
+
+int fdt_batch_path_offset(struct fdt_batch *b, const char *path)
+{
+	struct fdt_batch_path *p;
+	int i;
+
+	for (i = 0; i < b->nr_paths; i++)
+		if (!strcmp(b->paths[i].path, path))
+			return b->paths[i].offset;
+
+	if (b->nr_paths == b->max_paths) {
+		p = fdt_batch_grow(b->paths, &b->max_paths, sizeof(*p));
+		if (!p)
+			return fdt_path_offset(b->fdt, path);
+		b->paths = p;
+	}
+	p = &b->paths[b->nr_paths];
+	p->path = strdup(path);
+	if (!p->path)
+		return fdt_path_offset(b->fdt, path);
+	p->offset = fdt_path_offset(b->fdt, path);
+	b->nr_paths++;
+
+	return p->offset;
+}
+
+static int fdt_batch_queue(struct fdt_batch *b, int nodeoffset,
+			   const char *name, const void *val, int len, int del)
+{
+	struct fdt_batch_op *op;
+	int namelen = strlen(name) + 1;
+	int next;
+
+	if (nodeoffset < 0)
+		return nodeoffset;
+	if (fdt_next_tag(b->fdt, nodeoffset, &next) != FDT_BEGIN_NODE)
+		return -FDT_ERR_BADOFFSET;
+
+	if (b->nr_ops == b->max_ops) {
+		op = fdt_batch_grow(b->ops, &b->max_ops, sizeof(*op));
+		if (!op)
+			goto nomem;
+		b->ops = op;
+	}
+	op = &b->ops[b->nr_ops];
+	op->name = malloc(namelen + len);
+	if (!op->name)
+		goto nomem;
+	memcpy(op->name, name, namelen);
+	op->val = op->name + namelen;
+	if (len)
+		memcpy(op->val, val, len);
+	op->len = len;
+	op->node = nodeoffset;
+	op->del = del;
+	b->nr_ops++;
+
+	return 0;
+nomem:
+	b->err = -FDT_ERR_NOSPACE;
+
+	return b->err;
+}
+
+int fdt_batch_setprop_off(struct fdt_batch *b, int nodeoffset,
+			  const char *name, const void *val, int len)
+{
+	return fdt_batch_queue(b, nodeoffset, name, val, len, 0);
+}
+
+int fdt_batch_setprop(struct fdt_batch *b, const char *path,
+		      const char *name, const void *val, int len)
+{
+	return fdt_batch_queue(b, fdt_batch_path_offset(b, path), name, val,
+			       len, 0);
+}
+
+int fdt_batch_delprop_off(struct fdt_batch *b, int nodeoffset,
+			  const char *name)
+{
+	return fdt_batch_queue(b, nodeoffset, name, NULL, 0, 1);
+}
+
+int fdt_batch_delprop(struct fdt_batch *b, const char *path, const char *name)
+{
+	return fdt_batch_queue(b, fdt_batch_path_offset(b, path), name, NULL,
+			       0, 1);
+}
+
+int fdt_batch_enable_node(struct fdt_batch *b, const char *path, int onoff)
+{
+	return fdt_batch_setprop_string(b, path, "status",
+					onoff ? "okay" : "disabled");
+}
+
+void fdt_batch_abort(struct fdt_batch *b)
+{
+	fdt_batch_release(b);
+}
+
+/* same search as libfdt, a match may be the tail of a longer name */
+static int fdt_batch_find_string(const char *strtab, int tabsize,
+				 const char *s)
+{
+	int len = strlen(s) + 1;
+	const char *p;
+
+	for (p = strtab; p <= strtab + tabsize - len; p++)
+		if (!memcmp(p, s, len))
+			return p - strtab;
+
+	return -1;
+}
+
+static int fdt_batch_prop_cmp(const void *a, const void *b)
+{
+	const struct fdt_batch_prop *pa = a, *pb = b;
+
+	if (pa->node != pb->node)
+		return pa->node - pb->node;
+
+	/* created properties of a node are emitted newest first */
+	return pb->seq - pa->seq;
+}
+
+/*
+ * replay the ops on their (node, name) pairs. strtab holds the original
+ * strings block with room behind it; names of created properties are
+ * appended as libfdt would. returns the number of pairs.
+ */
+static int fdt_batch_resolve(struct fdt_batch *b, struct fdt_batch_prop *props,
+			     char *strtab, int *strsize)
+{
+	struct fdt_batch_prop *p;
+	int nr = 0, i, j, off;
+
+	for (i = 0; i < b->nr_ops; i++) {
+		struct fdt_batch_op *op = &b->ops[i];
+
+		for (j = 0, p = props; j < nr; j++, p++)
+			if (p->node == op->node && !strcmp(p->name, op->name))
+				break;
+		if (j == nr) {
+			memset(p, 0, sizeof(*p));
+			p->node = op->node;
+			p->name = op->name;
+			p->seq = -1;
+			p->exists = fdt_get_property(b->fdt, op->node, op->name,
+						     NULL) != NULL;
+			nr++;
+		}
+
+		if (op->del) {
+			p->exists = 0;
+			p->created = 0;
+			continue;
+		}
+		if (!p->exists) {
+			off = fdt_batch_find_string(strtab, *strsize, op->name);
+			if (off < 0) {
+				off = *strsize;
+				strcpy(strtab + off, op->name);
+				*strsize += strlen(op->name) + 1;
+			}
+			p->exists = 1;
+			p->created = 1;
+			p->seq = i;
+			p->nameoff = off;
+		}
+		p->val = op->val;
+		p->len = op->len;
+	}
+
+	return nr;
+}
+
+static int fdt_batch_emit(char *out, int pos, int end, int nameoff,
+			  const void *val, int len)
+{
+	struct fdt_property *prop = (struct fdt_property *)(out + pos);
+	int size = sizeof(*prop) + ALIGN(len, FDT_TAGSIZE);
+
+	if (pos + size > end)
+		return -FDT_ERR_NOSPACE;
+
+	prop->tag = cpu_to_fdt32(FDT_PROP);
+	prop->len = cpu_to_fdt32(len);
+	prop->nameoff = cpu_to_fdt32(nameoff);
+	memcpy(prop->data, val, len);
+	memset(prop->data + len, 0, ALIGN(len, FDT_TAGSIZE) - len);
+
+	return pos + size;
+}
+
+/* copy the structure block to out + pos, applying the resolved props */
+static int fdt_batch_walk(void *fdt, struct fdt_batch_prop *props, int nr,
+			  char *out, int pos, int end)
+{
+	const char *base = (const char *)fdt + fdt_off_dt_struct(fdt);
+	const struct fdt_property *prop;
+	struct fdt_batch_prop *p, *first = props, *last = props;
+	int offset = 0, next;
+	uint32_t tag;
+	const char *name;
+
+	do {
+		tag = fdt_next_tag(fdt, offset, &next);
+		if (tag == FDT_END && next < 0)
+			return next;
+
+		if (tag == FDT_PROP) {
+			prop = fdt_offset_ptr(fdt, offset, sizeof(*prop));
+			name = fdt_string(fdt, fdt32_to_cpu(prop->nameoff));
+			for (p = first; p < last; p++)
+				if (!strcmp(p->name, name))
+					break;
+			if (p < last) {
+				/*
+				 * deleted, or deleted and added again at the
+				 * front of the node: the original goes away
+				 */
+				if (p->exists && !p->created)
+					pos = fdt_batch_emit(out, pos, end,
+						fdt32_to_cpu(prop->nameoff),
+						p->val, p->len);
+				if (pos < 0)
+					return pos;
+				offset = next;
+				continue;
+			}
+		}
+
+		if (pos + next - offset > end)
+			return -FDT_ERR_NOSPACE;
+		memcpy(out + pos, base + offset, next - offset);
+		pos += next - offset;
+
+		if (tag == FDT_BEGIN_NODE) {
+			first = last;
+			while (first < props + nr && first->node < offset)
+				first++;
+			for (last = first; last < props + nr &&
+			     last->node == offset; last++)
+				;
+			for (p = first; p < last; p++) {
+				if (!p->created)
+					continue;
+				pos = fdt_batch_emit(out, pos, end, p->nameoff,
+						     p->val, p->len);
+				if (pos < 0)
+					return pos;
+			}
+		}
+		offset = next;
+	} while (tag != FDT_END);
+
+	return pos;
+}
+
+int fdt_batch_apply(struct fdt_batch *b, int bufsize)
+{
+	void *fdt = b->fdt;
+	struct fdt_batch_prop *props = NULL;
+	char *out = NULL, *strtab = NULL;
+	int off_struct, struct_end, gap, strsize, namesize = 0;
+	int nr, pos, ret, i;
+	ulong start = timer_get_us();
+
+	ret = b->err;
+	if (ret || !b->nr_ops)
+		goto out;
+
+	ret = fdt_check_header(fdt);
+	if (ret)
+		goto out;
+	if (fdt_version(fdt) < 17) {
+		ret = -FDT_ERR_BADVERSION;
+		goto out;
+	}
+	if (fdt_off_mem_rsvmap(fdt) > fdt_off_dt_struct(fdt) ||
+	    fdt_off_dt_strings(fdt) < fdt_off_dt_struct(fdt) +
+				      fdt_size_dt_struct(fdt)) {
+		ret = -FDT_ERR_BADLAYOUT;
+		goto out;
+	}
+
+	for (i = 0; i < b->nr_ops; i++)
+		namesize += strlen(b->ops[i].name) + 1;
+	strsize = fdt_size_dt_strings(fdt);
+	strtab = malloc(strsize + namesize);
+	props = malloc(b->nr_ops * sizeof(*props));
+	out = malloc(bufsize);
+	if (!strtab || !props || !out) {
+		ret = -FDT_ERR_NOSPACE;
+		goto out;
+	}
+	memcpy(strtab, (char *)fdt + fdt_off_dt_strings(fdt), strsize);
+
+	nr = fdt_batch_resolve(b, props, strtab, &strsize);
+	qsort(props, nr, sizeof(*props), fdt_batch_prop_cmp);
+
+	/* header and reserve map are not touched */
+	off_struct = fdt_off_dt_struct(fdt);
+	memcpy(out, fdt, off_struct);
+	pos = fdt_batch_walk(fdt, props, nr, out, off_struct, bufsize);
+	if (pos < 0) {
+		ret = pos;
+		goto out;
+	}
+
+	/* keep whatever padding sat between the struct and strings blocks */
+	struct_end = off_struct + fdt_size_dt_struct(fdt);
+	gap = fdt_off_dt_strings(fdt) - struct_end;
+	if (pos + gap + strsize > bufsize) {
+		ret = -FDT_ERR_NOSPACE;
+		goto out;
+	}
+	memcpy(out + pos, (char *)fdt + struct_end, gap);
+	memcpy(out + pos + gap, strtab, strsize);
+
+	fdt_set_size_dt_struct(out, pos - off_struct);
+	fdt_set_off_dt_strings(out, pos + gap);
+	fdt_set_size_dt_strings(out, strsize);
+	if (fdt_version(out) > 17)
+		fdt_set_version(out, 17);
+	if (pos + gap + strsize > fdt_totalsize(out))
+		fdt_set_totalsize(out, bufsize);
+
+	memcpy(fdt, out, pos + gap + strsize);
+	ret = 0;
+out:
+	free(out);
+	free(props);
+	free(strtab);
+	b->apply_us = timer_get_us() - start;
+	fdt_batch_release(b);
+
+	return ret;
+}
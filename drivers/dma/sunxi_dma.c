@@ -249,6 +249,21 @@ int sunxi_dma_start(ulong hdma, uint saddr, uint daddr, uint bytes)
 	return 0;
 }
 
+/* start a caller built (and already flushed) descriptor chain */
+int sunxi_dma_start_desc(ulong hdma, sunxi_dma_desc *desc)
+{
+	sunxi_dma_source *dma_source = (sunxi_dma_source *)hdma;
+	sunxi_dma_channal_reg *channal = dma_source->channal;
+
+	if (!dma_source->used)
+		return -1;
+
+	writel((ulong)(desc), &channal->desc_addr);
+	writel(1, &channal->enable);
+
+	return 0;
+}
+
 int sunxi_dma_stop(ulong hdma)
 {
 	sunxi_dma_source *dma_source = (sunxi_dma_source *)hdma;
@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * (C) Copyright 2007-2026
+ * Allwinner Technology Co., Ltd. <www.allwinnertech.com>
+ *
+ * memcpy/memset offload on a free sunxi dma channel.
+ *
+ * Only the cache line aligned middle of the destination is given to the
+ * engine, so no line is ever shared between the cpu and the dma. The head
+ * and tail are handled by the cpu while the engine runs. Requests below
+ * CONFIG_SUNXI_DMA_MEMCPY_THRESHOLD, or where src and dst disagree on word
+ * alignment, are plain cpu copies.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <asm/arch/dma.h>
+#include <asm/io.h>
+#include <sunxi_dma_memcpy.h>
+
+#define DMA_MEMCPY_LINE		CONFIG_SYS_CACHELINE_SIZE
+/* byte_count is 25 bits wide, keep every descriptor well below that */
+#define DMA_MEMCPY_DESC_MAX	(16 << 20)
+#define DMA_MEMCPY_WAIT_CYC	(8)
+#define DMA_MEMCPY_BLOCK_SIZE	(32 / 8)
+
+static u32 dma_memcpy_config(int fill)
+{
+	sunxi_dma_channal_config cfg;
+	u32 val;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.src_drq_type     = DMAC_CFG_TYPE_DRAM;
+	cfg.src_burst_length = fill ? DMAC_CFG_SRC_1_BURST : DMAC_CFG_SRC_8_BURST;
+	cfg.src_addr_mode    = fill ? DMAC_CFG_SRC_ADDR_TYPE_IO_MODE :
+				      DMAC_CFG_SRC_ADDR_TYPE_LINEAR_MODE;
+	cfg.src_data_width   = DMAC_CFG_SRC_DATA_WIDTH_32BIT;
+	cfg.dst_drq_type     = DMAC_CFG_TYPE_DRAM;
+	cfg.dst_burst_length = DMAC_CFG_DEST_8_BURST;
+	cfg.dst_addr_mode    = DMAC_CFG_DEST_ADDR_TYPE_LINEAR_MODE;
+	cfg.dst_data_width   = DMAC_CFG_DEST_DATA_WIDTH_32BIT;
+
+	memcpy(&val, &cfg, sizeof(val));
+
+	return val;
+}
+
+static void dma_memcpy_finish(struct sunxi_dma_xfer *xfer, int status)
+{
+	if (xfer->hdma) {
+		sunxi_dma_stop(xfer->hdma);
+		sunxi_dma_release(xfer->hdma);
+		/* drop lines the cpu may have speculatively fetched meanwhile */
+		invalidate_dcache_range(xfer->dma_dst,
+					xfer->dma_dst + xfer->dma_len);
+		free_align(xfer->desc);
+		xfer->hdma = 0;
+		xfer->desc = NULL;
+	}
+	xfer->status = status;
+	if (xfer->complete)
+		xfer->complete(xfer, xfer->data);
+}
+
+/*
+ * hand [dst, dst + len) to the engine. dst and len are cache line aligned.
+ * fill != NULL selects memset, with the engine reading the pattern word
+ * from a fixed address.
+ */
+static int dma_memcpy_submit(struct sunxi_dma_xfer *xfer, ulong dst,
+			     ulong src, ulong len, const u32 *fill)
+{
+	sunxi_dma_desc *desc;
+	u32 *pattern;
+	u32 config, commit_para;
+	ulong off, chunk;
+	int i, count;
+
+	count = DIV_ROUND_UP(len, DMA_MEMCPY_DESC_MAX);
+	desc = malloc_align(count * sizeof(sunxi_dma_desc) + DMA_MEMCPY_LINE,
+			    DMA_MEMCPY_LINE);
+	if (!desc)
+		return -1;
+
+	sunxi_dma_init();
+	xfer->hdma = sunxi_dma_request_from_last(DMAC_DMATYPE_NORMAL);
+	if (!xfer->hdma) {
+		free_align(desc);
+		return -1;
+	}
+
+	pattern = (u32 *)(desc + count);
+	if (fill) {
+		*pattern = *fill;
+		src = (ulong)pattern;
+	}
+
+	config = dma_memcpy_config(fill != NULL);
+	commit_para = DMA_MEMCPY_WAIT_CYC | (DMA_MEMCPY_BLOCK_SIZE << 8);
+	for (i = 0, off = 0; i < count; i++, off += chunk) {
+		chunk = min(len - off, (ulong)DMA_MEMCPY_DESC_MAX);
+		desc[i].config      = config;
+		desc[i].source_addr = fill ? src : src + off;
+		desc[i].dest_addr   = dst + off;
+		desc[i].byte_count  = chunk;
+		desc[i].commit_para = commit_para;
+		desc[i].link        = (i == count - 1) ? SUNXI_DMA_LINK_NULL :
+				      (u32)(ulong)&desc[i + 1];
+	}
+
+	flush_cache((ulong)desc, ALIGN(count * sizeof(sunxi_dma_desc) +
+				       sizeof(u32), DMA_MEMCPY_LINE));
+	if (!fill)
+		flush_cache(round_down(src, DMA_MEMCPY_LINE),
+			    round_up(src + len, DMA_MEMCPY_LINE) -
+			    round_down(src, DMA_MEMCPY_LINE));
+	flush_cache(dst, len);
+
+	xfer->desc    = desc;
+	xfer->dma_dst = dst;
+	xfer->dma_len = len;
+	xfer->status  = SUNXI_DMA_XFER_BUSY;
+
+	return sunxi_dma_start_desc(xfer->hdma, desc);
+}
+
+static void dma_memcpy_xfer_init(struct sunxi_dma_xfer *xfer,
+				 sunxi_dma_xfer_cb_t complete, void *data)
+{
+	memset(xfer, 0, sizeof(*xfer));
+	xfer->complete = complete;
+	xfer->data     = data;
+	xfer->start    = get_timer(0);
+}
+
+int sunxi_dma_memcpy_async(struct sunxi_dma_xfer *xfer, void *dst,
+			   const void *src, size_t len,
+			   sunxi_dma_xfer_cb_t complete, void *data)
+{
+	ulong d = (ulong)dst, s = (ulong)src;
+	ulong mid, mid_len, head;
+
+	dma_memcpy_xfer_init(xfer, complete, data);
+
+	mid = ALIGN(d, DMA_MEMCPY_LINE);
+	mid_len = (d + len > mid) ?
+		  round_down(d + len - mid, DMA_MEMCPY_LINE) : 0;
+	head = mid - d;
+
+	if (len < CONFIG_SUNXI_DMA_MEMCPY_THRESHOLD || !mid_len ||
+	    ((d ^ s) & 3) ||
+	    dma_memcpy_submit(xfer, mid, s + head, mid_len, NULL)) {
+		memcpy(dst, src, len);
+		dma_memcpy_finish(xfer, SUNXI_DMA_XFER_DONE);
+		return 0;
+	}
+
+	memcpy(dst, src, head);
+	memcpy((void *)(mid + mid_len), (void *)(s + head + mid_len),
+	       len - head - mid_len);
+
+	return 0;
+}
+
+int sunxi_dma_memset_async(struct sunxi_dma_xfer *xfer, void *dst, int c,
+			   size_t len, sunxi_dma_xfer_cb_t complete, void *data)
+{
+	ulong d = (ulong)dst;
+	ulong mid, mid_len, head;
+	u32 fill = (u8)c * 0x01010101;
+
+	dma_memcpy_xfer_init(xfer, complete, data);
+
+	mid = ALIGN(d, DMA_MEMCPY_LINE);
+	mid_len = (d + len > mid) ?
+		  round_down(d + len - mid, DMA_MEMCPY_LINE) : 0;
+	head = mid - d;
+
+	if (len < CONFIG_SUNXI_DMA_MEMCPY_THRESHOLD || !mid_len ||
+	    dma_memcpy_submit(xfer, mid, 0, mid_len, &fill)) {
+		memset(dst, c, len);
+		dma_memcpy_finish(xfer, SUNXI_DMA_XFER_DONE);
+		return 0;
+	}
+
+	memset(dst, c, head);
+	memset((void *)(mid + mid_len), c, len - head - mid_len);
+
+	return 0;
+}
+
+/*
+ * return SUNXI_DMA_XFER_BUSY while the engine is still running, otherwise
+ * complete the transfer and return its final status
+ */
+int sunxi_dma_xfer_poll(struct sunxi_dma_xfer *xfer)
+{
+	if (xfer->status != SUNXI_DMA_XFER_BUSY)
+		return xfer->status;
+
+	if (sunxi_dma_querystatus(xfer->hdma) == 1)
+		return SUNXI_DMA_XFER_BUSY;
+
+	dma_memcpy_finish(xfer, SUNXI_DMA_XFER_DONE);
+
+	return xfer->status;
+}
+
+int sunxi_dma_xfer_wait(struct sunxi_dma_xfer *xfer)
+{
+	/* dram to dram is well above 16MB/s, allow 1s on top of that */
+	ulong timeout = 1000 + (xfer->dma_len >> 14);
+
+	while (sunxi_dma_xfer_poll(xfer) == SUNXI_DMA_XFER_BUSY) {
+		if (get_timer(xfer->start) > timeout) {
+			printf("sunxi dma memcpy: wait timeout, len 0x%lx\n",
+			       xfer->dma_len);
+			dma_memcpy_finish(xfer, -1);
+			break;
+		}
+	}
+
+	return xfer->status;
+}
+
+void *sunxi_dma_memcpy(void *dst, const void *src, size_t len)
+{
+	struct sunxi_dma_xfer xfer;
+
+	sunxi_dma_memcpy_async(&xfer, dst, src, len, NULL, NULL);
+	if (sunxi_dma_xfer_wait(&xfer))
+		memcpy(dst, src, len);
+
+	return dst;
+}
+
+void *sunxi_dma_memset(void *dst, int c, size_t len)
+{
+	struct sunxi_dma_xfer xfer;
+
+	sunxi_dma_memset_async(&xfer, dst, c, len, NULL, NULL);
+	if (sunxi_dma_xfer_wait(&xfer))
+		memset(dst, c, len);
+
+	return dst;
+}
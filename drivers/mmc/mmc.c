@@ -527,6 +527,9 @@ ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 	if (!mmc)
 		return 0;
 
+	if (mmc_packed_flush(mmc))
+		return 0;
+
 	if (CONFIG_IS_ENABLED(MMC_TINY))
 		err = mmc_switch_part(mmc, block_dev->hwpart);
 	else
@@ -106,6 +106,9 @@ ulong mmc_berase(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt)
 	if (!mmc)
 		return -1;
 
+	if (mmc_packed_flush(mmc))
+		return -1;
+
 	err = blk_select_hwpart_devnum(IF_TYPE_MMC, dev_num,
 				       block_dev->hwpart);
 	if (err < 0)
@@ -150,6 +153,113 @@ ulong mmc_berase(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt)
 	return blk;
 }
 
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+/* CMD23 argument */
+#define MMC_SBC_RELIABLE	(1U << 31)
+#define MMC_SBC_PACKED		(1U << 30)
+#define MMC_SBC_MAX_BLOCKS	0xffff
+
+/*
+ * CMD23 is mandatory since eMMC 4.3. The transfer then ends at the block
+ * count, there is no CMD12 and the card knows the size before the first
+ * block arrives. Packed writes came with 4.5, only 512 byte sectors are
+ * handled here.
+ */
+static u32 mmc_wr_caps(struct mmc *mmc)
+{
+	const u8 *ext_csd = mmc->ext_csd;
+
+	if (mmc->wr_caps & MMC_WR_CAP_PROBED)
+		return mmc->wr_caps;
+
+	mmc->wr_caps = MMC_WR_CAP_PROBED;
+	if (IS_SD(mmc) || mmc_host_is_spi(mmc) || !ext_csd ||
+	    ext_csd[EXT_CSD_REV] < 3)
+		return mmc->wr_caps;
+
+	mmc->wr_caps |= MMC_WR_CAP_SBC;
+	if (ext_csd[EXT_CSD_WR_REL_PARAM] & EXT_CSD_EN_REL_WR)
+		mmc->wr_caps |= MMC_WR_CAP_REL;
+#ifdef CONFIG_MMC_SUNXI_PACKED_WRITE
+	if (ext_csd[EXT_CSD_REV] >= 6 && !ext_csd[EXT_CSD_DATA_SECTOR_SIZE] &&
+	    ext_csd[EXT_CSD_MAX_PACKED_WRITES] > 1)
+		mmc->wr_caps |= MMC_WR_CAP_PACKED;
+#endif
+	MMCDBG("write caps 0x%x, rel_wr_sec_c %d, max packed %d\n",
+	       mmc->wr_caps, ext_csd[EXT_CSD_REL_WR_SEC_C],
+	       ext_csd[EXT_CSD_MAX_PACKED_WRITES]);
+
+	return mmc->wr_caps;
+}
+
+/*
+ * returns 0, -EOPNOTSUPP when the card did not take CMD23 or -EIO when
+ * the data transfer failed
+ */
+static int mmc_sbc_write_blocks(struct mmc *mmc, lbaint_t start,
+				lbaint_t blkcnt, const void *src, u32 flags)
+{
+	struct mmc_cmd cmd;
+	struct mmc_data data;
+	int err;
+
+	cmd.cmdidx = MMC_CMD_SET_BLOCK_COUNT;
+	cmd.cmdarg = flags | (blkcnt & MMC_SBC_MAX_BLOCKS);
+	cmd.resp_type = MMC_RSP_R1;
+	if (mmc_send_cmd(mmc, &cmd, NULL)) {
+		MMCINFO("mmc set block count failed\n");
+		return -EOPNOTSUPP;
+	}
+
+	cmd.cmdidx = MMC_CMD_WRITE_MULTIPLE_BLOCK;
+	if (mmc->high_capacity)
+		cmd.cmdarg = start;
+	else
+		cmd.cmdarg = start * mmc->write_bl_len;
+	cmd.resp_type = MMC_RSP_R1;
+
+	data.src = src;
+	data.blocks = blkcnt;
+	data.blocksize = mmc->write_bl_len;
+	data.flags = MMC_DATA_WRITE;
+
+	mmc->sbc_flag = 1;
+	err = mmc_send_cmd(mmc, &cmd, &data);
+	mmc->sbc_flag = 0;
+	if (err) {
+		MMCMSG(mmc, "mmc cmd23 write failed\n");
+		/* the card may still wait for data */
+		mmc_send_manual_stop(mmc);
+		return -EIO;
+	}
+
+	if (mmc_send_status(mmc, 1000))
+		return -EIO;
+
+	return 0;
+}
+
+/* a failed cmd23 write is retried the old way, a refused cmd23 for good */
+static int mmc_sbc_try_write(struct mmc *mmc, lbaint_t start, lbaint_t blkcnt,
+			     const void *src, u32 flags)
+{
+	int err;
+
+	if (!(mmc_wr_caps(mmc) & MMC_WR_CAP_SBC) ||
+	    blkcnt > MMC_SBC_MAX_BLOCKS)
+		return -EOPNOTSUPP;
+
+	err = mmc_sbc_write_blocks(mmc, start, blkcnt, src, flags);
+	if (err == -EOPNOTSUPP) {
+		MMCINFO("cmd23 not taken, back to cmd25 + cmd12\n");
+		mmc->wr_caps &= ~(MMC_WR_CAP_SBC | MMC_WR_CAP_REL |
+				  MMC_WR_CAP_PACKED);
+	}
+
+	return err;
+}
+#endif
+
 static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 		lbaint_t blkcnt, const void *src)
 {
@@ -165,7 +275,13 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 
 	if (blkcnt == 0)
 		return 0;
-	else if (blkcnt == 1)
+
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+	if (blkcnt > 1 && !mmc_sbc_try_write(mmc, start, blkcnt, src, 0))
+		return blkcnt;
+#endif
+
+	if (blkcnt == 1)
 		cmd.cmdidx = MMC_CMD_WRITE_SINGLE_BLOCK;
 	else
 		cmd.cmdidx = MMC_CMD_WRITE_MULTIPLE_BLOCK;
@@ -239,6 +355,9 @@ ulong mmc_bwrite(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 	if (!mmc)
 		return 0;
 
+	if (mmc_packed_flush(mmc))
+		return 0;
+
 	err = blk_select_hwpart_devnum(IF_TYPE_MMC, dev_num, block_dev->hwpart);
 	if (err < 0)
 		return 0;
@@ -306,6 +425,330 @@ ulong mmc_bwrite(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 	return blkcnt;
 }
 
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+/*
+ * legacy reliable writes (EN_REL_WR clear) are only atomic for one block
+ * or for REL_WR_SEC_C aligned blocks, anything else is split that way
+ */
+ulong mmc_write_reliable(struct mmc *mmc, lbaint_t start, lbaint_t blkcnt,
+			 const void *src)
+{
+	struct blk_desc *desc = mmc_get_blk_desc(mmc);
+	lbaint_t cur, rel, done = 0;
+	void *src_align = NULL;
+	const void *buf;
+
+	if (!(mmc_wr_caps(mmc) & MMC_WR_CAP_SBC))
+		return blk_dwrite(desc, start, blkcnt, src);
+	if (mmc_packed_flush(mmc))
+		return 0;
+	if (blk_select_hwpart_devnum(IF_TYPE_MMC, desc->devnum, desc->hwpart))
+		return 0;
+	if (mmc_set_blocklen(mmc, mmc->write_bl_len))
+		return 0;
+
+	rel = mmc->ext_csd[EXT_CSD_REL_WR_SEC_C];
+	if (PT_TO_PHU(src) % CONFIG_SYS_CACHELINE_SIZE) {
+		src_align = memalign(CONFIG_SYS_CACHELINE_SIZE,
+				     blkcnt * mmc->write_bl_len);
+		if (!src_align)
+			return 0;
+		memcpy(src_align, src, blkcnt * mmc->write_bl_len);
+	}
+	buf = src_align ? src_align : src;
+
+	while (done < blkcnt) {
+		cur = min(blkcnt - done, (lbaint_t)mmc->cfg->b_max);
+		if (!(mmc->wr_caps & MMC_WR_CAP_REL)) {
+			if (rel > 1 && !((start + done) % rel) &&
+			    cur >= rel)
+				cur = rel;
+			else
+				cur = 1;
+		}
+		if (mmc_sbc_try_write(mmc, start + done, cur,
+				      buf + done * mmc->write_bl_len,
+				      MMC_SBC_RELIABLE)) {
+			MMCINFO("reliable write failed at 0x" LBAF "\n",
+				start + done);
+			break;
+		}
+		done += cur;
+	}
+
+	if (src_align)
+		free(src_align);
+
+	return done;
+}
+#endif
+
+#ifdef CONFIG_MMC_SUNXI_PACKED_WRITE
+/* packed command header, the first block of the transfer */
+#define MMC_PACKED_VERSION	0x01
+#define MMC_PACKED_WRITE	0x02
+#define MMC_PACKED_MAX_ENTRIES	63	/* two words each behind word 0,1 */
+
+struct mmc_packed_queue {
+	struct mmc *mmc;
+	int hwpart;
+	u32 *hdr;		/* header block, the data follows it */
+	int nr;
+	int max_nr;
+	lbaint_t blocks;	/* data blocks behind the header */
+	lbaint_t max_blocks;
+	lbaint_t start[MMC_PACKED_MAX_ENTRIES];
+	lbaint_t cnt[MMC_PACKED_MAX_ENTRIES];
+};
+
+static struct mmc_packed_queue packed_q;
+
+static int mmc_packed_setup(struct mmc *mmc)
+{
+	struct mmc_packed_queue *q = &packed_q;
+
+	if (!q->hdr) {
+		q->hdr = memalign(CONFIG_SYS_CACHELINE_SIZE,
+				  CONFIG_MMC_SUNXI_PACKED_BUF_SIZE + 512);
+		if (!q->hdr) {
+			MMCINFO("no memory for packed write\n");
+			return -1;
+		}
+	}
+	q->mmc = mmc;
+	q->hwpart = mmc_get_blk_desc(mmc)->hwpart;
+	q->max_nr = min(mmc->ext_csd[EXT_CSD_MAX_PACKED_WRITES],
+			(u8)MMC_PACKED_MAX_ENTRIES);
+	q->max_blocks = min(CONFIG_MMC_SUNXI_PACKED_BUF_SIZE / 512,
+			    MMC_SBC_MAX_BLOCKS - 1);
+	q->nr = 0;
+	q->blocks = 0;
+
+	return 0;
+}
+
+static int mmc_packed_send(struct mmc_packed_queue *q)
+{
+	struct mmc *mmc = q->mmc;
+	u8 *data = (u8 *)q->hdr + 512;
+	int i;
+
+	if (q->nr == 1)
+		return mmc_sbc_try_write(mmc, q->start[0], q->cnt[0], data, 0);
+
+	memset(q->hdr, 0, 512);
+	q->hdr[0] = cpu_to_le32(q->nr << 16 | MMC_PACKED_WRITE << 8 |
+				MMC_PACKED_VERSION);
+	for (i = 0; i < q->nr; i++) {
+		q->hdr[2 * i + 2] = cpu_to_le32(q->cnt[i]);
+		q->hdr[2 * i + 3] = cpu_to_le32(mmc->high_capacity ?
+						q->start[i] :
+						q->start[i] * 512);
+	}
+
+	return mmc_sbc_try_write(mmc, q->start[0], q->blocks + 1, q->hdr,
+				 MMC_SBC_PACKED);
+}
+
+int mmc_packed_flush(struct mmc *mmc)
+{
+	struct mmc_packed_queue *q = &packed_q;
+	struct blk_desc *desc;
+	u8 *data = (u8 *)q->hdr + 512;
+	int i, hwpart, ret = 0;
+
+	if (q->mmc != mmc || !q->nr)
+		return 0;
+
+	desc = mmc_get_blk_desc(mmc);
+	hwpart = desc->hwpart;
+	if (blk_select_hwpart_devnum(IF_TYPE_MMC, desc->devnum, q->hwpart) ||
+	    mmc_set_blocklen(mmc, mmc->write_bl_len)) {
+		ret = -1;
+		goto out;
+	}
+
+	if (mmc_packed_send(q)) {
+		/* every entry on its own, the old way if need be */
+		MMCINFO("packed write of %d entries failed\n", q->nr);
+		if (q->nr > 1)
+			mmc->wr_caps &= ~MMC_WR_CAP_PACKED;
+		for (i = 0; i < q->nr; i++) {
+			if (mmc_write_blocks(mmc, q->start[i], q->cnt[i],
+					     data) != q->cnt[i]) {
+				ret = -1;
+				break;
+			}
+			data += q->cnt[i] * 512;
+		}
+	}
+
+	if (q->hwpart != hwpart)
+		blk_select_hwpart_devnum(IF_TYPE_MMC, desc->devnum, hwpart);
+out:
+	q->nr = 0;
+	q->blocks = 0;
+
+	return ret;
+}
+
+ulong mmc_packed_write(struct mmc *mmc, lbaint_t start, lbaint_t blkcnt,
+		       const void *src)
+{
+	struct mmc_packed_queue *q = &packed_q;
+	struct blk_desc *desc = mmc_get_blk_desc(mmc);
+	int last;
+
+	if (!(mmc_wr_caps(mmc) & MMC_WR_CAP_PACKED) ||
+	    mmc->write_bl_len != 512)
+		return blk_dwrite(desc, start, blkcnt, src);
+	if (start + blkcnt > desc->lba)
+		return 0;
+
+	if (q->mmc != mmc || q->hwpart != desc->hwpart) {
+		if (q->mmc && mmc_packed_flush(q->mmc))
+			return 0;
+		if (mmc_packed_setup(mmc))
+			return blk_dwrite(desc, start, blkcnt, src);
+	}
+
+	/* big writes gain nothing from packing */
+	if (blkcnt > q->max_blocks / 4) {
+		if (mmc_packed_flush(mmc))
+			return 0;
+		return blk_dwrite(desc, start, blkcnt, src);
+	}
+
+	if (q->blocks + blkcnt > q->max_blocks && mmc_packed_flush(mmc))
+		return 0;
+
+	last = q->nr - 1;
+	if (q->nr && q->start[last] + q->cnt[last] == start) {
+		q->cnt[last] += blkcnt;
+	} else {
+		if (q->nr == q->max_nr && mmc_packed_flush(mmc))
+			return 0;
+		q->start[q->nr] = start;
+		q->cnt[q->nr] = blkcnt;
+		q->nr++;
+	}
+	memcpy((u8 *)q->hdr + 512 + q->blocks * 512, src, blkcnt * 512);
+	q->blocks += blkcnt;
+
+	return blkcnt;
+}
+#endif
+
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+static void mmc_bench_show(const char *name, u64 bytes, ulong us)
+{
+	ulong kbps = us ? (ulong)(bytes * 1000 / us) : 0;
+
+	printf("%-10s %lld bytes in %lu us, %lu.%03lu MB/s\n", name, bytes, us,
+	       kbps / 1000, kbps % 1000);
+}
+
+/*
+ * write the same data back in four ways: b_max chunks with CMD12, the
+ * same chunks with CMD23, and 4KB writes in a scattered order with CMD23
+ * and packed. the scattered order keeps packing from merging them.
+ */
+static int mmc_bench_pass(struct mmc *mmc, lbaint_t start, lbaint_t blkcnt,
+			  u8 *buf, u32 caps, int small, int packed)
+{
+	struct blk_desc *desc = mmc_get_blk_desc(mmc);
+	u32 saved = mmc->wr_caps;
+	lbaint_t blk, n = small ? 8 : blkcnt;
+	int pass, ret = 0;
+
+	mmc->wr_caps = (saved & caps) | MMC_WR_CAP_PROBED;
+	for (pass = 0; pass < (small ? 2 : 1) && !ret; pass++) {
+		for (blk = pass * n; blk < blkcnt && !ret;
+		     blk += small ? 2 * n : n) {
+			lbaint_t cur = min(n, blkcnt - blk);
+#ifdef CONFIG_MMC_SUNXI_PACKED_WRITE
+			if (packed) {
+				if (mmc_packed_write(mmc, start + blk, cur,
+						     buf + blk * 512) != cur)
+					ret = -1;
+				continue;
+			}
+#endif
+			if (blk_dwrite(desc, start + blk, cur,
+				       buf + blk * 512) != cur)
+				ret = -1;
+		}
+	}
+	if (mmc_packed_flush(mmc))
+		ret = -1;
+	/* a pass may have turned a feature off, keep that */
+	mmc->wr_caps = saved & (mmc->wr_caps | ~caps);
+
+	return ret;
+}
+
+int mmc_write_bench(struct mmc *mmc, lbaint_t start, lbaint_t blkcnt)
+{
+	static const struct {
+		const char *name;
+		u32 caps;
+		int small;
+		int packed;
+	} passes[] = {
+		{ "cmd12", 0, 0, 0 },
+		{ "cmd23", MMC_WR_CAP_SBC, 0, 0 },
+		{ "4k", MMC_WR_CAP_SBC, 1, 0 },
+		{ "4k packed", MMC_WR_CAP_SBC | MMC_WR_CAP_PACKED, 1, 1 },
+	};
+	struct blk_desc *desc = mmc_get_blk_desc(mmc);
+	u8 *buf, *check;
+	ulong t;
+	int i, ret = -1;
+
+	if (mmc->write_bl_len != 512 || !blkcnt)
+		return -1;
+	buf = memalign(CONFIG_SYS_CACHELINE_SIZE, blkcnt * 512);
+	check = memalign(CONFIG_SYS_CACHELINE_SIZE, blkcnt * 512);
+	if (!buf || !check) {
+		printf("no memory for 0x" LBAF " blocks\n", blkcnt);
+		goto out;
+	}
+	if (blk_dread(desc, start, blkcnt, buf) != blkcnt) {
+		printf("read failed\n");
+		goto out;
+	}
+
+	mmc_wr_caps(mmc);
+	printf("write caps 0x%x, b_max %d\n", mmc->wr_caps, mmc->cfg->b_max);
+	for (i = 0; i < ARRAY_SIZE(passes); i++) {
+		if (passes[i].caps & ~mmc->wr_caps) {
+			printf("%-10s not supported\n", passes[i].name);
+			continue;
+		}
+		t = timer_get_us();
+		if (mmc_bench_pass(mmc, start, blkcnt, buf, passes[i].caps,
+				   passes[i].small, passes[i].packed)) {
+			printf("%s write failed\n", passes[i].name);
+			goto out;
+		}
+		mmc_bench_show(passes[i].name, (u64)blkcnt * 512,
+			       timer_get_us() - t);
+	}
+
+	if (blk_dread(desc, start, blkcnt, check) != blkcnt ||
+	    memcmp(buf, check, blkcnt * 512)) {
+		printf("data mismatch after the bench\n");
+		goto out;
+	}
+	ret = 0;
+out:
+	free(check);
+	free(buf);
+
+	return ret;
+}
+#endif
+
 int mmc_set_erase_start_addr(struct mmc *mmc, unsigned int address)
 {
 	struct mmc_cmd cmd;
@@ -525,6 +968,10 @@ int mmc_do_erase(struct mmc *mmc, unsigned int from,
 
 	MMCDBG("+++%s\n", __FUNCTION__);
 
+	err = mmc_packed_flush(mmc);
+	if (err)
+		goto ERR_RET;
+
 	mmc_mmc_update_timeout(mmc);
 
 	err = mmc_set_erase_start_addr(mmc, from);
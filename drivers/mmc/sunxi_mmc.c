@@ -379,60 +379,122 @@ static int mmc_trans_data_by_cpu(struct sunxi_mmc_priv *priv, struct mmc *mmc,
 	return 0;
 }
 
-static int mmc_trans_data_by_dma(struct sunxi_mmc_priv *priv, struct mmc *mmc, struct mmc_data *data)
+static void mmc_des_link(struct sunxi_mmc_priv *priv, u32 idx)
+{
+	struct mmc_des_v4p1 *des = &priv->pdes[idx];
+
+	des->dic = 1;
+	des->last_des = 0;
+	des->end_of_ring = 0;
+	des->buf_addr_ptr2 = (ulong)(des + 1) >> priv->des_shift;
+}
+
+static void mmc_des_end(struct sunxi_mmc_priv *priv, u32 idx)
+{
+	struct mmc_des_v4p1 *des = &priv->pdes[idx];
+
+	des->dic = 0;
+	des->last_des = 1;
+	des->end_of_ring = 1;
+	des->buf_addr_ptr2 = 0;
+}
+
+/*
+ * Link every descriptor of the table to the next one up front, so a
+ * request only fills in buffer addresses and moves the end of the chain.
+ */
+static void mmc_init_des_ring(struct sunxi_mmc_priv *priv)
 {
 	struct mmc_des_v4p1 *pdes = priv->pdes;
-	unsigned byte_cnt = data->blocksize * data->blocks;
-	unsigned char *buff;
-	unsigned des_idx = 0;
-	unsigned buff_frag_num = 0;
-	unsigned remain;
-	unsigned i, rval;
-
-	buff = data->flags & MMC_DATA_READ ?
-			(unsigned char *)data->dest : (unsigned char *)data->src;
-	buff_frag_num = byte_cnt >> SDXC_DES_NUM_SHIFT;
-	remain = byte_cnt & (SDXC_DES_BUFFER_MAX_LEN - 1);
-	if (remain)
-		buff_frag_num++;
+	u32 i;
+
+	if (priv->version == 0x40200 || priv->version == 0x40502 || priv->version >= 0x50300 || priv->version == 0x40104)
+		priv->des_shift = 2;
 	else
-		remain = SDXC_DES_BUFFER_MAX_LEN;
-	flush_cache((unsigned long)buff, ALIGN((unsigned long)byte_cnt, CONFIG_SYS_CACHELINE_SIZE));
-	for (i = 0; i < buff_frag_num; i++, des_idx++) {
-		memset((void *)&pdes[des_idx], 0, sizeof(struct mmc_des_v4p1));
-		pdes[des_idx].des_chain = 1;
-		pdes[des_idx].own = 1;
-		pdes[des_idx].dic = 1;
-		if (buff_frag_num > 1 && i != buff_frag_num - 1)
-			pdes[des_idx].data_buf1_sz = SDXC_DES_BUFFER_MAX_LEN;
-		else
-			pdes[des_idx].data_buf1_sz = remain;
-		if (priv->version == 0x40200 || priv->version == 0x40502 || priv->version >= 0x50300 || priv->version == 0x40104)
-			pdes[des_idx].buf_addr_ptr1 = ((ulong)buff + i * SDXC_DES_BUFFER_MAX_LEN)
-							>> 2;
-		else
-			pdes[des_idx].buf_addr_ptr1 = ((ulong)buff + i * SDXC_DES_BUFFER_MAX_LEN);
-		if (i == 0)
-			pdes[des_idx].first_des = 1;
-
-		if (i == buff_frag_num - 1) {
-			pdes[des_idx].dic = 0;
-			pdes[des_idx].last_des = 1;
-			pdes[des_idx].end_of_ring = 1;
-			pdes[des_idx].buf_addr_ptr2 = 0;
-		} else {
-			if (priv->version == 0x40200 || priv->version == 0x40502 || priv->version >= 0x50300 || priv->version == 0x40104)
-				pdes[des_idx].buf_addr_ptr2 = ((ulong)&pdes[des_idx + 1]) >> 2;
-			else
-				pdes[des_idx].buf_addr_ptr2 = ((ulong)&pdes[des_idx + 1]);
-		}
-		MMCDBG("frag %d, remain %d, des[%d](%08x): "
-			"[0] = %08x, [1] = %08x, [2] = %08x, [3] = %08x\n",
-			i, remain, des_idx, PT_TO_PHU(&pdes[des_idx]),
-			(u32)((u32 *)&pdes[des_idx])[0], (u32)((u32 *)&pdes[des_idx])[1],
-			(u32)((u32 *)&pdes[des_idx])[2], (u32)((u32 *)&pdes[des_idx])[3]);
+		priv->des_shift = 0;
+	priv->des_num = SDXC_DES_RING_SIZE / sizeof(struct mmc_des_v4p1);
+	priv->pio_cutoff = CONFIG_MMC_SUNXI_PIO_CUTOFF;
+
+	memset(pdes, 0, SDXC_DES_RING_SIZE);
+	for (i = 0; i < priv->des_num; i++) {
+		pdes[i].des_chain = 1;
+		mmc_des_link(priv, i);
 	}
-	flush_cache((unsigned long)pdes, ALIGN(sizeof(struct mmc_des_v4p1) * (des_idx + 1), CONFIG_SYS_CACHELINE_SIZE));
+	pdes[0].first_des = 1;
+	priv->des_last = 0;
+	mmc_des_end(priv, 0);
+	flush_cache((unsigned long)pdes, SDXC_DES_RING_SIZE);
+}
+
+/* clean or invalidate only the lines the transfer covers */
+static void mmc_dma_cache_range(struct mmc_data *data, int before)
+{
+	ulong buff = data->flags & MMC_DATA_READ ?
+			(ulong)data->dest : (ulong)data->src;
+	ulong end = buff + data->blocksize * data->blocks;
+	ulong start = buff & ~(ulong)(CONFIG_SYS_CACHELINE_SIZE - 1);
+
+	end = ALIGN(end, CONFIG_SYS_CACHELINE_SIZE);
+	if (!before)
+		invalidate_dcache_range(start, end);
+	else if ((data->flags & MMC_DATA_READ) && start == buff &&
+		 !((buff + data->blocksize * data->blocks) &
+		   (CONFIG_SYS_CACHELINE_SIZE - 1)))
+		invalidate_dcache_range(start, end);
+	else
+		flush_dcache_range(start, end);
+}
+
+static int mmc_prepare_des(struct sunxi_mmc_priv *priv, struct mmc_data *data)
+{
+	struct mmc_des_v4p1 *pdes = priv->pdes;
+	unsigned byte_cnt = data->blocksize * data->blocks;
+	ulong buff = data->flags & MMC_DATA_READ ?
+			(ulong)data->dest : (ulong)data->src;
+	u32 n = DIV_ROUND_UP(byte_cnt, SDXC_DES_BUFFER_MAX_LEN);
+	u32 i, last = n - 1, old = priv->des_last;
+
+	if (!n || n > priv->des_num) {
+		MMCINFO("%s: %d bytes do not fit the descriptor table\n",
+			__func__, byte_cnt);
+		return -1;
+	}
+
+	mmc_dma_cache_range(data, 1);
+	for (i = 0; i < n; i++) {
+		pdes[i].own = 1;
+		pdes[i].data_buf1_sz = SDXC_DES_BUFFER_MAX_LEN;
+		pdes[i].buf_addr_ptr1 = (buff + i * SDXC_DES_BUFFER_MAX_LEN)
+					>> priv->des_shift;
+	}
+	pdes[last].data_buf1_sz = byte_cnt - last * SDXC_DES_BUFFER_MAX_LEN;
+	if (old != last) {
+		mmc_des_link(priv, old);
+		mmc_des_end(priv, last);
+		priv->des_last = last;
+		/* the old end is outside of this chain, write it back alone */
+		if (old > last)
+			flush_cache((unsigned long)&pdes[old],
+				    ALIGN(sizeof(struct mmc_des_v4p1),
+					  CONFIG_SYS_CACHELINE_SIZE));
+	}
+	MMCDBG("%d bytes in %d des, last des(%08x): "
+		"[0] = %08x, [1] = %08x, [2] = %08x, [3] = %08x\n",
+		byte_cnt, n, PT_TO_PHU(&pdes[last]),
+		(u32)((u32 *)&pdes[last])[0], (u32)((u32 *)&pdes[last])[1],
+		(u32)((u32 *)&pdes[last])[2], (u32)((u32 *)&pdes[last])[3]);
+	flush_cache((unsigned long)pdes, ALIGN(sizeof(struct mmc_des_v4p1) * n, CONFIG_SYS_CACHELINE_SIZE));
+
+	return 0;
+}
+
+static int mmc_trans_data_by_dma(struct sunxi_mmc_priv *priv, struct mmc *mmc, struct mmc_data *data)
+{
+	struct mmc_des_v4p1 *pdes = priv->pdes;
+	unsigned rval;
+
+	if (mmc_prepare_des(priv, data))
+		return -1;
 
 	WR_MB();
 
@@ -464,14 +526,25 @@ static int mmc_trans_data_by_dma(struct sunxi_mmc_priv *priv, struct mmc *mmc, s
 		rval |= (1 << 1);
 	writel(rval, &priv->reg->idie);
 
-	if (priv->version == 0x40200 || priv->version == 0x40502 || priv->version >= 0x50300 || priv->version == 0x40104)
-		writel(((unsigned long)pdes) >> 2, &priv->reg->dlba);
-	else
-		writel(((unsigned long)pdes), &priv->reg->dlba);
+	writel(((unsigned long)pdes) >> priv->des_shift, &priv->reg->dlba);
 	writel(priv->dma_tl, &priv->reg->ftrglevel);
 	return 0;
 }
 
+/*
+ * cpu work to run, one short slice per call, while a dma data transfer is
+ * in flight. lets a caller overlap a long read with processing of the
+ * previous buffer, part_update sums it meanwhile.
+ */
+static void (*mmc_dma_wait_hook)(void *data);
+static void *mmc_dma_wait_data;
+
+void sunxi_mmc_set_dma_wait_hook(void (*hook)(void *data), void *data)
+{
+	mmc_dma_wait_hook = hook;
+	mmc_dma_wait_data = data;
+}
+
 static int mmc_rint_wait(struct sunxi_mmc_priv *priv, struct mmc *mmc,
 			 uint timeout_msecs, uint done_bit, const char *what, uint usedma)
 {
@@ -485,10 +558,13 @@ static int mmc_rint_wait(struct sunxi_mmc_priv *priv, struct mmc *mmc,
 					status & SUNXI_MMC_RINT_INTERRUPT_ERROR_BIT, status);
 			return -ETIMEDOUT;
 		}
-		if (usedma && !strncmp(what, "data", sizeof("data")))
+		if (usedma && !strncmp(what, "data", sizeof("data"))) {
 			done = ((status & done_bit) && (readl(&priv->reg->idst) & 0x3)) ? 1 : 0;
-		else
+			if (!done && mmc_dma_wait_hook)
+				mmc_dma_wait_hook(mmc_dma_wait_data);
+		} else {
 			done = (status & done_bit);
+		}
 	} while (!done);
 
 	return 0;
@@ -811,7 +887,8 @@ static int sunxi_mmc_do_send_cmd_common(struct sunxi_mmc_priv *priv,
 		cmdval |= SUNXI_MMC_CMD_DATA_EXPIRE|SUNXI_MMC_CMD_WAIT_PRE_OVER;
 		if (data->flags & MMC_DATA_WRITE)
 			cmdval |= SUNXI_MMC_CMD_WRITE;
-		if (data->blocks > 1)
+		/* after CMD23 the card stops by itself at the block count */
+		if (data->blocks > 1 && !mmc->sbc_flag)
 			cmdval |= SUNXI_MMC_CMD_AUTO_STOP;
 		writel(data->blocksize, &priv->reg->blksz);
 		writel(data->blocks * data->blocksize, &priv->reg->bytecnt);
@@ -844,7 +921,7 @@ static int sunxi_mmc_do_send_cmd_common(struct sunxi_mmc_priv *priv,
 		bytecnt = data->blocksize * data->blocks;
 		MMCDBG("trans data %d bytes\n", bytecnt);
 #ifdef CONFIG_MMC_SUNXI_USE_DMA
-		if (bytecnt > 64) {
+		if (bytecnt > priv->pio_cutoff) {
 #else
 		if (0) {
 #endif
@@ -875,7 +952,7 @@ static int sunxi_mmc_do_send_cmd_common(struct sunxi_mmc_priv *priv,
 		timeout_msecs = 6000;
 		MMCDBG("cacl timeout %x msec\n", timeout_msecs);
 		error = mmc_rint_wait(priv, mmc, timeout_msecs,
-				      data->blocks > 1 ?
+				      (data->blocks > 1 && !mmc->sbc_flag) ?
 				      SUNXI_MMC_RINT_AUTO_COMMAND_DONE :
 				      SUNXI_MMC_RINT_DATA_OVER,
 				      "data", usedma);
@@ -992,11 +1069,7 @@ out:
 	writel(readl(&priv->reg->gctrl) | SUNXI_MMC_GCTRL_FIFO_RESET,
 	       &priv->reg->gctrl);
 	if (data && (data->flags&MMC_DATA_READ) && usedma) {
-		unsigned char *buff = (unsigned char *)data->dest;
-		unsigned byte_cnt = data->blocksize * data->blocks;
-		invalidate_dcache_range((unsigned long)buff,
-					((unsigned long)buff + ALIGN((unsigned long)byte_cnt,
-					CONFIG_SYS_CACHELINE_SIZE)));
+		mmc_dma_cache_range(data, 0);
 
 		MMCDBG("invald cache after read complete\n");
 	}
@@ -1078,6 +1151,14 @@ host_retry:
 				mmc->cfg->ops->decide_retry(mmc, 0, 1);
 				return err;
 #endif
+			} else if (mmc->sbc_flag) {
+				/*
+				 * resent alone the data command would miss
+				 * its CMD23, mmc_sbc_write_blocks() stops the
+				 * card and redoes the write with CMD12
+				 */
+				MMCINFO("no host retry for a cmd23 write\n");
+				return err;
 			} else {
 				MMCINFO("host retry\n");
 				mmc_raw_send_manual_stop(mmc);
@@ -1291,6 +1372,73 @@ int sunxi_mmcno_to_devnum(int sdc_no)
 	return m->block_dev.devnum;
 }
 
+#ifdef CONFIG_MMC_SUNXI_USE_DMA
+#define MMC_DMA_BENCH_LOOPS	32
+#define MMC_DMA_BENCH_MAX	(64 * 1024)
+
+/*
+ * descriptor setup time, then whole reads by dma and by fifo for each
+ * size from 512 bytes to 64KB. the largest size the fifo still wins
+ * becomes the pio cutoff of the host.
+ */
+int sunxi_mmc_dma_bench(struct mmc *mmc, lbaint_t start)
+{
+	struct sunxi_mmc_priv *priv = mmc->priv;
+	struct blk_desc *desc = mmc_get_blk_desc(mmc);
+	struct mmc_data data;
+	u32 saved = priv->pio_cutoff, cutoff = saved, pio_wins = 1;
+	ulong t, setup_us, us[2];
+	unsigned size;
+	int i, mode, ret = -1;
+	void *buf;
+
+	buf = memalign(CONFIG_SYS_CACHELINE_SIZE, MMC_DMA_BENCH_MAX);
+	if (!buf)
+		return -1;
+
+	printf("%6s %10s %10s %10s\n", "bytes", "setup us", "dma us", "pio us");
+	for (size = 512; size <= MMC_DMA_BENCH_MAX; size <<= 1) {
+		data.dest = buf;
+		data.blocks = size / 512;
+		data.blocksize = 512;
+		data.flags = MMC_DATA_READ;
+		t = timer_get_us();
+		for (i = 0; i < MMC_DMA_BENCH_LOOPS; i++)
+			mmc_prepare_des(priv, &data);
+		setup_us = timer_get_us() - t;
+
+		for (mode = 0; mode < 2; mode++) {
+			priv->pio_cutoff = mode ? ~0U : 0;
+			t = timer_get_us();
+			for (i = 0; i < MMC_DMA_BENCH_LOOPS; i++) {
+				if (blk_dread(desc, start, size / 512, buf) !=
+				    size / 512) {
+					printf("read failed at %d bytes\n", size);
+					goto out;
+				}
+			}
+			us[mode] = timer_get_us() - t;
+		}
+		printf("%6u %10lu %10lu %10lu\n", size,
+		       setup_us / MMC_DMA_BENCH_LOOPS,
+		       us[0] / MMC_DMA_BENCH_LOOPS, us[1] / MMC_DMA_BENCH_LOOPS);
+
+		if (pio_wins && us[1] < us[0])
+			cutoff = size;
+		else
+			pio_wins = 0;
+	}
+	saved = cutoff;
+	printf("mmc %d pio cutoff %u bytes\n", priv->mmc_no, cutoff);
+	ret = 0;
+out:
+	priv->pio_cutoff = saved;
+	free(buf);
+
+	return ret;
+}
+#endif
+
 struct mmc *sunxi_mmc_init(int sdc_no)
 {
 	__attribute__((unused)) struct sunxi_ccm_reg *ccm = (struct sunxi_ccm_reg *)SUNXI_CCM_BASE;
@@ -1328,7 +1476,7 @@ struct mmc *sunxi_mmc_init(int sdc_no)
 	/* default timing mode */
 	priv->timing_mode = SUNXI_MMC_TIMING_MODE_1;
 
-	priv->pdes = memalign(CONFIG_SYS_CACHELINE_SIZE, 256 * 1024);
+	priv->pdes = memalign(CONFIG_SYS_CACHELINE_SIZE, SDXC_DES_RING_SIZE);
 
 	if (priv->pdes == NULL) {
 		MMCINFO("get mem for descripter failed !\n");
@@ -1353,6 +1501,7 @@ struct mmc *sunxi_mmc_init(int sdc_no)
 	version = readl(&priv->reg->vers);
 	MMCINFO("SUNXI SDMMC Controller Version:0x%x\n", version);
 	priv->version = version;
+	mmc_init_des_ring(priv);
 
 	if (cfg->io_is_1v8) {
 		MMCDBG("io is 1.8V\n");
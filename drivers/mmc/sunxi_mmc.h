@@ -262,6 +262,7 @@ struct mmc_des_v4p1 {
 
 #define SDXC_DES_NUM_SHIFT 12  /* smhc2!! */
 #define SDXC_DES_BUFFER_MAX_LEN	(1 << SDXC_DES_NUM_SHIFT)
+#define SDXC_DES_RING_SIZE	(256 * 1024)
 	u32	data_buf1_sz:16,
 		data_buf2_sz:16;
 
@@ -322,6 +323,11 @@ struct sunxi_mmc_priv {
 	u32 sample_mode;
 
 	u32 dma_tl;
+	/* the IDMAC descriptor chain is linked once, see mmc_init_des_ring() */
+	u32 des_num;
+	u32 des_shift;		/* descriptor addresses are in words on newer hosts */
+	u32 des_last;		/* descriptor that ended the previous chain */
+	u32 pio_cutoff;		/* transfers up to this size go through the fifo */
 	int (*mmc_init_default_timing_para)(int sdc_no);
 	int (*mmc_set_mod_clk)(struct sunxi_mmc_priv *priv, unsigned int hz);
 	void (*sunxi_mmc_set_speed_mode)(struct sunxi_mmc_priv *priv,
@@ -230,6 +230,7 @@ static bool aw_rawnand_dev_ready_wait(struct mtd_info *mtd)
 	struct aw_nand_chip *chip = awnand_mtd_to_chip(mtd);
 	struct aw_nand_host *host = awnand_chip_to_host(chip);
 	uint32_t time_start = 0;
+	ulong spin_start = timer_get_us();
 	awrawnand_chip_trace("Enter %s\n", __func__);
 
 	time_start = get_timer(0);
@@ -248,6 +249,7 @@ static bool aw_rawnand_dev_ready_wait(struct mtd_info *mtd)
 
 	awrawnand_chip_trace("Exit %s\n", __func__);
 out:
+	aw_nand_wait_stat_spin(host, spin_start);
 	return ret;
 }
 
@@ -276,6 +278,73 @@ out:
 	return status;
 }
 
+static void aw_rawnand_op_submitted(struct aw_nand_op *op, int page)
+{
+	op->page = page;
+	op->submit_us = timer_get_us();
+	op->pending = true;
+}
+
+/**
+ * aw_rawnand_op_done - check if a submitted program/erase has ended
+ * @mtd: mtd info
+ * @op: handle filled in by the submit
+ *
+ * Does not block. With the NFC interrupt in use this only reads the flag
+ * the B2R handler sets, else it samples the RB line once.
+ */
+bool aw_rawnand_op_done(struct mtd_info *mtd, struct aw_nand_op *op)
+{
+	struct aw_nand_chip *chip = awnand_mtd_to_chip(mtd);
+	struct aw_nand_host *host = awnand_chip_to_host(chip);
+
+	if (!op->pending)
+		return true;
+
+	if (host->use_rb_int)
+		return host->rb_ready_flag;
+
+	return host->rb_ready(chip, host);
+}
+
+/**
+ * aw_rawnand_op_wait - finish a program/erase started by a submit
+ * @mtd: mtd info
+ * @op: handle filled in by the submit
+ *
+ * The time from the submit up to here was left to the caller and is
+ * counted as overlap, the rest is the usual wait for RB and the status
+ * check. Waiting on a handle that is not pending returns 0.
+ */
+int aw_rawnand_op_wait(struct mtd_info *mtd, struct aw_nand_op *op)
+{
+	struct aw_nand_chip *chip = awnand_mtd_to_chip(mtd);
+	struct aw_nand_host *host = awnand_chip_to_host(chip);
+	uint8_t status = 0;
+	int ret = 0;
+
+	if (!op->pending)
+		return 0;
+
+	op->pending = false;
+	host->wait_stat.overlap_us += timer_get_us() - op->submit_us;
+	host->wait_stat.pe_ops++;
+
+	if (!(host->use_rb_int && host->rb_ready_flag) &&
+			!chip->dev_ready_wait(mtd)) {
+		awrawnand_err("dev is busy after program/erase page@%d\n", op->page);
+		return -ETIMEDOUT;
+	}
+
+	status = chip->dev_status(mtd);
+	if (status & RAWNAND_STATUS_FAIL) {
+		awrawnand_err("program/erase page@%d fail\n", op->page);
+		ret = -EIO;
+	}
+
+	return ret;
+}
+
 static int aw_rawnand_read_id(struct mtd_info *mtd, struct aw_nand_chip *chip, uint8_t *id)
 {
 	struct aw_nand_host *host = awnand_chip_to_host(chip);
@@ -294,14 +363,24 @@ static int aw_rawnand_read_id(struct mtd_info *mtd, struct aw_nand_chip *chip, u
 
 }
 
-int aw_rawnand_chip_erase(struct mtd_info *mtd, int page)
+/**
+ * aw_rawnand_chip_erase_submit - start a block erase
+ * @mtd: mtd info
+ * @page: first page of the block
+ * @op: handle to pass to aw_rawnand_op_wait()
+ *
+ * Returns as soon as the erase confirm command is sent, the chip is busy
+ * for tBERS after that.
+ */
+int aw_rawnand_chip_erase_submit(struct mtd_info *mtd, int page,
+		struct aw_nand_op *op)
 {
 	struct aw_nand_chip *chip = awnand_mtd_to_chip(mtd);
 	struct aw_nand_host *host = awnand_chip_to_host(chip);
 	awrawnand_chip_trace("Enter %s block@%d\n", __func__, page >> chip->pages_per_blk_shift);
+	aw_rawnand_prefetch_drop(chip);
 
 	int ret = 0;
-	uint8_t status = 0;
 
 	uint8_t row1 = page & 0xff;
 	uint8_t row2 = (page >> 8) & 0xff;
@@ -312,21 +391,27 @@ int aw_rawnand_chip_erase(struct mtd_info *mtd, int page)
 	if (ret)
 		awrawnand_err("%s cmd@%d page@%d fail\n", __func__, RAWNAND_CMD_ERASE1, page);
 
+	if (host->use_rb_int)
+		host->rb_event_arm(host);
 	NORMAL_REQ_CMD(req2, RAWNAND_CMD_ERASE2);
 	ret = host->normal_op(chip, &req2);
 	if (ret)
 		awrawnand_err("%s cmd@%d page@%d fail\n", __func__, RAWNAND_CMD_ERASE2, page);
 
-	if (!chip->dev_ready_wait(mtd))
-		awrawnand_err("device is busy after erase cmd@%x page@%d\n", RAWNAND_CMD_ERASE2, page);
+	aw_rawnand_op_submitted(op, page);
+	awrawnand_chip_trace("Exit %s ret@%d\n", __func__, ret);
 
-	status = chip->dev_status(mtd);
+	return ret;
+}
 
-	if (status & RAWNAND_STATUS_FAIL) {
+int aw_rawnand_chip_erase(struct mtd_info *mtd, int page)
+{
+	struct aw_nand_op op;
+	int ret = 0;
+
+	ret = aw_rawnand_chip_erase_submit(mtd, page, &op);
+	if (aw_rawnand_op_wait(mtd, &op))
 		ret = -EIO;
-		awrawnand_err("%s erase block@%d fail\n", __func__, page >> chip->pages_per_blk_shift);
-	}
-	awrawnand_chip_trace("Exit %s ret@%d\n", __func__, ret);
 
 	return ret;
 }
@@ -349,6 +434,7 @@ int aw_rawnand_chip_real_multi_erase(struct mtd_info *mtd, int page)
 
 	awrawnand_chip_trace("Enter %s block@[%d:%d]\n", __func__,
 			blkA, blkA + 1);
+	aw_rawnand_prefetch_drop(chip);
 	NORMAL_REQ_CMD_WITH_ADDR_N3(reqA, RAWNAND_CMD_ERASE1, row1, row2, row3);
 	ret = host->normal_op(chip, &reqA);
 	if (ret)
@@ -400,6 +486,7 @@ int aw_rawnand_chip_real_onfi_multi_erase(struct mtd_info *mtd, int page)
 
 	awrawnand_chip_trace("Enter %s block@[%d:%d]\n", __func__,
 			blkA, blkA + 1);
+	aw_rawnand_prefetch_drop(chip);
 
 	NORMAL_REQ_CMD_WITH_ADDR_N3(reqA, RAWNAND_CMD_ERASE1, row1, row2, row3);
 	ret = host->normal_op(chip, &reqA);
@@ -478,15 +565,25 @@ int aw_rawnand_chip_multi_erase(struct mtd_info *mtd, int page)
 	return ret;
 }
 
-int aw_rawnand_chip_write_page(struct mtd_info *mtd, struct aw_nand_chip *chip,
-		uint8_t *mdata, int mlen, uint8_t *sdata, int slen, int page)
+/**
+ * aw_rawnand_chip_write_page_submit - start a page program
+ * @op: handle to pass to aw_rawnand_op_wait()
+ *
+ * Returns once the data is in the chip and the program command is sent,
+ * the buffers may be reused while the chip is busy for tPROG. @op is only
+ * pending if 0 is returned.
+ */
+int aw_rawnand_chip_write_page_submit(struct mtd_info *mtd,
+		struct aw_nand_chip *chip, uint8_t *mdata, int mlen,
+		uint8_t *sdata, int slen, int page, struct aw_nand_op *op)
 {
 	struct aw_nand_host *host = awnand_chip_to_host(chip);
 	int ret = 0;
-	uint8_t status = 0;
 	int row_cycles = chip->row_cycles;
 
 	awrawnand_chip_trace("Enter %s page@%d\n", __func__, page);
+	aw_rawnand_prefetch_drop(chip);
+	op->pending = false;
 
 	BATCH_REQ_WRITE(req, page, row_cycles, mdata, mlen, sdata, slen);
 
@@ -497,28 +594,32 @@ int aw_rawnand_chip_write_page(struct mtd_info *mtd, struct aw_nand_chip *chip,
 	}
 
 	ret = host->batch_op(chip, &req);
-	if (ret == ECC_ERR) {
-		awrawnand_err("%s write page@%d fail\n", __func__, 0);
+	if (ret) {
+		awrawnand_err("%s write page@%d fail\n", __func__, page);
 		goto out;
 	}
 
-	if (!chip->dev_ready_wait(mtd)) {
-		awrawnand_err("dev is busy write page@%d fail\n", page);
-		ret = -ETIMEDOUT;
-		goto out;
-	}
-
-	status = chip->dev_status(mtd);
-	if (status & RAWNAND_STATUS_FAIL) {
-		awrawnand_err("write page@%d fail\n", page);
-		ret = -EIO;
-	}
+	aw_rawnand_op_submitted(op, page);
 
 out:
 	awrawnand_chip_trace("Exit %s ret@%d\n", __func__, ret);
 	return ret;
 }
 
+int aw_rawnand_chip_write_page(struct mtd_info *mtd, struct aw_nand_chip *chip,
+		uint8_t *mdata, int mlen, uint8_t *sdata, int slen, int page)
+{
+	struct aw_nand_op op;
+	int ret = 0;
+
+	ret = aw_rawnand_chip_write_page_submit(mtd, chip, mdata, mlen, sdata,
+			slen, page, &op);
+	if (!ret)
+		ret = aw_rawnand_op_wait(mtd, &op);
+
+	return ret;
+}
+
 int aw_rawnand_chip_cache_write_page(struct mtd_info *mtd, struct aw_nand_chip *chip,
 		uint8_t *mdata, int mlen, uint8_t *sdata, int slen, int page)
 {
@@ -528,6 +629,7 @@ int aw_rawnand_chip_cache_write_page(struct mtd_info *mtd, struct aw_nand_chip *
 	int row_cycles = chip->row_cycles;
 
 	awrawnand_chip_trace("Enter %s page@%d\n", __func__, page);
+	aw_rawnand_prefetch_drop(chip);
 
 	BATCH_REQ_CACHE_WRITE(req, page, row_cycles, mdata, mlen, sdata, slen);
 
@@ -578,6 +680,7 @@ int aw_rawnand_chip_real_multi_write_page(struct mtd_info *mtd, struct aw_nand_c
 	int pageB = (pageA + (1 << chip->pages_per_blk_shift));
 
 	awrawnand_chip_trace("Enter %s page@[%d:%d]\n", __func__, pageA, pageB);
+	aw_rawnand_prefetch_drop(chip);
 
 	BATCH_REQ_MULTI_WRITE(reqA, pageA, row_cycles, mdata, chip->pagesize, sdata, slen, PLANE_A);
 
@@ -655,6 +758,7 @@ int aw_rawnand_chip_real_jedec_multi_write_page(struct mtd_info *mtd, struct aw_
 	int pageB = (pageA + (1 << chip->pages_per_blk_shift));
 
 	awrawnand_chip_trace("Enter %s page@[%d:%d]\n", __func__, pageA, pageB);
+	aw_rawnand_prefetch_drop(chip);
 
 	BATCH_REQ_MULTI_WRITE(reqA, pageA, row_cycles, mdata, chip->pagesize, sdata, slen, PLANE_A);
 
@@ -746,6 +850,297 @@ int aw_rawnand_chip_multi_write_page(struct mtd_info *mtd, struct aw_nand_chip *
 	return ret;
 }
 
+#if SIMULATE_MULTIPLANE
+/*
+ * real multi plane programs end with one confirm for both planes and are
+ * waited for here, the simulated one leaves the program of pageB running
+ */
+static int aw_rawnand_chip_multi_write_page_submit(struct mtd_info *mtd,
+		struct aw_nand_chip *chip, uint8_t *mdata, int mlen,
+		uint8_t *sdata, int slen, int page, struct aw_nand_op *op)
+{
+	int ret = 0;
+
+	int blkA = ((page >> chip->pages_per_blk_shift) << 1);
+	int pageA = ((blkA << chip->pages_per_blk_shift) + (page & chip->pages_per_blk_mask));
+	int pageB = (pageA + (1 << chip->pages_per_blk_shift));
+
+	op->pending = false;
+	if (RAWNAND_HAS_MULTI_WRITE(chip) || RAWNAND_HAS_JEDEC_MULTI_WRITE(chip))
+		return aw_rawnand_chip_multi_write_page(mtd, chip, mdata, mlen, sdata, slen, page);
+
+	ret = aw_rawnand_chip_write_page(mtd, chip, mdata, (mlen >> 1), sdata, slen, pageA);
+	if (!ret) {
+		ret = aw_rawnand_chip_write_page_submit(mtd, chip, (mdata + chip->pagesize),
+				chip->pagesize, sdata, slen, pageB, op);
+	}
+
+	return ret;
+}
+#endif
+
+/*
+ * program one simu page for aw_rawnand_mtd_write_oob(), the last program
+ * is left running so the next page can be staged in the meantime
+ */
+static int aw_rawnand_mtd_write_page_submit(struct mtd_info *mtd,
+		struct aw_nand_chip *chip, uint8_t *mdata, int mlen,
+		uint8_t *sdata, int slen, int page, struct aw_nand_op *op)
+{
+	op->pending = false;
+#if SIMULATE_MULTIPLANE
+	if (chip->multi_write_page == aw_rawnand_chip_multi_write_page)
+		return aw_rawnand_chip_multi_write_page_submit(mtd, chip, mdata,
+				mlen, sdata, slen, page, op);
+	return chip->multi_write_page(mtd, chip, mdata, mlen, sdata, slen, page);
+#else
+	if (chip->write_page == aw_rawnand_chip_write_page)
+		return aw_rawnand_chip_write_page_submit(mtd, chip, mdata,
+				mlen, sdata, slen, page, op);
+	return chip->write_page(mtd, chip, mdata, mlen, sdata, slen, page);
+#endif
+}
+
+#ifdef CONFIG_AW_RAWNAND_READ_PREFETCH
+void aw_rawnand_prefetch_drop(struct aw_nand_chip *chip)
+{
+	chip->prefetch.nr = 0;
+}
+
+/**
+ * aw_rawnand_chip_cache_read - read sequential pages in one block by cache read
+ * @mtd: MTD structure
+ * @chip: aw nand chip strucutre
+ * @mdata: buffer of the first page, the next ones follow every @stride bytes
+ * @page: first pageno
+ * @cnt: pages to read, at least 2 and not crossing the block
+ * @ecc: ecc result of every page
+ * @bitflips: bitflips of every page
+ *
+ * 00h-30h loads the first page, then every 31h moves it to the cache
+ * register and starts the array read of the next one while it is
+ * transferred. 3Fh ends the sequence with the last page.
+ * **/
+static int aw_rawnand_chip_cache_read(struct mtd_info *mtd, struct aw_nand_chip *chip,
+		uint8_t *mdata, int stride, int page, int cnt, int *ecc, uint8_t *bitflips)
+{
+	struct aw_nand_host *host = awnand_chip_to_host(chip);
+	uint8_t row1 = page & 0xff;
+	uint8_t row2 = (page >> 8) & 0xff;
+	uint8_t row3 = (page >> 16) & 0xff;
+	bool in_cache = false;
+	int ret = 0;
+	int i = 0;
+
+	awrawnand_chip_trace("Enter %s page@%d cnt@%d\n", __func__, page, cnt);
+
+	if (!chip->dev_ready_wait(mtd)) {
+		awrawnand_err("dev is busy cache read page@%d fail\n", page);
+		ret = -EIO;
+		goto out;
+	}
+
+	if (chip->row_cycles == 3) {
+		NORMAL_REQ_CMD_WITH_ADDR_N5(req, RAWNAND_CMD_READ0, 0, 0, row1, row2, row3);
+		ret = host->normal_op(chip, &req);
+	} else {
+		NORMAL_REQ_CMD_WITH_ADDR_N4(req, RAWNAND_CMD_READ0, 0, 0, row1, row2);
+		ret = host->normal_op(chip, &req);
+	}
+	if (!ret) {
+		NORMAL_REQ_CMD(req2, RAWNAND_CMD_READSTART);
+		ret = host->normal_op(chip, &req2);
+	}
+	if (ret) {
+		awrawnand_err("%s cmd page@%d fail\n", __func__, page);
+		goto out;
+	}
+
+	in_cache = true;
+	for (i = 0; i < cnt; i++) {
+		NORMAL_REQ_CMD(req3, (i == cnt - 1) ? RAWNAND_CMD_READCACHEEND :
+				RAWNAND_CMD_READCACHESEQ);
+		BATCH_REQ_CACHE_READ_OUT(req4, page + i, mdata + i * stride, chip->pagesize);
+
+		if (!chip->dev_ready_wait(mtd)) {
+			ret = -EIO;
+			goto out;
+		}
+		ret = host->normal_op(chip, &req3);
+		if (ret)
+			goto out;
+		if (!chip->dev_ready_wait(mtd)) {
+			ret = -EIO;
+			goto out;
+		}
+
+		ret = host->batch_op(chip, &req4);
+		if (ret < 0)
+			goto out;
+		ecc[i] = ret;
+		bitflips[i] = chip->bitflips;
+	}
+	ret = 0;
+
+out:
+	if (ret) {
+		awrawnand_err("cache read page@%d fail at page@%d\n", page, page + i);
+		/*leave the cache read mode and drop whatever it loaded*/
+		if (in_cache && i < cnt - 1) {
+			NORMAL_REQ_CMD(req5, RAWNAND_CMD_READCACHEEND);
+			host->normal_op(chip, &req5);
+			chip->dev_ready_wait(mtd);
+		}
+	}
+	awrawnand_chip_trace("Exit %s ret@%d\n", __func__, ret);
+	return ret;
+}
+
+static int aw_rawnand_prefetch_fill(struct mtd_info *mtd, struct aw_nand_chip *chip,
+		int page, int cnt, bool multi)
+{
+	struct aw_nand_chip_prefetch *pf = &chip->prefetch;
+	int ecc[CONFIG_AW_RAWNAND_READ_PREFETCH_PAGES];
+	uint8_t bitflips[CONFIG_AW_RAWNAND_READ_PREFETCH_PAGES];
+	int blkA = ((page >> chip->pages_per_blk_shift) << 1);
+	int pageA = ((blkA << chip->pages_per_blk_shift) + (page & chip->pages_per_blk_mask));
+	int pageB = (pageA + (1 << chip->pages_per_blk_shift));
+	int ret = 0;
+	int i = 0;
+
+	pf->nr = 0;
+	pf->page_len = multi ? (chip->pagesize << 1) : chip->pagesize;
+
+	if (!multi)
+		return aw_rawnand_chip_cache_read(mtd, chip, pf->buf, pf->page_len,
+				page, cnt, pf->ecc, pf->bitflips);
+
+	/*super page: blkA page in the first half, blkB page in the second*/
+	ret = aw_rawnand_chip_cache_read(mtd, chip, pf->buf, pf->page_len,
+			pageA, cnt, pf->ecc, pf->bitflips);
+	if (!ret)
+		ret = aw_rawnand_chip_cache_read(mtd, chip, pf->buf + chip->pagesize,
+				pf->page_len, pageB, cnt, ecc, bitflips);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < cnt; i++) {
+		pf->ecc[i] = max(pf->ecc[i], ecc[i]);
+		pf->bitflips[i] = max(pf->bitflips[i], bitflips[i]);
+	}
+
+	return 0;
+}
+
+/**
+ * aw_rawnand_prefetch_read - serve a whole page read from the read-ahead window
+ * @ret: result of the read when it was served
+ *
+ * the second page of a sequential run fills the window up to the end of
+ * the block. return true when the page was served from the window.
+ * **/
+static bool aw_rawnand_prefetch_read(struct mtd_info *mtd, struct aw_nand_chip *chip,
+		uint8_t *mdata, int mlen, int slen, int page, bool multi, int *ret)
+{
+	struct aw_nand_chip_prefetch *pf = &chip->prefetch;
+	int page_len = multi ? (chip->pagesize << 1) : chip->pagesize;
+	int chipno = chip->selected_chip.chip_no;
+	int cnt = 0;
+	int i = 0;
+	bool seq;
+
+	if (!pf->enable || !pf->buf || chip->operate_boot0 || slen || mlen != page_len)
+		return false;
+
+	if (pf->nr && pf->chipno == chipno && pf->multi == multi &&
+			page >= pf->page && page < pf->page + pf->nr)
+		goto hit;
+
+	seq = (pf->chipno == chipno && pf->multi == multi && page == pf->last_page + 1);
+	pf->chipno = chipno;
+	pf->multi = multi;
+	pf->last_page = page;
+	if (!seq)
+		return false;
+
+	cnt = (1 << chip->pages_per_blk_shift) - (page & chip->pages_per_blk_mask);
+	cnt = min(cnt, pf->max_pages);
+	if (cnt < 2)
+		return false;
+
+	if (aw_rawnand_prefetch_fill(mtd, chip, page, cnt, multi))
+		return false;
+	pf->page = page;
+	pf->nr = cnt;
+	pf->fills++;
+
+hit:
+	i = page - pf->page;
+	pf->last_page = page;
+	/*let the normal path retry a page that failed ecc*/
+	if (pf->ecc[i] == ECC_ERR)
+		return false;
+
+	memcpy(mdata, pf->buf + i * page_len, page_len);
+	chip->bitflips = pf->bitflips[i];
+	*ret = pf->ecc[i];
+	if (i)
+		pf->hits++;
+
+	return true;
+}
+
+static int aw_rawnand_prefetch_init(struct aw_nand_chip *chip)
+{
+	struct aw_nand_chip_prefetch *pf = &chip->prefetch;
+	int n = CONFIG_AW_RAWNAND_READ_PREFETCH_PAGES;
+
+	memset(pf, 0, sizeof(*pf));
+	pf->last_page = INVALID_CACHE;
+	pf->max_pages = n;
+	pf->buf = kzalloc(chip->simu_chip_buffer.simu_page_len * n, GFP_KERNEL);
+	pf->ecc = kzalloc(n * sizeof(*pf->ecc), GFP_KERNEL);
+	pf->bitflips = kzalloc(n, GFP_KERNEL);
+	if (!pf->buf || !pf->ecc || !pf->bitflips) {
+		/*not fatal, reads just go one page at a time*/
+		awrawnand_err("kzalloc prefetch buf fail\n");
+		kfree(pf->buf);
+		kfree(pf->ecc);
+		kfree(pf->bitflips);
+		pf->buf = NULL;
+		return -ENOMEM;
+	}
+	pf->enable = true;
+
+	return 0;
+}
+
+static void aw_rawnand_prefetch_destroy(struct aw_nand_chip *chip)
+{
+	struct aw_nand_chip_prefetch *pf = &chip->prefetch;
+
+	kfree(pf->buf);
+	kfree(pf->ecc);
+	kfree(pf->bitflips);
+	memset(pf, 0, sizeof(*pf));
+}
+#else
+static inline bool aw_rawnand_prefetch_read(struct mtd_info *mtd, struct aw_nand_chip *chip,
+		uint8_t *mdata, int mlen, int slen, int page, bool multi, int *ret)
+{
+	return false;
+}
+
+static inline int aw_rawnand_prefetch_init(struct aw_nand_chip *chip)
+{
+	return 0;
+}
+
+static inline void aw_rawnand_prefetch_destroy(struct aw_nand_chip *chip)
+{
+}
+#endif
+
 int aw_rawnand_chip_read_page(struct mtd_info *mtd, struct aw_nand_chip *chip,
 		uint8_t *mdata, int mlen, uint8_t *sdata, int slen, int page)
 {
@@ -757,6 +1152,9 @@ int aw_rawnand_chip_read_page(struct mtd_info *mtd, struct aw_nand_chip *chip,
 	BATCH_REQ_READ(req, page, row_cycles, mdata, mlen, sdata, slen);
 
 	awrawnand_chip_trace("Enter %s page@%d\n", __func__, page);
+	if (aw_rawnand_prefetch_read(mtd, chip, mdata, mlen, slen, page, false, &ret))
+		goto out;
+
 	if (!chip->dev_ready_wait(mtd)) {
 		awrawnand_err("dev is busy read page@%d fail\n", page);
 		ret = -EIO;
@@ -850,6 +1248,9 @@ int aw_rawnand_chip_multi_read_page(struct mtd_info *mtd, struct aw_nand_chip *c
 {
 	int ret = 0;
 
+	if (aw_rawnand_prefetch_read(mtd, chip, mdata, mlen, slen, page, true, &ret))
+		return ret;
+
 	ret =  aw_rawnand_chip_simu_multi_read_page(mtd, chip,
 			mdata, mlen, sdata, slen, page);
 
@@ -1541,6 +1942,7 @@ static int aw_rawnand_mtd_write_oob(struct mtd_info *mtd, loff_t to,
 			   struct mtd_oob_ops *ops)
 {
 	struct aw_nand_chip *chip = awnand_mtd_to_chip(mtd);
+	struct aw_nand_op op = { 0 };
 	int ret = 0;
 	int chipnr = 0;
 	int block = 0;
@@ -1635,13 +2037,9 @@ static int aw_rawnand_mtd_write_oob(struct mtd_info *mtd, loff_t to,
 			if (!(page_in_chip & chip->pages_per_blk_mask)) {
 				page_in_chip--;
 
-#if SIMULATE_MULTIPLANE
-				ret = chip->multi_write_page(mtd, chip, pagebuf, buffer->simu_page_len,
-						oobbuf, slen, page_in_chip);
-#else
-				ret = chip->write_page(mtd, chip, pagebuf, buffer->simu_page_len,
-						oobbuf, slen, page_in_chip);
-#endif
+				ret = aw_rawnand_mtd_write_page_submit(mtd, chip, pagebuf,
+						buffer->simu_page_len, oobbuf, slen,
+						page_in_chip, &op);
 				if (ret) {
 					awrawnand_err("write page@%d fail\n", page);
 					ops->retlen = 0;
@@ -1655,13 +2053,9 @@ static int aw_rawnand_mtd_write_oob(struct mtd_info *mtd, loff_t to,
 					ret = chip->cache_write_page(mtd, chip, pagebuf, buffer->simu_page_len,
 							oobbuf, slen, page_in_chip);
 				} else {
-#if SIMULATE_MULTIPLANE
-					ret = chip->multi_write_page(mtd, chip, pagebuf, buffer->simu_page_len,
-							oobbuf, slen, page_in_chip);
-#else
-					ret = chip->write_page(mtd, chip, pagebuf, buffer->simu_page_len,
-							oobbuf, slen, page_in_chip);
-#endif
+					ret = aw_rawnand_mtd_write_page_submit(mtd, chip, pagebuf,
+							buffer->simu_page_len, oobbuf, slen,
+							page_in_chip, &op);
 				}
 				if (ret) {
 					awrawnand_err("write page@%d fail\n", page);
@@ -1686,6 +2080,14 @@ static int aw_rawnand_mtd_write_oob(struct mtd_info *mtd, loff_t to,
 					memcpy(oobbuf, sdata, slen);
 				buffer->simu_oobno = page;
 			}
+
+			/*the next page is staged, now wait for the program*/
+			ret = aw_rawnand_op_wait(mtd, &op);
+			if (ret) {
+				awrawnand_err("write page@%d fail\n", page);
+				ops->retlen = 0;
+				goto out;
+			}
 		}
 
 		page_in_chip = page & chip->simu_chip_pages_mask;
@@ -2020,6 +2422,8 @@ static int aw_rawnand_chip_data_init(struct mtd_info *mtd)
 	chip->simu_chip_buffer.simu_oobno = INVALID_CACHE;
 	chip->simu_chip_buffer.bitflips = 0;
 
+	aw_rawnand_prefetch_init(chip);
+
 	if (chip->type == SLC_NAND) {
 		chip->write_boot0_page = rawslcnand_write_boot0_page;
 		chip->read_boot0_page = rawslcnand_read_boot0_page;
@@ -2053,6 +2457,7 @@ static void aw_rawnand_chip_data_destroy(struct mtd_info *mtd)
 	kfree(chip->bbtd);
 	kfree(chip->simu_chip_buffer.simu_pagebuf);
 	kfree(chip->simu_chip_buffer.simu_oobbuf);
+	aw_rawnand_prefetch_destroy(chip);
 }
 
 static int aw_rawnand_mtd_info_init(struct mtd_info *mtd)
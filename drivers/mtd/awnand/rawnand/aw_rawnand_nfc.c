@@ -17,6 +17,13 @@
 #include <sys_config.h>
 #include <asm/io.h>
 #include <asm/arch/clock.h>
+#ifdef CONFIG_AW_RAWNAND_NFC_IRQ
+#include <asm/arch/gic.h>
+/*socs without a NAND interrupt line in gic.h keep polling*/
+#ifdef AW_IRQ_NAND
+#define NFC_USE_IRQ
+#endif
+#endif
 #include "aw_rawnand_nfc.h"
 
 struct aw_nand_host aw_host;
@@ -163,6 +170,7 @@ static int aw_host_nfc_wait_cmd_fifo_empty(struct nfc_reg *nfc)
 	int ret = -ETIMEDOUT;
 	uint32_t timeout_ms = 1000;
 	uint32_t time_start = 0;
+	ulong spin_start = timer_get_us();
 
 	time_start = get_timer(0);
 
@@ -179,6 +187,7 @@ static int aw_host_nfc_wait_cmd_fifo_empty(struct nfc_reg *nfc)
 		aw_nfc_reg_dump(nfc);
 	}
 out:
+	aw_nand_wait_stat_spin(awnand_nfc_to_host(nfc), spin_start);
 	return ret;
 }
 
@@ -187,6 +196,7 @@ static int aw_host_nfc_wait_fsm_idle(struct nfc_reg *nfc)
 	int ret = -ETIMEDOUT;
 	uint32_t timeout_ms = 1000;
 	uint32_t time_start = 0;
+	ulong spin_start = timer_get_us();
 
 	time_start = get_timer(0);
 
@@ -203,6 +213,7 @@ static int aw_host_nfc_wait_fsm_idle(struct nfc_reg *nfc)
 		aw_nfc_reg_dump(nfc);
 	}
 out:
+	aw_nand_wait_stat_spin(awnand_nfc_to_host(nfc), spin_start);
 	return ret;
 }
 
@@ -211,6 +222,7 @@ static int aw_host_nfc_wait_cmd_finish(struct nfc_reg *nfc)
 	int ret = -ETIMEDOUT;
 	uint32_t timeout_ms = 10000;
 	uint32_t time_start = 0;
+	ulong spin_start = timer_get_us();
 	/*AWRAWNAND_TRACE_NFC("Enter %s\n", __func__);*/
 
 	time_start = get_timer(0);
@@ -226,6 +238,7 @@ static int aw_host_nfc_wait_cmd_finish(struct nfc_reg *nfc)
 		awrawnand_err("wait nfc wait cmd finish 10s timeout[%x:%x]\n",
 				nfc->sta, readl(nfc->sta));
 out:
+	aw_nand_wait_stat_spin(awnand_nfc_to_host(nfc), spin_start);
 	/*write 1 to clear CMD INT FLAG*/
 	writel(NFC_CMD_INT_FLAG, nfc->sta);
 	/*AWRAWNAND_TRACE_NFC("Exit %s\n", __func__);*/
@@ -267,6 +280,7 @@ static bool aw_host_nfc_wait_rb_ready(struct aw_nand_chip *chip, struct aw_nand_
 	uint32_t val = 0;
 	int chip_no = chip->selected_chip.chip_no;
 	uint32_t time_start = 0;
+	ulong spin_start = timer_get_us();
 	AWRAWNAND_TRACE_NFC("Enter %s\n", __func__);
 	time_start = get_timer(0);
 
@@ -283,6 +297,7 @@ static bool aw_host_nfc_wait_rb_ready(struct aw_nand_chip *chip, struct aw_nand_
 			}
 		}
 	} while (get_timer(get_timer(time_start) < 60000));
+	aw_nand_wait_stat_spin(host, spin_start);
 	AWRAWNAND_TRACE_NFC("Exit %s %s status[%p:%x]\n", __func__, ret ? "ready" : "busy",
 			host->nfc_reg.sta, readl(host->nfc_reg.sta));
 	return ret ? true : false;
@@ -316,6 +331,7 @@ static int aw_host_wait_dma_ready_flag_timeout(struct aw_nand_host *host, uint32
 {
 	int ret = -ETIMEDOUT;
 	uint32_t time_start = 0;
+	ulong spin_start = timer_get_us();
 
 	time_start = get_timer(0);
 
@@ -331,6 +347,7 @@ static int aw_host_wait_dma_ready_flag_timeout(struct aw_nand_host *host, uint32
 				&host->nfc_reg.sta, readl(host->nfc_reg.sta));
 	}
 out:
+	aw_nand_wait_stat_spin(host, spin_start);
 	return ret;
 
 }
@@ -338,6 +355,7 @@ static int aw_host_nfc_wait_status_timeout(struct nfc_reg *nfc, uint32_t mark, u
 {
 	int ret = -ETIMEDOUT;
 	uint32_t time_start = 0;
+	ulong spin_start = timer_get_us();
 	AWRAWNAND_TRACE_NFC("Enter %s\n", __func__);
 
 	time_start = get_timer(0);
@@ -353,6 +371,7 @@ static int aw_host_nfc_wait_status_timeout(struct nfc_reg *nfc, uint32_t mark, u
 		awrawnand_err("wait nfc wait status 10s timeout[%x:%x:%x:%x]\n",
 				mark, value, nfc->sta, readl(nfc->sta));
 out:
+	aw_nand_wait_stat_spin(awnand_nfc_to_host(nfc), spin_start);
 	AWRAWNAND_TRACE_NFC("Exit %s ret@%d sta[%x:%x]\n", __func__, ret, nfc->sta, readl(nfc->sta));
 	return ret;
 }
@@ -628,14 +647,18 @@ static int aw_host_nfc_dma_config_start(struct aw_nand_host *host, uint8_t rw, v
 
 }
 
+/*
+ * there is no scheduler to wake up in u-boot, whoever waits on the flag
+ * sees it change, just count the events
+ */
 static void aw_host_rb_wake_up(void)
 {
-	return;
+	aw_host.wait_stat.rb_irqs++;
 }
 
 static void aw_host_dma_wake_up(void)
 {
-	return;
+	aw_host.wait_stat.dma_irqs++;
 }
 
 void aw_host_nfc_do_nand_interrupt(void)
@@ -658,6 +681,24 @@ void aw_host_nfc_do_nand_interrupt(void)
 	}
 }
 
+/*
+ * the B2R interrupt is enabled only while a program or erase is running, a
+ * status flag left over from a read must not complete the next operation
+ */
+static void aw_host_nfc_rb_event_arm(struct aw_nand_host *host)
+{
+	host->rb_ready_flag = 0;
+	aw_host_nfc_rb_b2r_intstatus_clear(&host->nfc_reg);
+	aw_host_nfc_rb_b2r_int_enable(&host->nfc_reg);
+}
+
+#ifdef NFC_USE_IRQ
+static void aw_host_nfc_irq_handler(void *data)
+{
+	aw_host_nfc_do_nand_interrupt();
+}
+#endif
+
 
 static int aw_host_nfc_dma_wait_end(struct aw_nand_host *host, uint8_t rw, void *addr, unsigned int len)
 {
@@ -914,6 +955,9 @@ static int aw_host_nfc_batch_op(struct aw_nand_chip *chip, struct aw_nfc_batch_r
 		goto out_err;
 	}
 
+	/*the end of tPROG is signalled by the B2R interrupt*/
+	if (host->use_rb_int && req->type == WRITE)
+		host->rb_event_arm(host);
 
 	if (req->data.type != ONLY_SPARE) {
 		aw_host_nfc_dma_config_start(host, req->type, req->data.main, req->data.main_len);
@@ -938,8 +982,8 @@ static int aw_host_nfc_batch_op(struct aw_nand_chip *chip, struct aw_nfc_batch_r
 		goto out_err;
 	}
 
-	if (host->use_rb_int) {
-		/*to do*/
+	if (host->use_rb_int && req->type == WRITE) {
+		/*leave the chip programming, see aw_rawnand_op_wait()*/
 	} else {
 		ret = aw_host_nfc_wait_rb_ready(chip, host);
 		if (!ret) {
@@ -1699,6 +1743,7 @@ static inline int aw_host_resource_init(struct aw_nand_host *host)
 	host->normal_op = aw_host_nfc_normal_op;
 	host->batch_op = aw_host_nfc_batch_op;
 	host->rb_ready = aw_host_nfc_rb_ready;
+	host->rb_event_arm = aw_host_nfc_rb_event_arm;
 
 	aw_nfc_reg_prepare(&host->nfc_reg);
 
@@ -1931,6 +1976,12 @@ int aw_host_init(struct udevice *dev)
 		goto out;
 	}
 
+#ifdef NFC_USE_IRQ
+	irq_install_handler(AW_IRQ_NAND, aw_host_nfc_irq_handler, host);
+	irq_enable(AW_IRQ_NAND);
+	host->use_rb_int = 1;
+#endif
+
 	host->init = true;
 	return ret;
 
@@ -1943,6 +1994,14 @@ EXPORT_SYMBOL_GPL(aw_host_init);
 
 void aw_host_exit(struct aw_nand_host *host)
 {
+#ifdef NFC_USE_IRQ
+	if (host->use_rb_int) {
+		aw_host_nfc_rb_b2r_int_disable(&host->nfc_reg);
+		irq_disable(AW_IRQ_NAND);
+		irq_free_handler(AW_IRQ_NAND);
+		host->use_rb_int = 0;
+	}
+#endif
 	aw_host_resource_destroy(host);
 }
 EXPORT_SYMBOL_GPL(aw_host_exit);
@@ -100,6 +100,7 @@ int rawslcnand_write_boot0_page(struct mtd_info *mtd, struct aw_nand_chip *chip,
 
 	chip->operate_boot0 = 1;
 	chip->boot0_ecc_mode = MAX_ECC_BCH_80;
+	aw_rawnand_prefetch_drop(chip);
 
 	BATCH_REQ_WRITE_SEQ(req, page, row_cycles, mdata, mlen, sdata, slen);
 
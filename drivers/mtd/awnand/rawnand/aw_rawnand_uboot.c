@@ -14,6 +14,7 @@
 #include <linux/mtd/aw-rawnand.h>
 #include <fdt_support.h>
 #include <linux/mtd/aw-ubi.h>
+#include <u-boot/crc.h>
 
 
 #define VERSION "v1.30 2022-05-13 13:14"
@@ -296,6 +297,126 @@ int rawnand_mtd_secure_storage_write(int item, char *buf, unsigned int len)
 EXPORT_SYMBOL_GPL(rawnand_mtd_secure_storage_write);
 
 
+#ifdef CONFIG_AW_RAWNAND_READ_PREFETCH
+static int rawnand_read_bench_pass(struct mtd_info *mtd, loff_t from, size_t len,
+		uint8_t *buf, u32 *crc, ulong *us, size_t *bytes)
+{
+	struct aw_nand_chip *chip = awnand_mtd_to_chip(mtd);
+	loff_t ofs = from;
+	size_t retlen = 0;
+	ulong start = 0;
+	int ret = 0;
+
+	*crc = 0;
+	*bytes = 0;
+	chip->simu_chip_buffer.simu_pageno = INVALID_CACHE;
+	aw_rawnand_prefetch_drop(chip);
+
+	start = timer_get_us();
+	while (ofs < from + len) {
+		if (!(ofs & (mtd->erasesize - 1)) && mtd_block_isbad(mtd, ofs)) {
+			ofs += mtd->erasesize;
+			continue;
+		}
+		/*page by page, the way ubi reads a volume*/
+		ret = mtd_read(mtd, ofs, mtd->writesize, &retlen, buf);
+		if (ret < 0 && ret != -EUCLEAN) {
+			awrawnand_err("bench read@0x%llx fail ret@%d\n", ofs, ret);
+			return ret;
+		}
+		*crc = crc32(*crc, buf, mtd->writesize);
+		*bytes += mtd->writesize;
+		ofs += mtd->writesize;
+	}
+	*us = timer_get_us() - start;
+
+	return 0;
+}
+
+/*
+ * read [from, from + len) with the read-ahead off and then on, report
+ * MB/s for both and check they read the same data
+ */
+int rawnand_mtd_read_bench(loff_t from, size_t len)
+{
+	struct aw_nand_chip *chip = get_rawnand();
+	struct mtd_info *mtd = awnand_chip_to_mtd(chip);
+	struct aw_nand_chip_prefetch *pf = &chip->prefetch;
+	bool enable = pf->enable;
+	u32 crc[2] = {0};
+	ulong us[2] = {0};
+	size_t bytes[2] = {0};
+	uint8_t *buf = NULL;
+	unsigned int hits = 0, fills = 0;
+	ulong kbps = 0;
+	int ret = 0;
+	int i = 0;
+
+	if (!pf->buf) {
+		awrawnand_err("no read-ahead window\n");
+		return -ENOMEM;
+	}
+
+	from = round_down(from, mtd->erasesize);
+	if (from >= mtd->size)
+		return -EINVAL;
+	len = min_t(uint64_t, round_up(len, mtd->writesize), mtd->size - from);
+
+	buf = kzalloc(mtd->writesize, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	for (i = 0; i < 2; i++) {
+		pf->enable = i;
+		hits = pf->hits;
+		fills = pf->fills;
+		ret = rawnand_read_bench_pass(mtd, from, len, buf, &crc[i], &us[i], &bytes[i]);
+		if (ret)
+			break;
+
+		kbps = us[i] ? (ulong)((u64)bytes[i] * 1000 / us[i]) : 0;
+		printf("%-10s %zu bytes in %lu us, %lu.%03lu MB/s", i ? "prefetch" : "page",
+				bytes[i], us[i], kbps / 1000, kbps % 1000);
+		if (i)
+			printf(", %u fills %u hits", pf->fills - fills, pf->hits - hits);
+		printf("\n");
+	}
+	pf->enable = enable;
+	kfree(buf);
+
+	if (!ret && crc[0] != crc[1]) {
+		printf("crc mismatch: page 0x%08x, prefetch 0x%08x\n", crc[0], crc[1]);
+		ret = -EIO;
+	}
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(rawnand_mtd_read_bench);
+#endif
+
+/*
+ * spin is cpu time lost polling the controller and the RB line, overlap
+ * is time a program/erase ran in the chip while the caller went on
+ */
+void rawnand_mtd_wait_stat(int reset)
+{
+	struct aw_nand_host *host = &aw_host;
+	struct aw_nand_wait_stat *st = &host->wait_stat;
+
+	if (!host->init)
+		return;
+
+	printf("irq:     %s, %u rb %u dma\n", host->use_rb_int ? "on" : "off",
+			st->rb_irqs, st->dma_irqs);
+	printf("spin:    %llu us in %u waits\n", st->spin_us, st->spins);
+	printf("overlap: %llu us over %u program/erase\n", st->overlap_us,
+			st->pe_ops);
+
+	if (reset)
+		memset(st, 0, sizeof(*st));
+}
+EXPORT_SYMBOL_GPL(rawnand_mtd_wait_stat);
+
 int rawnand_mtd_init(void)
 {
 	struct udevice *dev = get_udevice();
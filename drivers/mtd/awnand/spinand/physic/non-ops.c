@@ -18,15 +18,18 @@
 static int aw_spinand_chip_wait(struct aw_spinand_chip *chip,
 		unsigned char *status)
 {
-	unsigned long timeout = timer_get_us() + 1 * 1000 * 1000;
+	unsigned long start = timer_get_us();
+	unsigned long timeout = start + 1 * 1000 * 1000;
 	struct aw_spinand_chip_ops *ops = chip->ops;
 	unsigned char s = 0;
 	int ret;
 
+	chip->wait_stat.waits++;
 	do {
 		ret = ops->read_status(chip, &s);
+		chip->wait_stat.polls++;
 		if (ret)
-			return ret;
+			goto err;
 
 		if (!(s & STATUS_BUSY))
 			goto out;
@@ -38,12 +41,15 @@ static int aw_spinand_chip_wait(struct aw_spinand_chip *chip,
 	 */
 	ret = ops->read_status(chip, &s);
 	if (ret)
-		return ret;
+		goto err;
 
 out:
+	ret = s & STATUS_BUSY ? -ETIMEDOUT : 0;
 	if (status)
 		*status = s;
-	return s & STATUS_BUSY ? -ETIMEDOUT : 0;
+err:
+	chip->wait_stat.spin_us += timer_get_us() - start;
+	return ret;
 }
 
 static int aw_spinand_chip_reset(struct aw_spinand_chip *chip)
@@ -526,3 +526,19 @@ int spinand_mtd_secure_storage_write(int item, char *buf, unsigned int len)
 
 	return aw_spinand_secure_storage_write(&spinand->sec_sto, item, buf, len);
 }
+
+void spinand_mtd_wait_stat(int reset)
+{
+	struct aw_spinand *spinand = get_spinand();
+	struct aw_spinand_wait_stat *st;
+
+	if (!spinand)
+		return;
+
+	st = &spinand_to_chip(spinand)->wait_stat;
+	printf("spin: %llu us in %u waits, %u status polls\n", st->spin_us,
+			st->waits, st->polls);
+
+	if (reset)
+		memset(st, 0, sizeof(*st));
+}
@@ -124,6 +124,7 @@ typedef struct {
 	enum spi_nor_protocol	read_proto;
 	enum spi_nor_protocol	write_proto;
 	u8			read_dummy;
+	u8			flash_id[SPI_NOR_MAX_ID_LEN];/* sample delay was tuned on this flash */
 } boot_spinor_info_t;
 
 #endif /* _SF_INTERNAL_H_ */
@@ -294,3 +294,33 @@ int riscv_dts_sharespace_msg(struct dts_msg_t *pmsg, u32 riscv_id)
 
 	return 0;
 }
+
+/* the dram reserved for the riscv firmware, /reserved-memory/riscv<id> */
+int dts_get_riscv_memory(ulong *start, u32 *size, u32 riscv_id)
+{
+	int nodeoffset;
+	int ret;
+	u32 reg_data[8];
+	char str[32];
+
+	memset(str, 0, sizeof(str));
+	sprintf(str, "/reserved-memory/riscv%d", riscv_id);
+	nodeoffset = fdt_path_offset(working_fdt, str);
+	if (nodeoffset < 0) {
+		pr_err("%s: no %s in fdt\n", __func__, str);
+		return -1;
+	}
+
+	memset(reg_data, 0, sizeof(reg_data));
+	ret = fdt_getprop_u32(working_fdt, nodeoffset, "reg", reg_data);
+	if (ret < 0) {
+		pr_err("%s: error fdt get reg\n", __func__);
+		return -2;
+	}
+
+	*start = reg_data[1];
+	*size = reg_data[3];
+	RISCV_DEBUG("riscv%d: memory start = 0x%x size = 0x%x\n",
+		    riscv_id, (u32)*start, *size);
+	return 0;
+}
@@ -25,4 +25,5 @@ int riscv_dts_uart_msg(struct dts_msg_t *pmsg, u32 riscv_id);
 int dts_riscv_status(struct dts_msg_t *pmsg, u32 riscv_id);
 int riscv_dts_gpio_int_msg(struct dts_msg_t *pmsg, u32 riscv_id);
 int riscv_dts_sharespace_msg(struct dts_msg_t *pmsg, u32 riscv_id);
+int dts_get_riscv_memory(ulong *start, u32 *size, u32 riscv_id);
 #endif
@@ -19,8 +19,21 @@
 #include <asm/arch-sunxi/cpu_ncat_v2.h>
 #include <asm/io.h>
 #include <common.h>
+#include <malloc.h>
 #include <sys_config.h>
+#include <sys_partition.h>
+#include <sunxi_flash.h>
 #include <sunxi_image_verifier.h>
+#include <sunxi_dma_memcpy.h>
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+#include <sunxi_image_header.h>
+#endif
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+#include <u-boot/sha256.h>
+#endif
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+#include <asm/arch/ce.h>
+#endif
 
 #include "platform.h"
 #include "elf.h"
@@ -30,6 +43,8 @@
 #include "../common/riscv_img.h"
 #include "../common/riscv_ic.h"
 
+DECLARE_GLOBAL_DATA_PTR;
+
 #define readl_riscv(addr)	readl((const volatile void*)(addr))
 #define writel_riscv(val, addr)	writel((u32)(val), (volatile void*)(addr))
 
@@ -39,6 +54,10 @@
 #define ROUND_DOWN_CACHE(a) ROUND_DOWN(a, CONFIG_SYS_CACHELINE_SIZE)
 #define ROUND_UP_CACHE(a)   ROUND_UP(a, CONFIG_SYS_CACHELINE_SIZE)
 
+#define RISCV_SECTOR_SIZE	(512)
+/* staging buffer for elf headers, gaps and segment edges */
+#define RISCV_STREAM_CHUNK	(64 * 1024)
+
 /*
  * riscv need to remap addresses for some addr.
  */
@@ -82,10 +101,10 @@ static int load_image(u32 img_addr, u32 riscv_id)
 		      i, src, dst, phdr->p_filesz);
 
 		if (phdr->p_filesz)
-			memcpy(dst, src, phdr->p_filesz);
+			sunxi_dma_memcpy(dst, src, phdr->p_filesz);
 		if (phdr->p_filesz != phdr->p_memsz)
-			memset(dst + phdr->p_filesz, 0x00,
-			       phdr->p_memsz - phdr->p_filesz);
+			sunxi_dma_memset(dst + phdr->p_filesz, 0x00,
+					 phdr->p_memsz - phdr->p_filesz);
 		if (i == 0)
 			show_img_version((char *)dst + 896, riscv_id);
 
@@ -97,21 +116,10 @@ static int load_image(u32 img_addr, u32 riscv_id)
 	return 0;
 }
 
-int sunxi_riscv_init(u32 img_addr, u32 run_ddr, u32 riscv_id)
+static void riscv_release(u32 run_ddr, u32 riscv_id)
 {
-
 	u32 reg_val;
-	u32 image_len = 0;
 
-#ifdef CONFIG_SUNXI_VERIFY_RISCV
-	if (sunxi_verify_riscv(img_addr, image_len, riscv_id) < 0) {
-		return -1;
-	}
-#endif
-	/* update run addr */
-	update_reset_vec(img_addr, &run_ddr);
-	/* load image to ram */
-	load_image(img_addr, riscv_id);
 	if (riscv_id == 0) { /* RISCV0 */
 		printf("[bsp]: %s: %s(): +%d\n", __FILE__, __func__, __LINE__);
 		/* clock gating */
@@ -154,7 +162,543 @@ int sunxi_riscv_init(u32 img_addr, u32 run_ddr, u32 riscv_id)
 		RISCV_DEBUG("clock gating reg(0x%08x):0x%08x\n", SUNXI_CCM_BASE + RISCV_GATING_RST_REG,
 						readl_riscv(SUNXI_CCM_BASE + RISCV_GATING_RST_REG));
 	}
+}
+
+#if defined(CONFIG_SUNXI_VERIFY_RISCV) && !defined(CONFIG_SUNXI_IMAGE_HEADER)
+/* length of the signed elf, recorded in the rtos header of .oemhead.text */
+static int riscv_get_image_len(u32 img_addr, u32 *len)
+{
+	unsigned long addr;
+
+	if (find_img_section(img_addr, ".oemhead.text", &addr) ||
+	    img_len_get(img_addr, addr, len) || !*len) {
+		pr_err("riscv: no image length in .oemhead.text\n");
+		return -1;
+	}
+
+	return 0;
+}
+#endif
+
+int sunxi_riscv_init(u32 img_addr, u32 run_ddr, u32 riscv_id)
+{
+	u32 image_len = 0;
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+	sunxi_image_header_t *ih = (sunxi_image_header_t *)(ADDR_TPYE)img_addr;
+	/* sunxi_image_verify() moves the payload over the header */
+	u32 hsize = ih->ih_hsize;
+
+	image_len = ih->ih_psize;
+#endif
+
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+#ifndef CONFIG_SUNXI_IMAGE_HEADER
+	if (gd->securemode && riscv_get_image_len(img_addr, &image_len))
+		return -1;
+#endif
+	if (sunxi_verify_riscv(img_addr, image_len, riscv_id) < 0) {
+		return -1;
+	}
+#endif
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+	/* the elf is the payload behind the sunxi image header */
+	if (!(IS_ENABLED(CONFIG_SUNXI_VERIFY_RISCV) && gd->securemode))
+		img_addr += hsize;
+#endif
+	/* update run addr */
+	update_reset_vec(img_addr, &run_ddr);
+	/* load image to ram */
+	load_image(img_addr, riscv_id);
+	riscv_release(run_ddr, riscv_id);
 	RISCV_DEBUG("RISCV%d start ok, img length %d, booting from 0x%x\n",
 			riscv_id, image_len, run_ddr);
 	return 0;
 }
+
+/*
+ * streaming loader: the elf is read from flash once and each PT_LOAD
+ * segment is read straight to its load address whenever the destination
+ * allows it. only the elf headers, the gaps between segments and
+ * sub-sector segment edges go through a staging buffer. all file offsets
+ * below count from the partition start, the elf sits behind the sunxi
+ * image header when there is one.
+ *
+ * on a secure boot every chunk is fed to sha256 as it is read, and the
+ * digest and signature are checked once the whole signed range went by.
+ * the core is only released after that check passed. with the CE hash
+ * stream a chunk is hashed by the engine while the next one is read.
+ */
+struct riscv_stream {
+	u32 part_start;		/* partition start, in sectors */
+	u32 part_len;		/* partition length, in bytes */
+	u32 base;		/* elf offset, the sunxi image header size */
+	u32 img_len;		/* end of the segment data */
+	u32 end;		/* end of what has to be read */
+	u32 pos;		/* next file offset to read, sector aligned */
+	u32 entry;
+	ulong mem_start;	/* riscv reserved-memory */
+	u32 mem_size;
+	u8 *buf;
+	Elf32_Phdr *phdr;
+	int phnum;
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+	u32 hash_len;		/* signed bytes from offset 0, 0 if unchecked */
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	struct sunxi_ce_hash_ctx *ce;
+#else
+	sha256_context sha;
+#endif
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+	u8 *tlv;		/* tlv area behind the payload */
+	u32 tlv_off;
+	u32 tlv_len;
+#endif
+#endif
+};
+
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+static int riscv_hash_starts(struct riscv_stream *s)
+{
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	s->ce = malloc_align(sizeof(*s->ce), CONFIG_SYS_CACHELINE_SIZE);
+	if (!s->ce)
+		return -1;
+	sunxi_ss_open();
+	return sunxi_ce_hash_init(s->ce, SUNXI_SHA256);
+#else
+	sha256_starts(&s->sha);
+	return 0;
+#endif
+}
+
+/*
+ * on the CE the data is only queued and hashed while the caller goes on,
+ * src has to stay untouched until sunxi_ce_hash_poll() reports it done
+ */
+static int riscv_hash_update(struct riscv_stream *s, u8 *src, u32 len)
+{
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	struct sunxi_ce_hash_sg sg = { src, len };
+
+	return sunxi_ce_hash_update_async(s->ce, &sg, 1);
+#else
+	sha256_update(&s->sha, src, len);
+	return 0;
+#endif
+}
+
+static int riscv_hash_finish(struct riscv_stream *s, u8 *hash)
+{
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	return sunxi_ce_hash_final(s->ce, hash);
+#else
+	sha256_finish(&s->sha, hash);
+	return 0;
+#endif
+}
+
+/* hash the part of [pos, pos + len) at src inside the signed range */
+static int riscv_stream_hash(struct riscv_stream *s, u8 *src,
+			     u32 pos, u32 len)
+{
+	if (pos >= s->hash_len)
+		return 0;
+
+	return riscv_hash_update(s, src, min(len, s->hash_len - pos));
+}
+#endif
+
+static int riscv_stream_read(struct riscv_stream *s, void *dst, u32 len)
+{
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+	/* the engine may still be reading the chunk staged before */
+	if (dst == s->buf && s->ce && sunxi_ce_hash_wait(s->ce))
+		return -1;
+#endif
+	if (!sunxi_flash_read(s->part_start + s->pos / RISCV_SECTOR_SIZE,
+			      len / RISCV_SECTOR_SIZE, dst)) {
+		pr_err("riscv: read 0x%x bytes at 0x%x failed\n", len, s->pos);
+		return -1;
+	}
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+	if (riscv_stream_hash(s, dst, s->pos, len))
+		return -1;
+#endif
+	s->pos += len;
+
+	return 0;
+}
+
+static void *riscv_seg_dst(Elf32_Phdr *phdr)
+{
+	return (void *)(ADDR_TPYE)set_img_va_to_pa((unsigned long)phdr->p_paddr,
+				addr_mapping, ARRAY_SIZE(addr_mapping));
+}
+
+/*
+ * every PT_LOAD segment must come from the first file_len bytes of the
+ * elf and land inside the riscv reserved-memory, checked before anything
+ * is copied
+ */
+static int riscv_seg_check(struct riscv_stream *s, u32 file_len)
+{
+	ulong base = s->mem_start;
+	ulong size = s->mem_size;
+	Elf32_Phdr *phdr;
+	ulong dst;
+	int i;
+
+	for (i = 0, phdr = s->phdr; i < s->phnum; i++, phdr++) {
+		if (phdr->p_type != PT_LOAD)
+			continue;
+		dst = (ulong)riscv_seg_dst(phdr);
+		if (phdr->p_filesz > phdr->p_memsz ||
+		    phdr->p_offset > file_len ||
+		    phdr->p_filesz > file_len - phdr->p_offset ||
+		    dst < base || phdr->p_memsz > size ||
+		    dst - base > size - phdr->p_memsz) {
+			pr_err("riscv: segment %d at 0x%lx (0x%x bytes) outside 0x%lx-0x%lx\n",
+			       i, dst, phdr->p_memsz, base, base + size);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* parse the elf headers at elf, the first len bytes of the elf */
+static int riscv_elf_parse(struct riscv_stream *s, u8 *elf, u32 len)
+{
+	Elf32_Ehdr *ehdr = (Elf32_Ehdr *)elf;
+
+	if (len < sizeof(*ehdr) || !IS_ELF(*ehdr) || !ehdr->e_phnum ||
+	    ehdr->e_phoff > len ||
+	    ehdr->e_phnum * sizeof(Elf32_Phdr) > len - ehdr->e_phoff) {
+		pr_err("riscv: no elf header found\n");
+		return -1;
+	}
+
+	s->entry = ehdr->e_entry;
+	s->phnum = ehdr->e_phnum;
+	s->phdr = malloc(s->phnum * sizeof(Elf32_Phdr));
+	if (!s->phdr)
+		return -1;
+	memcpy(s->phdr, elf + ehdr->e_phoff, s->phnum * sizeof(Elf32_Phdr));
+
+	return 0;
+}
+
+#if defined(CONFIG_SUNXI_VERIFY_RISCV) && !defined(CONFIG_SUNXI_IMAGE_HEADER)
+/*
+ * the signed length is the image_size of the rtos header, which starts the
+ * segment built from .oemhead.text. it has to be in the first chunk.
+ */
+static int riscv_rtos_image_len(struct riscv_stream *s, u8 *elf, u32 len,
+				u32 *image_len)
+{
+	struct spare_rtos_head_t *prtos;
+	Elf32_Phdr *phdr;
+	int i;
+
+	for (i = 0, phdr = s->phdr; i < s->phnum; i++, phdr++) {
+		if (phdr->p_type != PT_LOAD ||
+		    phdr->p_filesz < sizeof(prtos->rtos_img_hdr) ||
+		    phdr->p_offset > len ||
+		    sizeof(prtos->rtos_img_hdr) > len - phdr->p_offset)
+			continue;
+		prtos = (struct spare_rtos_head_t *)(elf + phdr->p_offset);
+		if (memcmp(prtos->rtos_img_hdr.magic, RTOS_MAGIC, MAGIC_SIZE))
+			continue;
+		*image_len = prtos->rtos_img_hdr.image_size;
+		if (!*image_len || *image_len > s->part_len)
+			break;
+		return 0;
+	}
+
+	pr_err("riscv: no image length in the rtos header\n");
+	return -1;
+}
+#endif
+
+#if defined(CONFIG_SUNXI_VERIFY_RISCV) && defined(CONFIG_SUNXI_IMAGE_HEADER)
+/* keep the part of [pos, pos + len) at src that belongs to the tlv area */
+static void riscv_stream_keep(struct riscv_stream *s, u8 *src,
+			      u32 pos, u32 len)
+{
+	u32 start, end;
+
+	if (!s->tlv)
+		return;
+	start = max(pos, s->tlv_off);
+	end = min(pos + len, s->tlv_off + s->tlv_len);
+	if (start < end)
+		memcpy(s->tlv + (start - s->tlv_off), src + (start - pos),
+		       end - start);
+}
+#endif
+
+/* segment holding file offset pos, NULL for a gap */
+static Elf32_Phdr *riscv_stream_seg(struct riscv_stream *s, u32 pos)
+{
+	int i;
+
+	for (i = 0; i < s->phnum; i++) {
+		Elf32_Phdr *phdr = &s->phdr[i];
+
+		if (phdr->p_type == PT_LOAD && phdr->p_filesz &&
+		    pos >= phdr->p_offset &&
+		    pos < phdr->p_offset + phdr->p_filesz)
+			return phdr;
+	}
+
+	return NULL;
+}
+
+/* copy the part of [pos, pos + len) at src that belongs to segments */
+static void riscv_stream_place(struct riscv_stream *s, u8 *src,
+			       u32 pos, u32 len)
+{
+	u32 start, end;
+	int i;
+
+	for (i = 0; i < s->phnum; i++) {
+		Elf32_Phdr *phdr = &s->phdr[i];
+
+		if (phdr->p_type != PT_LOAD)
+			continue;
+		start = max(pos, phdr->p_offset);
+		end = min(pos + len, phdr->p_offset + phdr->p_filesz);
+		if (start >= end)
+			continue;
+		sunxi_dma_memcpy(riscv_seg_dst(phdr) + (start - phdr->p_offset),
+				 src + (start - pos), end - start);
+	}
+#if defined(CONFIG_SUNXI_VERIFY_RISCV) && defined(CONFIG_SUNXI_IMAGE_HEADER)
+	riscv_stream_keep(s, src, pos, len);
+#endif
+}
+
+/*
+ * parse the first chunk, already in s->buf: the sunxi image header, the
+ * elf headers and the signed range. segments are checked against the
+ * reserved-memory and, on a secure boot, against the signed range.
+ */
+static int riscv_stream_open(struct riscv_stream *s)
+{
+	u32 elf_len = s->part_len;
+	Elf32_Phdr *phdr;
+	u32 end = 0;
+	int i;
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+	sunxi_image_header_t *ih = (sunxi_image_header_t *)s->buf;
+
+	if (ih->ih_magic != SUNXI_IH_MAGIC || ih->ih_hsize >= s->pos ||
+	    ih->ih_psize > s->part_len - ih->ih_hsize ||
+	    ih->ih_tsize > s->part_len - ih->ih_hsize - ih->ih_psize) {
+		pr_err("riscv: no sunxi image header found\n");
+		return -1;
+	}
+	s->base = ih->ih_hsize;
+	elf_len = ih->ih_psize;
+#endif
+
+	if (riscv_elf_parse(s, s->buf + s->base, s->pos - s->base))
+		return -1;
+
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+	if (gd->securemode) {
+		if (riscv_hash_starts(s))
+			return -1;
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+		/* header and payload now, the tlv head and key at the end */
+		s->hash_len = ih->ih_hsize + ih->ih_psize;
+		s->tlv_off = s->hash_len;
+		s->tlv_len = ih->ih_tsize;
+		s->tlv = malloc(s->tlv_len);
+		if (!s->tlv)
+			return -1;
+		s->end = s->tlv_off + s->tlv_len;
+#else
+		if (riscv_rtos_image_len(s, s->buf, s->pos, &s->hash_len))
+			return -1;
+		/* nothing outside the signed range gets loaded */
+		elf_len = s->hash_len;
+		s->end = s->hash_len;
+#endif
+	}
+#endif
+
+	if (riscv_seg_check(s, elf_len))
+		return -1;
+
+	/* from here on offsets count from the partition start */
+	for (i = 0, phdr = s->phdr; i < s->phnum; i++, phdr++) {
+		if (phdr->p_type != PT_LOAD)
+			continue;
+		phdr->p_offset += s->base;
+		end = max(end, phdr->p_offset + phdr->p_filesz);
+	}
+	s->img_len = end;
+	s->end = max(s->end, s->img_len);
+
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+	if (riscv_stream_hash(s, s->buf, 0, s->pos))
+		return -1;
+#endif
+	riscv_stream_place(s, s->buf, 0, min(s->pos, s->end));
+
+	return 0;
+}
+
+static int riscv_stream_load(struct riscv_stream *s)
+{
+	Elf32_Phdr *phdr;
+	u8 *dst;
+	u32 len;
+
+	while (s->pos < s->end) {
+		phdr = riscv_stream_seg(s, s->pos);
+		if (phdr) {
+			dst = riscv_seg_dst(phdr) + (s->pos - phdr->p_offset);
+			len = ROUND_DOWN(phdr->p_offset + phdr->p_filesz - s->pos,
+					 RISCV_SECTOR_SIZE);
+			len = min(len, (u32)RISCV_STREAM_CHUNK);
+			/* flash drivers may dma into dst, keep whole lines */
+			if (len && !((ulong)dst & (CONFIG_SYS_CACHELINE_SIZE - 1))) {
+				if (riscv_stream_read(s, dst, len) < 0)
+					return -1;
+				continue;
+			}
+		}
+
+		len = min((u32)RISCV_STREAM_CHUNK,
+			  ROUND_UP(s->end - s->pos, RISCV_SECTOR_SIZE));
+		if (riscv_stream_read(s, s->buf, len) < 0)
+			return -1;
+		riscv_stream_place(s, s->buf, s->pos - len,
+				   min(len, s->end - (s->pos - len)));
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+/* check the digest of everything streamed against the signature */
+static int riscv_stream_verify(struct riscv_stream *s, u32 riscv_id)
+{
+	u8 hash[SHA256_SUM_LEN];
+	void *tlv = NULL;
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+	sunxi_tlv_header_t *th = (sunxi_tlv_header_t *)s->tlv;
+	u32 key_len, sign_len;
+#endif
+
+	if (!s->hash_len)
+		return 0;
+
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+	/* the signature covers the tlv head and the public key too */
+	if (s->tlv_len < sizeof(*th) || sunxi_tlv_header_check(th))
+		goto err;
+	/* what sunxi_image_verify_tlv() reads behind the tlv head */
+	key_len = th->th_pkey_type == PKEY_TYPE_RSA ? 512 : 64;
+	sign_len = th->th_pkey_type == PKEY_TYPE_RSA ? 256 : 64;
+	if (th->th_size > s->tlv_len ||
+	    key_len > s->tlv_len - th->th_size ||
+	    th->th_pkey_size > s->tlv_len - th->th_size - sign_len)
+		goto err;
+	if (riscv_hash_update(s, s->tlv, th->th_size + th->th_pkey_size))
+		return -1;
+	tlv = s->tlv;
+#endif
+	if (riscv_hash_finish(s, hash))
+		return -1;
+
+	return sunxi_verify_riscv_hash(hash, tlv, riscv_id);
+#ifdef CONFIG_SUNXI_IMAGE_HEADER
+err:
+	pr_err("riscv: bad tlv area\n");
+	return -1;
+#endif
+}
+#endif
+
+static void riscv_stream_finish(struct riscv_stream *s, u32 riscv_id)
+{
+	Elf32_Phdr *phdr;
+	u8 *dst;
+	int i;
+
+	for (i = 0, phdr = s->phdr; i < s->phnum; i++, phdr++) {
+		if (phdr->p_type != PT_LOAD)
+			continue;
+		dst = riscv_seg_dst(phdr);
+		if (phdr->p_filesz != phdr->p_memsz)
+			sunxi_dma_memset(dst + phdr->p_filesz, 0x00,
+					 phdr->p_memsz - phdr->p_filesz);
+		if (i == 0)
+			show_img_version((char *)dst + 896, riscv_id);
+		flush_cache(ROUND_DOWN_CACHE((unsigned long)dst),
+			    ROUND_UP_CACHE(phdr->p_memsz +
+					   ((unsigned long)dst & (CONFIG_SYS_CACHELINE_SIZE - 1))));
+	}
+}
+
+int sunxi_riscv_boot_part(const char *part_name, u32 run_ddr, u32 riscv_id)
+{
+	struct riscv_stream s;
+	u32 part_size;
+	ulong start = get_timer(0);
+	int ret = -1;
+
+	memset(&s, 0, sizeof(s));
+	if (sunxi_partition_get_info_byname(part_name, &s.part_start,
+					    &part_size)) {
+		pr_err("riscv: partition %s not found\n", part_name);
+		return -1;
+	}
+	s.part_len = part_size * RISCV_SECTOR_SIZE;
+
+	if (dts_get_riscv_memory(&s.mem_start, &s.mem_size, riscv_id))
+		return -1;
+
+	s.buf = malloc_align(RISCV_STREAM_CHUNK, CONFIG_SYS_CACHELINE_SIZE);
+	if (!s.buf)
+		return -1;
+
+	if (riscv_stream_read(&s, s.buf, min(s.part_len, (u32)RISCV_STREAM_CHUNK)))
+		goto out;
+
+	if (riscv_stream_open(&s) || riscv_stream_load(&s))
+		goto out;
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+	if (riscv_stream_verify(&s, riscv_id) < 0) {
+		pr_err("riscv%d: %s verify failed, core kept in reset\n",
+		       riscv_id, part_name);
+		goto out;
+	}
+#endif
+
+	riscv_stream_finish(&s, riscv_id);
+	if (!run_ddr)
+		run_ddr = s.entry;
+	riscv_release(run_ddr, riscv_id);
+	printf("riscv%d: %s loaded (%u bytes), released after %lu ms\n",
+	       riscv_id, part_name, s.img_len - s.base, get_timer(start));
+	ret = 0;
+out:
+#if defined(CONFIG_SUNXI_VERIFY_RISCV) && defined(CONFIG_SUNXI_CE_HASH_STREAM)
+	if (s.ce) {
+		/* a failed load can leave a task running on the context */
+		sunxi_ce_hash_wait(s.ce);
+		free_align(s.ce);
+	}
+#endif
+#if defined(CONFIG_SUNXI_VERIFY_RISCV) && defined(CONFIG_SUNXI_IMAGE_HEADER)
+	free(s.tlv);
+#endif
+	free(s.phdr);
+	free_align(s.buf);
+
+	return ret;
+}
@@ -223,6 +223,10 @@ struct sunxi_spi_slave {
 
 struct sunxi_spi_slave *get_sspi(void);
 void sunxi_update_right_delay_para(struct mtd_info *mtd);
+void spi_samp_fill_pattern(u8 *buf);
+int sunxi_spi_read_start(struct spi_slave *slave, const u8 *cmd, int cmd_len,
+			 u8 *buf, u32 len);
+int sunxi_spi_read_finish(struct spi_slave *slave, u8 *buf, u32 len);
 int sunxi_set_right_delay_para(struct mtd_info *mtd);
 
 #endif
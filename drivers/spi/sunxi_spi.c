@@ -1061,9 +1061,9 @@ int spi_init(void)
 	return 0;
 }
 
-void spi_init_clk(struct spi_slave *slave)
+/* spi-max-frequency from the device tree, or the probe speed */
+static u32 spi_dt_max_hz(struct sunxi_spi_slave *sunxi_slave)
 {
-	struct sunxi_spi_slave *sunxi_slave = to_sunxi_slave(slave);
 	int ret = 0, nodeoffset = 0;
 	u32 rval = 0;
 
@@ -1076,9 +1076,18 @@ void spi_init_clk(struct spi_slave *slave)
 		if (ret < 0) {
 			SPI_INF("get spi-max-frequency fail %d\n", ret);
 		} else
-			sunxi_slave->max_hz = rval;
+			return rval;
 	}
 
+	return sunxi_slave->max_hz;
+}
+
+void spi_init_clk(struct spi_slave *slave)
+{
+	struct sunxi_spi_slave *sunxi_slave = to_sunxi_slave(slave);
+
+	sunxi_slave->max_hz = spi_dt_max_hz(sunxi_slave);
+
 	pr_force("spi sunxi_slave->max_hz:%d \n", sunxi_slave->max_hz);
 	/* clock */
 	if (sunxi_spi_clk_init(0, sunxi_slave->max_hz))
@@ -1209,6 +1218,246 @@ void spi_release_bus(struct spi_slave *slave)
 
 }
 
+#if defined(CONFIG_SPI_SAMP_DL_EN) && defined(CONFIG_SUNXI_SPINOR)
+#define SPI_SAMP_MODE_NUM	(7)
+#define SPI_SAMP_DELAY_NUM	(64)
+#define SPI_SAMP_COARSE_STEP	(8)
+
+extern int update_boot_param(struct spi_nor *flash);
+
+/* what a read with one sample setting must return to be accepted */
+struct spi_samp_ref {
+	loff_t from;
+	int len;
+	int off;
+	const u8 *expect;
+	int expect_len;
+	u8 *buf;
+};
+
+struct spi_samp_win {
+	unsigned int mode;
+	unsigned int start;
+	unsigned int end;
+	unsigned int len;
+};
+
+/*
+ * calibration pattern kept in the boot param region: a byte ramp followed
+ * by its complement, so every data line sees both edges at every bit rate
+ */
+void spi_samp_fill_pattern(u8 *buf)
+{
+	int i;
+
+	for (i = 0; i < SPI_SAMP_PATTERN_LEN; i++)
+		buf[i] = (i & 0x80) ? ~i : i;
+}
+
+static int spi_samp_probe(struct mtd_info *mtd, void __iomem *base_addr,
+			  struct spi_samp_ref *ref, unsigned int sample_delay)
+{
+	size_t retlen;
+	int ok;
+
+	spi_set_sample_delay(base_addr, sample_delay);
+	memset(ref->buf, 0, ref->len);
+	mtd->_read(mtd, ref->from, ref->len, &retlen, ref->buf);
+	ok = !memcmp(ref->buf + ref->off, ref->expect, ref->expect_len);
+	pr_debug("delay:%d [%s]\n", sample_delay, ok ? "OK" : "ERROR");
+
+	return ok;
+}
+
+/*
+ * probe every SPI_SAMP_COARSE_STEP delays, then binary search both edges
+ * of each passing run between its outer failing and inner passing probes
+ */
+static void spi_samp_search_mode(struct mtd_info *mtd,
+				 void __iomem *base_addr,
+				 struct spi_samp_ref *ref, unsigned int mode,
+				 struct spi_samp_win *best)
+{
+	int pass[SPI_SAMP_DELAY_NUM / SPI_SAMP_COARSE_STEP];
+	int n = ARRAY_SIZE(pass);
+	int i, j, lo, hi, mid, start, end;
+
+	spi_set_sample_mode(base_addr, mode);
+	for (i = 0; i < n; i++)
+		pass[i] = spi_samp_probe(mtd, base_addr, ref,
+					 i * SPI_SAMP_COARSE_STEP);
+
+	for (i = 0; i < n; i = j) {
+		if (!pass[i]) {
+			j = i + 1;
+			continue;
+		}
+		for (j = i; j < n && pass[j]; j++)
+			;
+
+		/* first passing delay is in (lo, hi] */
+		lo = i ? (i - 1) * SPI_SAMP_COARSE_STEP : -1;
+		hi = i * SPI_SAMP_COARSE_STEP;
+		while (hi - lo > 1) {
+			mid = (lo + hi) / 2;
+			if (spi_samp_probe(mtd, base_addr, ref, mid))
+				hi = mid;
+			else
+				lo = mid;
+		}
+		start = hi;
+
+		/* last passing delay is in [lo, hi) */
+		lo = (j - 1) * SPI_SAMP_COARSE_STEP;
+		hi = j < n ? j * SPI_SAMP_COARSE_STEP : SPI_SAMP_DELAY_NUM;
+		while (hi - lo > 1) {
+			mid = (lo + hi) / 2;
+			if (spi_samp_probe(mtd, base_addr, ref, mid))
+				lo = mid;
+			else
+				hi = mid;
+		}
+		end = lo;
+
+		pr_debug("mode:%d window %d-%d\n", mode, start, end);
+		if (end - start + 1 > best->len) {
+			best->mode = mode;
+			best->start = start;
+			best->end = end;
+			best->len = end - start + 1;
+		}
+	}
+}
+
+/* full sweep, only for windows too narrow to be hit by the coarse probes */
+static void spi_samp_sweep_mode(struct mtd_info *mtd, void __iomem *base_addr,
+				struct spi_samp_ref *ref, unsigned int mode,
+				struct spi_samp_win *best)
+{
+	unsigned int sample_delay, start = 0, len = 0;
+
+	spi_set_sample_mode(base_addr, mode);
+	for (sample_delay = 0; sample_delay <= SPI_SAMP_DELAY_NUM;
+	     sample_delay++) {
+		if (sample_delay < SPI_SAMP_DELAY_NUM &&
+		    spi_samp_probe(mtd, base_addr, ref, sample_delay)) {
+			if (!len++)
+				start = sample_delay;
+			continue;
+		}
+		if (len > best->len) {
+			best->mode = mode;
+			best->start = start;
+			best->end = start + len - 1;
+			best->len = len;
+		}
+		len = 0;
+	}
+}
+
+static int spi_samp_calibrate(struct mtd_info *mtd, struct spi_samp_ref *ref,
+			      struct spi_samp_win *best)
+{
+	struct spi_nor *nor = mtd->priv;
+	struct sunxi_spi_slave *sspi = to_sunxi_slave(nor->spi);
+	void __iomem *base_addr = (void *)(ulong)sspi->base_addr;
+	unsigned int mode;
+	ulong start = get_timer(0);
+
+	memset(best, 0, sizeof(*best));
+	spi_samp_mode(base_addr, 1);
+	spi_samp_dl_sw_status(base_addr, 1);
+	for (mode = 0; mode < SPI_SAMP_MODE_NUM; mode++)
+		spi_samp_search_mode(mtd, base_addr, ref, mode, best);
+	for (mode = 0; !best->len && mode < SPI_SAMP_MODE_NUM; mode++)
+		spi_samp_sweep_mode(mtd, base_addr, ref, mode, best);
+	pr_info("sample delay calibration: %ld ms\n", get_timer(start));
+
+	return best->len ? 0 : -1;
+}
+
+/* program the centre of the widest window, or the clock based default */
+static void spi_samp_apply(struct sunxi_spi_slave *sspi,
+			   struct spi_samp_win *win)
+{
+	void __iomem *base_addr = (void *)(ulong)sspi->base_addr;
+
+	if (!win->len) {
+		spi_samp_mode(base_addr, 0);
+		spi_samp_dl_sw_status(base_addr, 0);
+		if ((sspi->max_hz / 1000 / 1000) >= 60)
+			sspi->right_sample_mode = 2;
+		else if ((sspi->max_hz / 1000 / 1000) <= 24)
+			sspi->right_sample_mode = 0;
+		else
+			sspi->right_sample_mode = 1;
+	} else {
+		sspi->right_sample_delay = (win->start + win->end) / 2;
+		sspi->right_sample_mode = win->mode;
+		spi_set_sample_delay(base_addr, sspi->right_sample_delay);
+	}
+	pr_info("Sample mode:%d start:%d end:%d right_sample_delay:0x%x\n",
+			win->mode, win->start, win->end,
+			sspi->right_sample_delay);
+	spi_set_sample_mode(base_addr, sspi->right_sample_mode);
+}
+
+/* calibrate against the pattern stored in the boot param region */
+static int spi_samp_calibrate_pattern(struct mtd_info *mtd,
+				      struct spi_samp_win *win)
+{
+	struct spi_samp_ref ref;
+	u8 *expect;
+	int ret = -1;
+
+	expect = malloc(SPI_SAMP_PATTERN_LEN);
+	ref.buf = malloc_align(SPI_SAMP_PATTERN_LEN, 64);
+	if (!expect || !ref.buf)
+		goto out;
+
+	spi_samp_fill_pattern(expect);
+	ref.from = (sunxi_flashmap_offset(FLASHMAP_SPI_NOR, BOOT_PARAM) << 9) +
+		   offsetof(struct sunxi_boot_param_region, spi_samp_pattern);
+	ref.len = SPI_SAMP_PATTERN_LEN;
+	ref.off = 0;
+	ref.expect = expect;
+	ref.expect_len = SPI_SAMP_PATTERN_LEN;
+	ret = spi_samp_calibrate(mtd, &ref, win);
+out:
+	free(expect);
+	if (ref.buf)
+		free_align(ref.buf);
+
+	return ret;
+}
+
+#ifdef CONFIG_SPI_SAMP_DL_READ_ONLY
+/*
+ * read-only calibration for burning: nothing is erased unless the pattern
+ * has never been stored, in which case the boot param region is written
+ * once and the search repeated
+ */
+static int spi_samp_update_read_only(struct mtd_info *mtd)
+{
+	struct spi_nor *nor = mtd->priv;
+	struct sunxi_spi_slave *sspi = to_sunxi_slave(nor->spi);
+	struct spi_samp_win win;
+
+	spi_init_clk(nor->spi);
+	if (spi_samp_calibrate_pattern(mtd, &win)) {
+		pr_info("no sample pattern found, storing it\n");
+		if (update_boot_param(nor))
+			return -1;
+		if (spi_samp_calibrate_pattern(mtd, &win))
+			return -1;
+	}
+	spi_samp_apply(sspi, &win);
+
+	return 0;
+}
+#endif
+#endif
+
 void sunxi_update_right_delay_para(struct mtd_info *mtd)
 {
 	struct spi_nor *nor = mtd->priv;
@@ -1221,6 +1470,12 @@ void sunxi_update_right_delay_para(struct mtd_info *mtd)
 	unsigned int mode = 0, startry_mode = 0, endtry_mode = 6, block = 0;
 	u8 erase_opcode = nor->erase_opcode;
 	uint32_t erasesize = mtd->erasesize;
+
+#ifdef CONFIG_SPI_SAMP_DL_READ_ONLY
+	if (!spi_samp_update_read_only(mtd))
+		return;
+	pr_err("read-only sample delay calibration failed, erase and retry\n");
+#endif
 	if (mtd->size > SZ_16M)
 		nor->erase_opcode = SPINOR_OP_BE_32K_4B;
 	else
@@ -1346,94 +1601,32 @@ void boot_try_delay_param(struct mtd_info *mtd, boot_spinor_info_t *boot_info)
 	struct spi_nor *nor = mtd->priv;
 	struct spi_slave *slave = nor->spi;
 	struct sunxi_spi_slave *sspi = to_sunxi_slave(slave);
-	void __iomem *base_addr = (void *)(ulong)sspi->base_addr;
-	unsigned int sample_delay;
-	unsigned int start_ok = 0, end_ok = 0, len_ok = 0, mode_ok = 0;
-	unsigned int start_backup = 0, end_backup = 0, len_backup = 0;
-	unsigned int mode = 0, startry_mode = 0, endtry_mode = 6;
-	size_t retlen, len = 512;
+	struct spi_samp_ref ref;
+	struct spi_samp_win win;
 	boot0_file_head_t *boot0_head;
-	boot0_head = malloc_align(len, 64);
 
 	/* re-initialize from device tree */
 	spi_init_clk(slave);
 
-	spi_samp_mode(base_addr, 1);
-	spi_samp_dl_sw_status(base_addr, 1);
-	for (mode = startry_mode; mode <= endtry_mode; mode++) {
-		spi_set_sample_mode(base_addr, mode);
-		for (sample_delay = 0; sample_delay < 64; sample_delay++) {
-			spi_set_sample_delay(base_addr, sample_delay);
-			memset(boot0_head, 0, len);
-			mtd->_read(mtd, 0, len, &retlen, (u_char *)boot0_head);
-
-			if (strncmp((char *)boot0_head->boot_head.magic,
-				(char *)BOOT0_MAGIC,
-				sizeof(boot0_head->boot_head.magic)) == 0) {
-				pr_debug("mode:%d delat:%d [OK]\n",
-						mode, sample_delay);
-				if (!len_backup) {
-					start_backup = sample_delay;
-					end_backup = sample_delay;
-				} else
-					end_backup = sample_delay;
-				len_backup++;
-			} else {
-				pr_debug("mode:%d delay:%d [ERROR]\n",
-						mode, sample_delay);
-				if (!start_backup)
-					continue;
-				else {
-					if (len_backup > len_ok) {
-						len_ok = len_backup;
-						start_ok = start_backup;
-						end_ok = end_backup;
-						mode_ok = mode;
-					}
-
-					len_backup = 0;
-					start_backup = 0;
-					end_backup = 0;
-				}
-			}
-		}
-		if (len_backup > len_ok) {
-			len_ok = len_backup;
-			start_ok = start_backup;
-			end_ok = end_backup;
-			mode_ok = mode;
-		}
-		len_backup = 0;
-		start_backup = 0;
-		end_backup = 0;
-	}
-
-	if (!len_ok) {
-		spi_samp_mode(base_addr, 0);
-		spi_samp_dl_sw_status(base_addr, 0);
-		if ((sspi->max_hz / 1000 / 1000) >= 60)
-			sspi->right_sample_mode = 2;
-		else if ((sspi->max_hz / 1000 / 1000) <= 24)
-			sspi->right_sample_mode = 0;
-		else
-			sspi->right_sample_mode = 1;
-	} else {
-		sspi->right_sample_delay = (start_ok + end_ok) / 2;
-		sspi->right_sample_mode = mode_ok;
-		spi_set_sample_delay(base_addr, sspi->right_sample_delay);
+	/* flash burnt before the pattern existed: fall back to boot0 magic */
+	if (spi_samp_calibrate_pattern(mtd, &win)) {
+		boot0_head = malloc_align(512, 64);
+		ref.from = 0;
+		ref.len = 512;
+		ref.off = offsetof(boot0_file_head_t, boot_head.magic);
+		ref.expect = (const u8 *)BOOT0_MAGIC;
+		ref.expect_len = sizeof(boot0_head->boot_head.magic);
+		ref.buf = (u8 *)boot0_head;
+		spi_samp_calibrate(mtd, &ref, &win);
+		free_align(boot0_head);
 	}
-	pr_info("Sample mode:%d start:%d end:%d right_sample_delay:0x%x\n",
-			mode_ok, start_ok, end_ok,
-			sspi->right_sample_delay);
-	spi_set_sample_mode(base_addr, sspi->right_sample_mode);
+	spi_samp_apply(sspi, &win);
 
 	boot_info->sample_delay = sspi->right_sample_delay;
 	boot_info->sample_mode = sspi->right_sample_mode;
-	free_align(boot0_head);
 	return;
 }
 
-extern int update_boot_param(struct spi_nor *flash);
 int sunxi_set_right_delay_para(struct mtd_info *mtd)
 {
 	struct spi_nor *nor = mtd->priv;
@@ -1459,9 +1652,11 @@ int sunxi_set_right_delay_para(struct mtd_info *mtd)
 		boot_try_delay_param(mtd, boot_info);
 		if (update_boot_param(nor))
 			printf("update boot param error\n");
-	}
-
-	if (boot_info->sample_delay == SAMP_MODE_DL_DEFAULT) {
+	} else if (boot_info->sample_delay == SAMP_MODE_DL_DEFAULT ||
+		   boot_info->frequency != spi_dt_max_hz(sspi) ||
+		   memcmp(boot_info->flash_id, nor->info->id,
+			  SPI_NOR_MAX_ID_LEN)) {
+		/* the cached result only holds for this flash at this clock */
 		boot_try_delay_param(mtd, boot_info);
 		if (update_boot_param(nor))
 			printf("update boot param error\n");
@@ -1607,3 +1802,80 @@ int spi_xfer(struct spi_slave *slave, unsigned int bitlen,
 
 	return 0;
 }
+
+#ifdef CONFIG_SUNXI_SPINOR_READAHEAD
+/*
+ * split-phase read for the nor read-ahead: sunxi_spi_read_start() sends
+ * cmd and leaves the dma filling buf, sunxi_spi_read_finish() waits for
+ * it and closes the transfer. nothing else may use the bus in between.
+ * returns -EOPNOTSUPP when rx dma is not allowed, read synchronously then.
+ */
+int sunxi_spi_read_start(struct spi_slave *slave, const u8 *cmd, int cmd_len,
+			 u8 *buf, u32 len)
+{
+	struct sunxi_spi_slave *sspi = to_sunxi_slave(slave);
+	void __iomem *base_addr = (void __iomem *)(unsigned long)sspi->base_addr;
+
+#ifdef SUNXI_DMA_SECURITY
+	/* same rule as sunxi_spi_dma_readl(), which reads by cpu here */
+	if ((get_boot_work_mode() != WORK_MODE_BOOT)
+		&& (sunxi_get_securemode() != SUNXI_NORMAL_MODE))
+		return -EOPNOTSUPP;
+#endif
+	if (spi_claim_bus(slave))
+		return -1;
+
+	spi_disable_irq(0xffffffff, base_addr);
+	spi_clr_irq_pending(0xffffffff, base_addr);
+	sunxi_spi_mode_check(base_addr, cmd_len, len, cmd[0]);
+	spi_ss_level(base_addr, 1);
+	spi_start_xfer(base_addr);
+
+	if (sunxi_spi_cpu_writel(sspi, cmd, cmd_len)) {
+		spi_release_bus(slave);
+		return -1;
+	}
+
+	writel((readl(base_addr + SPI_FIFO_CTL_REG) | SPI_FIFO_CTL_RX_DRQEN),
+	       base_addr + SPI_FIFO_CTL_REG);
+	spi_dma_recv_start(base_addr, 0, buf, len);
+
+	return 0;
+}
+
+int sunxi_spi_read_finish(struct spi_slave *slave, u8 *buf, u32 len)
+{
+	struct sunxi_spi_slave *sspi = to_sunxi_slave(slave);
+	void __iomem *base_addr = (void __iomem *)(unsigned long)sspi->base_addr;
+	ulong ctime = get_timer(0);
+	int timeout = 0xfffff;
+	int ret = 0;
+
+	while (spi_wait_dma_recv_over(0)) {
+		if (get_timer(ctime) > 5000) {
+			printf("rx wait_dma_recv_over fail\n");
+			ret = -1;
+			goto out;
+		}
+	}
+	invalidate_dcache_range((ulong)buf, (ulong)buf + len);
+
+	while (!(spi_qry_irq_pending(base_addr) & SPI_INT_STA_TC)) {
+		if (!--timeout) {
+			printf("SPI_ISR time_out \n");
+			ret = -1;
+			goto out;
+		}
+	}
+	if (spi_qry_irq_pending(base_addr) & SPI_INT_STA_ERR) {
+		printf("int stauts error");
+		ret = -1;
+	}
+out:
+	sunxi_spi_dma_disable(sspi);
+	spi_clr_irq_pending(0xffffffff, base_addr);
+	spi_release_bus(slave);
+
+	return ret;
+}
+#endif
@@ -23,6 +23,9 @@ u32 ss_check_err(u32 task_id);
 #else
 u32 ss_check_err(void);
 #endif
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+int ss_poll_finish(u32 task_id);
+#endif
 void ss_open(void);
 void ss_close(void);
 u32 ss_get_addr_align(void);
@@ -70,6 +70,12 @@ __weak void ss_wait_finish(u32 task_id)
 	}
 }
 
+/* non blocking ss_wait_finish(), 1 once the channel is done or failed */
+__weak int ss_poll_finish(u32 task_id)
+{
+	return (readl(SS_ISR) & (0x3 << task_id * 2)) ? 1 : 0;
+}
+
 __weak u32 ss_pending_clear(u32 task_id)
 {
 	u32 reg_val;
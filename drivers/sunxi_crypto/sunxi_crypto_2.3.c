@@ -12,6 +12,8 @@
 #include <memalign.h>
 #include "ss_op.h"
 #include <sunxi_board.h>
+#include <malloc.h>
+#include <u-boot/sha256.h>
 
 #define ALG_SHA256 (0x13)
 #define ALG_SHA512 (0x15)
@@ -164,7 +166,7 @@ int sunxi_hash_test(u8 *dst_addr, u32 dst_len, u8 *src_addr, u32 src_len, u32 sh
 	return 0;
 }
 
-int sunxi_sha_calc(u8 *dst_addr, u32 dst_len, u8 *src_addr, u32 src_len)
+int sunxi_sha_calc_ce(u8 *dst_addr, u32 dst_len, u8 *src_addr, u32 src_len)
 {
 	u32 total_bit_len					     = 0;
 	struct hash_task_descriptor task0 __aligned(CACHE_LINE_SIZE) = { 0 };
@@ -208,6 +210,288 @@ int sunxi_sha_calc(u8 *dst_addr, u32 dst_len, u8 *src_addr, u32 src_len)
 	return 0;
 }
 
+#ifdef CONFIG_SUNXI_CE_SHA_DISPATCH
+#define SHA_CALIBRATE_MAX	(16 * 1024)
+#define SHA_CALIBRATE_LOOPS	4
+
+/* inputs up to this many bytes are hashed by the cpu */
+static u32 sha_cpu_max = CONFIG_SUNXI_CE_SHA_CPU_MAX;
+
+/*
+ * find the largest power of two size at which the cpu still beats the ce,
+ * descriptor setup and cache maintenance included, and use it from now
+ * on. never called on the boot path, "sunxi_ce_test bench" runs it and
+ * prints the value for SUNXI_CE_SHA_CPU_MAX. without memory for the test
+ * buffer the current value stays.
+ */
+u32 sunxi_sha_calibrate(void)
+{
+	u8 md[32];
+	u8 *buf;
+	ulong start, ce_us, cpu_us;
+	u32 len;
+	int i;
+
+	buf = memalign(CACHE_LINE_SIZE, SHA_CALIBRATE_MAX);
+	if (!buf)
+		return sha_cpu_max;
+	sha_cpu_max = 0;
+	memset(buf, 0x5a, SHA_CALIBRATE_MAX);
+
+	for (len = 64; len <= SHA_CALIBRATE_MAX; len <<= 1) {
+		start = timer_get_us();
+		for (i = 0; i < SHA_CALIBRATE_LOOPS; i++)
+			sunxi_sha_calc_ce(md, sizeof(md), buf, len);
+		ce_us = timer_get_us() - start;
+
+		start = timer_get_us();
+		for (i = 0; i < SHA_CALIBRATE_LOOPS; i++)
+			sha256_csum_wd(buf, len, md, CHUNKSZ_SHA256);
+		cpu_us = timer_get_us() - start;
+
+		if (cpu_us > ce_us)
+			break;
+		sha_cpu_max = len;
+	}
+	free(buf);
+
+	return sha_cpu_max;
+}
+#endif
+
+int sunxi_sha_calc(u8 *dst_addr, u32 dst_len, u8 *src_addr, u32 src_len)
+{
+#ifdef CONFIG_SUNXI_CE_SHA_DISPATCH
+	if (src_len <= sha_cpu_max) {
+		sha256_csum_wd(src_addr, src_len, dst_addr, CHUNKSZ_SHA256);
+		return 0;
+	}
+#endif
+
+	return sunxi_sha_calc_ce(dst_addr, dst_len, src_addr, src_len);
+}
+
+#ifdef CONFIG_SUNXI_CE_HASH_STREAM
+/*
+ * incremental hashing. every update becomes one task holding the tail
+ * left over by the previous update and the caller's scatter list, cut
+ * down to whole blocks; the hash state of the previous task goes in as
+ * iv. only the final task is marked as last package and gets padded.
+ */
+static void hash_put_addr(u8 *field, const void *addr)
+{
+	u32 val = (u32)(ulong)addr;
+
+	memcpy(field, &val, 4);
+	field[4] = 0;
+}
+
+int sunxi_ce_hash_init(struct sunxi_ce_hash_ctx *ctx, u32 type)
+{
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->type = type;
+	switch (type) {
+	case SUNXI_MD5:
+		ctx->block   = 64;
+		ctx->md_size = 16;
+		break;
+	case SUNXI_SHA1:
+		ctx->block   = 64;
+		ctx->md_size = 20;
+		break;
+	case SUNXI_SHA256:
+	case SUNXI_SM3:
+		ctx->block   = 64;
+		ctx->md_size = 32;
+		break;
+	case SUNXI_SHA512:
+		ctx->block   = 128;
+		ctx->md_size = 64;
+		break;
+	default:
+		printf("SS %s: hash type %d not supported\n", __func__, type);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void hash_start(struct sunxi_ce_hash_ctx *ctx, int last)
+{
+	struct hash_task_descriptor *task = &ctx->task;
+	u64 total_bit_len = ctx->total << 3;
+
+	task->ctrl = (CHANNEL_0 << CHN) | (last << LPKG) | (0x0 << DLAV) |
+		     (0x1 << IE);
+	task->cmd = ctx->type << 0;
+	if (ctx->chained) {
+		memcpy(ctx->iv, ctx->state, ctx->md_size);
+		task->ctrl |= 0x1 << IVE;
+		hash_put_addr(task->iv_addr, ctx->iv);
+		flush_cache((ulong)ctx->iv, CACHE_LINE_SIZE);
+	}
+	memcpy(task->data_toal_len_addr, &total_bit_len, 5);
+	hash_put_addr(task->sg[0].dest_addr, ctx->state);
+
+	flush_cache((ulong)task, sizeof(*task));
+	flush_cache((ulong)ctx->state, CACHE_LINE_SIZE);
+
+	ss_set_drq((u32)(ulong)task);
+	ss_irq_enable(CHANNEL_0);
+	ss_ctrl_start(HASH_RBG_TRPE);
+	ctx->busy = 1;
+}
+
+int sunxi_ce_hash_poll(struct sunxi_ce_hash_ctx *ctx)
+{
+	u32 err;
+
+	if (!ctx->busy)
+		return 0;
+	if (!ss_poll_finish(CHANNEL_0))
+		return 1;
+
+	ss_pending_clear(CHANNEL_0);
+	ss_ctrl_stop();
+	ss_irq_disable(CHANNEL_0);
+	ss_set_drq(0);
+	ctx->busy = 0;
+
+	err = ss_check_err(CHANNEL_0);
+	if (err) {
+		printf("SS %s fail 0x%x\n", __func__, err);
+		return -1;
+	}
+
+	invalidate_dcache_range((ulong)ctx->state,
+				(ulong)ctx->state + CACHE_LINE_SIZE);
+	ctx->chained = 1;
+
+	return 0;
+}
+
+int sunxi_ce_hash_wait(struct sunxi_ce_hash_ctx *ctx)
+{
+	int ret;
+
+	while ((ret = sunxi_ce_hash_poll(ctx)) > 0)
+		;
+
+	return ret;
+}
+
+int sunxi_ce_hash_update_async(struct sunxi_ce_hash_ctx *ctx,
+			       const struct sunxi_ce_hash_sg *sg, int nents)
+{
+	struct hash_task_descriptor *task = &ctx->task;
+	u8 *next_tail = ctx->tail[!ctx->cur];
+	u64 pending = ctx->tail_len;
+	u32 whole, take, rest = 0;
+	int i, n = 0;
+
+	if (nents > SUNXI_HASH_SG_MAX)
+		return -1;
+	if (sunxi_ce_hash_wait(ctx))
+		return -1;
+
+	for (i = 0; i < nents; i++)
+		pending += sg[i].len;
+	whole = pending - pending % ctx->block;
+	/*
+	 * the engine only pads a last package that carries data, so a
+	 * message ending on a block boundary keeps its last block back
+	 * for sunxi_ce_hash_final()
+	 */
+	if (whole == pending)
+		whole -= ctx->block;
+
+	/* not more than one block yet, just collect it */
+	if (!whole) {
+		for (i = 0; i < nents; i++) {
+			memcpy(ctx->tail[ctx->cur] + ctx->tail_len,
+			       sg[i].addr, sg[i].len);
+			ctx->tail_len += sg[i].len;
+		}
+		return 0;
+	}
+
+	memset(task, 0, sizeof(*task));
+	if (ctx->tail_len) {
+		hash_put_addr(task->sg[0].source_addr, ctx->tail[ctx->cur]);
+		task->sg[0].source_len = ctx->tail_len;
+		flush_cache((ulong)ctx->tail[ctx->cur], SUNXI_HASH_BLOCK_MAX);
+		n = 1;
+	}
+	ctx->total += whole;
+	whole -= ctx->tail_len;
+
+	for (i = 0; i < nents; i++) {
+		take = min(whole, sg[i].len);
+		if (take) {
+			hash_put_addr(task->sg[n].source_addr, sg[i].addr);
+			task->sg[n].source_len = take;
+			flush_cache(round_down((ulong)sg[i].addr,
+					       CACHE_LINE_SIZE),
+				    round_up((ulong)sg[i].addr + take,
+					     CACHE_LINE_SIZE) -
+				    round_down((ulong)sg[i].addr,
+					       CACHE_LINE_SIZE));
+			n++;
+			whole -= take;
+		}
+		/* whatever is short of a block waits for the next task */
+		memcpy(next_tail + rest, (u8 *)sg[i].addr + take,
+		       sg[i].len - take);
+		rest += sg[i].len - take;
+	}
+	task->sg[0].dest_len = ctx->md_size;
+
+	ctx->cur = !ctx->cur;
+	ctx->tail_len = rest;
+	hash_start(ctx, 0);
+
+	return 0;
+}
+
+int sunxi_ce_hash_update(struct sunxi_ce_hash_ctx *ctx, void *buf, u32 len)
+{
+	struct sunxi_ce_hash_sg sg = { buf, len };
+
+	if (sunxi_ce_hash_update_async(ctx, &sg, 1))
+		return -1;
+
+	return sunxi_ce_hash_wait(ctx);
+}
+
+int sunxi_ce_hash_final(struct sunxi_ce_hash_ctx *ctx, u8 *dst)
+{
+	struct hash_task_descriptor *task = &ctx->task;
+
+	if (sunxi_ce_hash_wait(ctx))
+		return -1;
+	if (!ctx->tail_len) {
+		printf("SS %s: empty message\n", __func__);
+		return -1;
+	}
+
+	memset(task, 0, sizeof(*task));
+	hash_put_addr(task->sg[0].source_addr, ctx->tail[ctx->cur]);
+	task->sg[0].source_len = ctx->tail_len;
+	task->sg[0].dest_len = ctx->md_size;
+	flush_cache((ulong)ctx->tail[ctx->cur], SUNXI_HASH_BLOCK_MAX);
+	ctx->total += ctx->tail_len;
+	ctx->tail_len = 0;
+
+	hash_start(ctx, 1);
+	if (sunxi_ce_hash_wait(ctx))
+		return -1;
+
+	memcpy(dst, ctx->state, ctx->md_size);
+
+	return 0;
+}
+#endif
+
 s32 sm2_crypto_gen_cxy_kxy(struct sunxi_sm2_ctx_t *sm2_ctx)
 {
 	struct other_task_descriptor task0 __aligned(CACHE_LINE_SIZE) = { 0 };
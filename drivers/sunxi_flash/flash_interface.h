@@ -36,6 +36,9 @@ typedef struct _sunxi_flash_desc {
 	int (*write_end) (void);
 	int (*erase_area)(uint start_bloca, uint nblock);
 	int (*update_backup_boot0)(void);
+	/* small writes that may be held back and grouped, optional */
+	int (*write_packed)(uint start_block, uint nblock, void *buffer);
+	int (*flush_packed)(void);
 
 }sunxi_flash_desc;
 
@@ -230,9 +230,24 @@ static int sunxi_sprite_mmc_erase(int erase, void *mbr_buffer)
 	return card_erase(erase, mbr_buffer);
 }
 
+#ifdef CONFIG_MMC_SUNXI_PACKED_WRITE
+static int sunxi_sprite_mmc_write_packed(unsigned int start_block,
+					 unsigned int nblock, void *buffer)
+{
+	return mmc_packed_write(mmc_sprite, start_block +
+		sunxi_flashmap_logical_offset(FLASHMAP_SDMMC, LINUX_LOGIC_OFFSET),
+		nblock, buffer);
+}
+
+static int sunxi_sprite_mmc_flush_packed(void)
+{
+	return mmc_packed_flush(mmc_sprite);
+}
+#endif
+
 int sunxi_sprite_mmc_flush(void)
 {
-	return 0;
+	return mmc_packed_flush(mmc_sprite);
 }
 
 static uint sunxi_sprite_mmc_size(void)
@@ -394,6 +409,17 @@ OUT:
 	return ret;
 }
 
+/* a key item is either the old or the new one after a power cut */
+static ulong mmc_secure_write(struct mmc *mmc, uint start, uint nblock,
+			      void *buf)
+{
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+	return mmc_write_reliable(mmc, start, nblock, buf);
+#else
+	return mmc->block_dev.block_write(&mmc->block_dev, start, nblock, buf);
+#endif
+}
+
 int sunxi_flash_mmc_secwrite(int item, unsigned char *buf, unsigned int nblock)
 {
 	int ret = 0;
@@ -415,7 +441,7 @@ int sunxi_flash_mmc_secwrite(int item, unsigned char *buf, unsigned int nblock)
 		goto OUT;
 	}
 
-	if (mmc_boot->block_dev.block_write(&mmc_boot->block_dev,
+	if (mmc_secure_write(mmc_boot,
 		sunxi_flashmap_offset(FLASHMAP_SDMMC, SEC_STORAGE) + SDMMC_ITEM_SIZE * 2 * item,
 		nblock, buf) != nblock) {
 		printf("write first backup failed in fun %s line %d\n", __FUNCTION__, __LINE__);
@@ -423,7 +449,7 @@ int sunxi_flash_mmc_secwrite(int item, unsigned char *buf, unsigned int nblock)
 		goto OUT;
 	}
 
-	if (mmc_boot->block_dev.block_write(&mmc_boot->block_dev,
+	if (mmc_secure_write(mmc_boot,
 		sunxi_flashmap_offset(FLASHMAP_SDMMC, SEC_STORAGE) + SDMMC_ITEM_SIZE * 2 * item + SDMMC_ITEM_SIZE,
 		nblock, buf) != nblock) {
 		printf("write second backup failed in fun %s line %d\n", __FUNCTION__, __LINE__);
@@ -525,7 +551,7 @@ int sunxi_sprite_mmc_secwrite(int item, unsigned char *buf, unsigned int nblock)
 		goto OUT;
 	}
 
-	if (mmc_sprite->block_dev.block_write(&mmc_sprite->block_dev,
+	if (mmc_secure_write(mmc_sprite,
 		sunxi_flashmap_offset(FLASHMAP_SDMMC, SEC_STORAGE) + SDMMC_ITEM_SIZE * 2 * item,
 		nblock, buf) != nblock) {
 		printf("write first backup failed in fun %s line %d\n", __FUNCTION__, __LINE__);
@@ -533,7 +559,7 @@ int sunxi_sprite_mmc_secwrite(int item, unsigned char *buf, unsigned int nblock)
 		goto OUT;
 	}
 
-	if (mmc_sprite->block_dev.block_write(&mmc_sprite->block_dev,
+	if (mmc_secure_write(mmc_sprite,
 		sunxi_flashmap_offset(FLASHMAP_SDMMC, SEC_STORAGE) + SDMMC_ITEM_SIZE * 2 * item + SDMMC_ITEM_SIZE,
 		nblock, buf) != nblock) {
 		printf("write second backup failed in fun %s line %d\n", __FUNCTION__, __LINE__);
@@ -767,6 +793,10 @@ sunxi_flash_desc sunxi_sdmmcs_desc = {
     .phyerase = sunxi_sprite_mmc_phyerase,
     .download_spl = sunxi_sprite_mmc_download_spl,
     .download_toc = sunxi_sprite_mmc_download_toc,
+#ifdef CONFIG_MMC_SUNXI_PACKED_WRITE
+    .write_packed = sunxi_sprite_mmc_write_packed,
+    .flush_packed = sunxi_sprite_mmc_flush_packed,
+#endif
 };
 
 //-----------------------------------end
@@ -202,6 +202,146 @@ sunxi_flash_spinor_phyread(uint start_block, uint nblock, void *buffer)
 	return _sunxi_flash_spinor_read(start_block, nblock, buffer);
 }
 
+#ifdef CONFIG_SUNXI_SPINOR_READAHEAD
+#define SPINOR_RA_CHUNK		CONFIG_SUNXI_SPINOR_READAHEAD_CHUNK
+
+/* opcode, address and dummy bytes of a read at offset */
+static int spinor_ra_cmd(u8 *cmd, u32 offset)
+{
+	int i, len = 0;
+
+	cmd[len++] = flash->read_opcode;
+	for (i = flash->addr_width - 1; i >= 0; i--)
+		cmd[len++] = offset >> (8 * i);
+	for (i = 0; i < flash->read_dummy / 8; i++)
+		cmd[len++] = 0xff;
+
+	return len;
+}
+
+/*
+ * the split-phase path sends everything but the data on one line, which
+ * covers 1-1-1, 1-1-2 and 1-1-4 reads. anything else is read in place.
+ */
+static int spinor_ra_supported(void)
+{
+	return spi_nor_get_protocol_inst_nbits(flash->read_proto) == 1 &&
+	       spi_nor_get_protocol_addr_nbits(flash->read_proto) == 1;
+}
+
+/*
+ * start reading the next chunk into buf, or read it right away when the
+ * protocol cannot be split or the spi may not use dma, which clears
+ * *async. returns its length, 0 at the end, -1 on error
+ */
+static int spinor_ra_queue(u8 *buf, u32 *offset, u32 end, int *async)
+{
+	u8 cmd[16];
+	u32 len = min(end - *offset, (u32)SPINOR_RA_CHUNK);
+	int cmd_len, ret = -EOPNOTSUPP;
+
+	if (!len)
+		return 0;
+	if (*async) {
+		cmd_len = spinor_ra_cmd(cmd, *offset);
+		ret = sunxi_spi_read_start(flash->spi, cmd, cmd_len, buf, len);
+		if (ret == -EOPNOTSUPP)
+			*async = 0;
+	}
+	if (ret == -EOPNOTSUPP)
+		ret = spi_flash_read(flash, *offset, len, buf);
+	if (ret)
+		return -1;
+	*offset += len;
+
+	return len;
+}
+
+/*
+ * read [start_block, start_block + nblock) in chunks and hand each one
+ * to cb() while the dma is already filling the other buffer. cb() must
+ * not access the nor itself; a non zero return stops the stream.
+ */
+int sunxi_spinor_read_stream(uint start_block, uint nblock,
+			     sunxi_flash_stream_cb cb, void *priv,
+			     struct sunxi_flash_stream_stat *stat)
+{
+	struct sunxi_flash_stream_stat st;
+	u8 *buf[2] = { NULL, NULL };
+	int len[2] = { 0, 0 };
+	u32 offset, end;
+	ulong start, t;
+	int cur = 0, async, ret = -1;
+
+	if (!flash)
+		return -1;
+
+	offset = (sunxi_flashmap_logical_offset(FLASHMAP_SPI_NOR,
+#ifdef CONFIG_SUNXI_RTOS
+						RTOS_LOGIC_OFFSET
+#else
+						LINUX_LOGIC_OFFSET
+#endif
+						) + start_block) * 512;
+	end = offset + nblock * 512;
+	if (end > flash->size) {
+		printf("ERROR: attempting read past flash size \n");
+		return -1;
+	}
+
+	memset(&st, 0, sizeof(st));
+	st.bus_hz = get_sspi()->max_hz;
+	st.buswidth = spi_nor_get_protocol_data_nbits(flash->read_proto);
+	async = spinor_ra_supported();
+
+	buf[0] = malloc_align(SPINOR_RA_CHUNK, 64);
+	buf[1] = malloc_align(SPINOR_RA_CHUNK, 64);
+	if (!buf[0] || !buf[1])
+		goto out;
+
+	start = timer_get_us();
+	len[cur] = spinor_ra_queue(buf[cur], &offset, end, &async);
+	while (len[cur]) {
+		if (len[cur] < 0)
+			goto out;
+		if (async) {
+			t = timer_get_us();
+			if (sunxi_spi_read_finish(flash->spi, buf[cur],
+						  len[cur]))
+				goto out;
+			st.wait_us += timer_get_us() - t;
+		}
+
+		/* keep the bus busy while the chunk is consumed */
+		len[!cur] = spinor_ra_queue(buf[!cur], &offset, end, &async);
+
+		t = timer_get_us();
+		ret = cb(priv, buf[cur], len[cur]);
+		st.cb_us += timer_get_us() - t;
+		st.bytes += len[cur];
+		if (ret) {
+			if (async && len[!cur] > 0)
+				sunxi_spi_read_finish(flash->spi, buf[!cur],
+						      len[!cur]);
+			goto out;
+		}
+		ret = -1;
+		cur = !cur;
+	}
+	st.total_us = timer_get_us() - start;
+	ret = 0;
+out:
+	if (stat)
+		*stat = st;
+	if (buf[1])
+		free_align(buf[1]);
+	if (buf[0])
+		free_align(buf[0]);
+
+	return ret;
+}
+#endif
+
 
 
 static int
@@ -354,7 +494,13 @@ sunxi_flash_spinor_erase_area(uint start_block, uint nblock)
 		return -1;
 
 	/*section to byte*/
-	offset = (start_block + sunxi_flashmap_logical_offset(FLASHMAP_SPI_NOR, LINUX_LOGIC_OFFSET)) * 512;
+	offset = (start_block + sunxi_flashmap_logical_offset(FLASHMAP_SPI_NOR,
+#ifdef CONFIG_SUNXI_RTOS
+							       RTOS_LOGIC_OFFSET
+#else
+							       LINUX_LOGIC_OFFSET
+#endif
+							       )) * 512;
 	size   = nblock * 512;
 
 	sector_cnt = size/flash->sector_size;
@@ -371,6 +517,12 @@ sunxi_flash_spinor_erase_area(uint start_block, uint nblock)
 	return 0;
 }
 
+/* erase sector size in 512 byte blocks, 0 without a nor */
+uint sunxi_spinor_sector_blocks(void)
+{
+	return flash ? flash->sector_size / 512 : 0;
+}
+
 static uint
 sunxi_flash_spinor_size(void)
 {
@@ -498,6 +650,10 @@ int update_boot_param(struct spi_nor *nor)
 	boot_info->frequency = sspi->max_hz;
 	boot_info->sample_mode = sspi->right_sample_mode;
 	boot_info->sample_delay = sspi->right_sample_delay;
+	memcpy(boot_info->flash_id, flash->info->id, SPI_NOR_MAX_ID_LEN);
+#if defined(CONFIG_SPI_SAMP_DL_EN) && !defined(CONFIG_SUNXI_SPIF)
+	spi_samp_fill_pattern(boot_param->spi_samp_pattern);
+#endif
 
 	if (flash->read_proto == SNOR_PROTO_1_1_4)
 		boot_info->read_mode = 4;
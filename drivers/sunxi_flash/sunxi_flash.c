@@ -154,6 +154,22 @@ int sunxi_sprite_write(uint start_block, uint nblock, void *buffer)
 	return sprite_flash->write(start_block, nblock, buffer);
 }
 
+int sunxi_sprite_write_packed(uint start_block, uint nblock, void *buffer)
+{
+	if (sprite_flash->write_packed != NULL)
+		return sprite_flash->write_packed(start_block, nblock, buffer);
+
+	return sprite_flash->write(start_block, nblock, buffer);
+}
+
+int sunxi_sprite_flush_packed(void)
+{
+	if (sprite_flash->flush_packed != NULL)
+		return sprite_flash->flush_packed();
+
+	return 0;
+}
+
 int sunxi_sprite_flush(void)
 {
 	return sprite_flash->flush();
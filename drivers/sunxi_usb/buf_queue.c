@@ -231,3 +231,47 @@ int buf_dequeue(buf_element_t* pelement)
     //printf("efex dequeue ok: addr0x%x, sector 0x%x \n",pelement->addr,pelement->sector_num);
     return 0;
 }
+
+/*
+ * look at the pages at the head of the queue without taking them out.
+ * full pages that follow each other in the ring memory and on the flash
+ * come back as one element, so they can go down in one flash write.
+ * the element buffer points into the ring, return the number of pages.
+ */
+int buf_queue_peek(buf_element_t* pelement, int max_pages)
+{
+    buf_node_t *node = buf_queue_head;
+    int pages = 1;
+
+    if(buf_queue_empty()) return 0;
+
+    *pelement = node->element;
+    while(pages < max_pages && pages < buf_queue_current_len)
+    {
+        buf_element_t *cur = &node->element;
+        buf_element_t *next = &node->next->element;
+
+        if(cur->sector_num != (buf_queue_page_size>>9) ||
+           next->buff != cur->buff + buf_queue_page_size ||
+           next->addr != cur->addr + cur->sector_num)
+        {
+            break;
+        }
+        pelement->sector_num += next->sector_num;
+        node = node->next;
+        pages++;
+    }
+
+    return pages;
+}
+
+int buf_queue_drop(int pages)
+{
+    while(pages-- > 0 && !buf_queue_empty())
+    {
+        buf_queue_head = buf_queue_head->next;
+        buf_queue_current_len--;
+    }
+
+    return 0;
+}
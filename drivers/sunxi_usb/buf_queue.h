@@ -23,6 +23,8 @@ int buf_queue_init(void);
 int buf_queue_exit(void);
 int buf_enqueue(buf_element_t* element);
 int buf_dequeue(buf_element_t* element);
+int buf_queue_peek(buf_element_t* element, int max_pages);
+int buf_queue_drop(int pages);
 int buf_queue_empty(void);
 int buf_queue_full(void);
 int buf_queue_free_size(void);
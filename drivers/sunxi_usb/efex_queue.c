@@ -28,11 +28,8 @@
 #include <sunxi_flash.h>
 #include <memalign.h>
 
-buf_element_t      buf_queue_element;
-
 int efex_queue_init(void)
 {
-    int page_size = 0;
     if(buf_queue_init())
     {
         return -1;
@@ -40,82 +37,70 @@ int efex_queue_init(void)
     
    
     //buf_queue_get_page_size() function should be call   after buf_queue_init function
-    page_size = buf_queue_get_page_size();
-    if( page_size == 0)
+    if(buf_queue_get_page_size() == 0)
     {
         printf("efex queue init fail:make sure buf_queue_init function has be called\n");
         return -1;
     }
 
-    //alloc mem for gloab element,    this memory for efex page write
-    memset(&buf_queue_element, 0 , sizeof(buf_element_t));
-    buf_queue_element.buff = malloc_cache_aligned(page_size);
-    if(buf_queue_element.buff == NULL) 
-    {
-        printf("efex_queue_init error: malloc memory size=0x%x fail\n",page_size);
-        return -1;
-    }
-
     return 0;
 
 }
 
 int efex_queue_exit(void)
 {
-    
-    //free global element buff
-    if(buf_queue_element.buff) 
-    {
-        free(buf_queue_element.buff);
-    }
     return buf_queue_exit();
 }
 
-int efex_queue_write_one_page( void )
+//write up to max_pages queued pages straight from the ring, in one flash write
+static int efex_queue_write_pages(int max_pages)
 {
-    if(buf_queue_empty())
+    buf_element_t element;
+    int pages;
+
+    pages = buf_queue_peek(&element, max_pages);
+    if(pages == 0)
     {
-        //printf("efex enqueue empty\n");
         return 0;
     }
-    buf_dequeue(&buf_queue_element);
-    
-    if(!sunxi_flash_write(buf_queue_element.addr, buf_queue_element.sector_num,
-        (void *)buf_queue_element.buff))
+
+    if(!sunxi_flash_write(element.addr, element.sector_num, (void *)element.buff))
     {
-       printf("efex_queue_write_one_page error: write flash from 0x%x, sectors 0x%x failed\n", 
-        buf_queue_element.addr,buf_queue_element.sector_num);
-       return -1;
+        printf("efex_queue_write_pages error: write flash from 0x%x, sectors 0x%x failed\n",
+            element.addr, element.sector_num);
+        buf_queue_drop(pages);
+        return -1;
     }
+    buf_queue_drop(pages);
+
     return 0;
 }
 
+int efex_queue_write_one_page( void )
+{
+    return efex_queue_write_pages(1);
+}
+
+//drain the whole queue, a failed write does not stop the pages behind it
 int efex_queue_write_all_page( void )
 {
-    if(buf_queue_empty())
-    {
-        //printf("efex queue empty\n");
-        return 0;
-    }
-    while(buf_dequeue(&buf_queue_element) == 0)
+    int ret = 0;
+
+    while(!buf_queue_empty())
     {
-        if(!sunxi_flash_write(buf_queue_element.addr, buf_queue_element.sector_num,
-            (void *)buf_queue_element.buff))
+        if(efex_queue_write_pages(INT_MAX))
         {
-            printf("efex_queue_write_one_page error: write flash from 0x%x, sectors 0x%x failed\n", 
-                buf_queue_element.addr,buf_queue_element.sector_num);
-            return -1;
+            ret = -1;
         }
     }
     //printf("write all page done\n");
-    return 0;
+    return ret;
 }
 
 
 int efex_save_buff_to_queue(uint flash_start, uint flash_sectors, void* buff)
 {
     int sec_per_page;     
-    int queue_free_page;
     int offset;
     buf_element_t element;
     int require_page ;
@@ -125,23 +110,24 @@ int efex_save_buff_to_queue(uint flash_start, uint flash_sectors, void* buff)
     sec_per_page     = buf_queue_get_page_size()>>9;
     require_page = (flash_sectors+sec_per_page-1)/sec_per_page;
     
-    queue_free_page   = buf_queue_free_size();
-    if(require_page > queue_free_page) 
+    while(buf_queue_free_size() < require_page && !buf_queue_empty())
     {
-        int i = 0;
-        for(i = 0; i < require_page - queue_free_page; i++)
+        if(efex_queue_write_pages(require_page - buf_queue_free_size()))
         {
-            if(efex_queue_write_one_page())
-            {
-                return -1;
-            }
+            return -1;
         }
     }
 
+    //bigger than the whole queue: it is empty now, so write it in place
     if(buf_queue_free_size() < require_page)
     {
-        printf("efex queue error: free space not enough\n");
-        return -1;
+        if(!sunxi_flash_write(flash_start, flash_sectors, buff))
+        {
+            printf("efex queue error: write flash from 0x%x, sectors 0x%x failed\n",
+                flash_start, flash_sectors);
+            return -1;
+        }
+        return 0;
     }
 
     //save buff to queue
@@ -166,4 +152,3 @@ int efex_save_buff_to_queue(uint flash_start, uint flash_sectors, void* buff)
 
     return 0;
 }
-
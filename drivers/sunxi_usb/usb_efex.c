@@ -36,6 +36,7 @@
 #include <sprite_verify.h>
 #include <asm/arch/timer.h>
 #include <sunxi_flash.h>
+#include <sunxi_dma_memcpy.h>
 #include "usb_efex.h"
 #include "efex_queue.h"
 //#include <sys_config_old.h>
@@ -1781,7 +1782,7 @@ static void dram_data_recv_finish(uint data_type)
 #endif
     else//其它数据，直接写入内存
 	{
-        memcpy((void *)trans_data.dram_trans_buffer, (void *)trans_data.act_recv_buffer, trans_data.recv_size);
+        sunxi_dma_memcpy((void *)trans_data.dram_trans_buffer, (void *)trans_data.act_recv_buffer, trans_data.recv_size);
 
 		sunxi_usb_dbg("SUNXI_EFEX_DRAM_TAG\n");
 
@@ -1896,12 +1897,48 @@ void sunxi_print_efex_app_step(int efex_app_status)
 }
 
 
+#ifdef _EFEX_USE_BUF_QUEUE_
+/*
+ * set when a queued flash write fails, the tool hears about it in the
+ * next status phase
+ */
+static int efex_write_error_flag;
+
+/*
+ * flash downloads are acked once they sit in the queue and programmed
+ * behind the next usb transfers. any other command may look at the
+ * flash or end the session, so the queue is drained before it runs.
+ */
+static void efex_queue_sync(u8 *cmd_buffer)
+{
+	fes_trans_t *trans = (fes_trans_t *)cmd_buffer;
+
+	if (((struct global_cmd_s *)cmd_buffer)->app_cmd == FEX_CMD_fes_down &&
+	    (trans->type & SUNXI_EFEX_DRAM_MASK) != SUNXI_EFEX_DRAM_MASK)
+		return;
+
+	if (efex_queue_write_all_page()) {
+		printf("efex queue error: buf_queue_write_all_page fail\n");
+		efex_write_error_flag = 1;
+		/* FEX_CMD_fes_verify_status reports last_err */
+		trans_data.last_err = -1;
+	}
+}
+
+static void efex_queue_idle(void)
+{
+	if (efex_queue_write_one_page()) {
+		printf("sunxi efex queue: buf_queue_write_one_page() err\n");
+		efex_write_error_flag = 1;
+	}
+}
+#endif
+
 static int sunxi_efex_state_loop(void  *buffer)
 {
 	static struct sunxi_efex_cbw_t  *cbw;
 	static struct sunxi_efex_csw_t   csw;
 	sunxi_ubuf_t *sunxi_ubuf = (sunxi_ubuf_t *)buffer;
-    int  efex_write_error_flag = 0;
 
 	sunxi_print_efex_status(sunxi_usb_efex_status);
 	sunxi_print_efex_app_step(sunxi_usb_efex_app_step);
@@ -1912,6 +1949,12 @@ static int sunxi_efex_state_loop(void  *buffer)
 			{
 				sunxi_usb_efex_status = SUNXI_USB_EFEX_SETUP;
 			}
+#ifdef _EFEX_USE_BUF_QUEUE_
+			else
+			{
+				efex_queue_idle();
+			}
+#endif
 			//when product finish and usb disconnect ,shutdown machine
 			if( sunxi_efex_next_action == SUNXI_UPDATE_NEXT_ACTION_NORMAL ||
 				sunxi_efex_next_action >  SUNXI_UPDATE_NEXT_ACTION_REUPDATE )
@@ -2090,6 +2133,12 @@ static int sunxi_efex_state_loop(void  *buffer)
 
 	  	case SUNXI_USB_EFEX_RECEIVE_DATA:
 
+#ifdef _EFEX_USE_BUF_QUEUE_
+			if(!sunxi_usb_efex_write_enable)
+			{
+				efex_queue_idle();
+			}
+#endif
 			if(sunxi_usb_efex_write_enable == 1)		//数据部分接收完毕
 			{
 				csw.status = 0;
@@ -2107,6 +2156,9 @@ static int sunxi_efex_state_loop(void  *buffer)
 					}
 					else
 					{
+#ifdef _EFEX_USE_BUF_QUEUE_
+						efex_queue_sync(cmd_buf);
+#endif
 						__sunxi_usb_efex_op_cmd(cmd_buf);
 						csw.status = trans_data.last_err;
 					}
@@ -2136,7 +2188,11 @@ static int sunxi_efex_state_loop(void  *buffer)
 						//printf("DISABLE SUNXI MBR : so start of wirte would offset to -16K \n");
 						trans_data.flash_start -= SUNXI_MBR_SIZE / 512 ;
 #endif
+#ifdef _EFEX_USE_BUF_QUEUE_
+						if(efex_save_buff_to_queue(trans_data.flash_start, trans_data.flash_sectors, (void *)trans_data.act_recv_buffer))
+#else
 						if(!sunxi_flash_write(trans_data.flash_start, trans_data.flash_sectors, (void *)trans_data.act_recv_buffer))
+#endif
 						{
 							printf("sunxi usb efex err: write flash from 0x%x, sectors 0x%x failed\n", trans_data.flash_start, trans_data.flash_sectors);
 							csw.status = -1;
@@ -2157,16 +2213,7 @@ static int sunxi_efex_state_loop(void  *buffer)
 
                 memcpy(cmd_buf,sunxi_ubuf->rx_req_buffer,FES_NEW_CMD_LEN);
 #ifdef _EFEX_USE_BUF_QUEUE_
-                //flush queue buff   when verify cmd or flash set off cmd coming
-                if(FEX_CMD_fes_verify_value == ((struct global_cmd_s *)cmd_buf)->app_cmd
-                   ||  FEX_CMD_fes_flash_set_off==  ((struct global_cmd_s *)cmd_buf)->app_cmd )
-                {
-                    if(efex_queue_write_all_page())
-                    {
-                        printf("efex queue error: buf_queue_write_all_page fail\n");
-                        efex_write_error_flag = 1;
-                    }
-                }
+                efex_queue_sync(cmd_buf);
 #endif
                 __sunxi_usb_efex_op_cmd(cmd_buf);
                 csw.status = trans_data.last_err;
@@ -2252,11 +2299,7 @@ static int sunxi_efex_state_loop(void  *buffer)
                 if(!sunxi_usb_efex_write_enable)
                 {
 #ifdef _EFEX_USE_BUF_QUEUE_
-                    if(efex_queue_write_one_page())
-                    {
-                        printf("sunxi efex queue: buf_queue_write_one_page() err\n");
-                        efex_write_error_flag = 1;
-                    }
+                    efex_queue_idle();
 #endif
                     break;
                 }
@@ -2276,6 +2319,10 @@ static int sunxi_efex_state_loop(void  *buffer)
                 else        //表示当前数据需要写入flash
                 {
                     sunxi_usb_dbg("SUNXI_EFEX_FLASH_MASK\n");
+#ifdef CONFIG_DISABLE_SUNXI_PART_DOWNLOAD
+		    //printf("DISABLE SUNXI MBR : so start of wirte would offset to -16K \n");
+		    trans_data.flash_start -= SUNXI_MBR_SIZE / 512 ;
+#endif
 #ifdef _EFEX_USE_BUF_QUEUE_
                     if(0 != efex_save_buff_to_queue(trans_data.flash_start,trans_data.flash_sectors,(void *)trans_data.act_recv_buffer))
                     {
@@ -2284,10 +2331,6 @@ static int sunxi_efex_state_loop(void  *buffer)
                     }
 
 #else
-#ifdef CONFIG_DISABLE_SUNXI_PART_DOWNLOAD
-		    //printf("DISABLE SUNXI MBR : so start of wirte would offset to -16K \n");
-		    trans_data.flash_start -= SUNXI_MBR_SIZE / 512 ;
-#endif
                     if(!sunxi_flash_write(trans_data.flash_start, trans_data.flash_sectors, (void *)trans_data.act_recv_buffer))
                     {
                         printf("sunxi usb efex err: write flash from 0x%x, sectors 0x%x failed\n", trans_data.flash_start, trans_data.flash_sectors);
@@ -2310,11 +2353,14 @@ static int sunxi_efex_state_loop(void  *buffer)
 				sunxi_usb_efex_status = SUNXI_USB_EFEX_IDLE;
 
 				sunxi_ubuf->rx_ready_for_data = 0;
-                                //when call efex queue write error,set stauts to tell usbtools
-                                if(efex_write_error_flag)
-                                {
-                                        csw.status = -1;
-                                }
+#ifdef _EFEX_USE_BUF_QUEUE_
+				//when call efex queue write error,set stauts to tell usbtools
+				if(efex_write_error_flag)
+				{
+					csw.status = -1;
+					efex_write_error_flag = 0;
+				}
+#endif
 				__sunxi_efex_send_status(&csw, sizeof(struct sunxi_efex_csw_t));
 			}
 
@@ -2322,11 +2368,13 @@ static int sunxi_efex_state_loop(void  *buffer)
 
 		case SUNXI_USB_EFEX_EXIT:
 
-                        //when call efex queue write error,set stauts to tell usbtools
-                        if(efex_write_error_flag)
-                        {
-                                csw.status = -1;
-                        }
+#ifdef _EFEX_USE_BUF_QUEUE_
+			//when call efex queue write error,set stauts to tell usbtools
+			if(efex_write_error_flag)
+			{
+				csw.status = -1;
+			}
+#endif
 #if defined(SUNXI_USB_30)
 			if(sunxi_usb_efex_status_enable == 1)
 			{
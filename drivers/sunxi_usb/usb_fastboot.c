@@ -23,6 +23,7 @@
 #include <securestorage.h>
 #include <sunxi_flash.h>
 #include <sprite_verify.h>
+#include <sprite.h>
 #include <private_boot0.h>
 #include "../../sprite/sparse/sparse.h"
 #include <android_misc.h>
@@ -868,6 +869,7 @@ static int __flash_to_part(char *name)
 	u32 nblock = FASTBOOT_TRANSFER_BUFFER_SIZE / 512;
 	char response[68];
 	disk_partition_t info = { 0 };
+	struct sprite_diff_stat diff = { 0 };
 	int ret;
 
 	ret = sunxi_partition_get_info((const char *)name, &info);
@@ -932,7 +934,10 @@ static int __flash_to_part(char *name)
 				return -1;
 			}
 			while (data_sectors >= nblock) {
-				if (!sunxi_flash_write(start, nblock, addr)) {
+				if (!sunxi_sprite_diff_write(sunxi_flash_read,
+							     sunxi_flash_write,
+							     start, nblock,
+							     addr, &diff)) {
 					printf("sunxi fastboot download FAIL: failed to write partition %s \n",
 					       name);
 					sprintf(response,
@@ -949,8 +954,11 @@ static int __flash_to_part(char *name)
 				addr += FASTBOOT_TRANSFER_BUFFER_SIZE;
 			}
 			if (data_sectors) {
-				if (!sunxi_flash_write(start, data_sectors,
-						       addr)) {
+				if (!sunxi_sprite_diff_write(sunxi_flash_read,
+							     sunxi_flash_write,
+							     start,
+							     data_sectors,
+							     addr, &diff)) {
 					printf("sunxi fastboot download FAIL: failed to write partition %s \n",
 					       name);
 					sprintf(response,
@@ -968,6 +976,7 @@ static int __flash_to_part(char *name)
 
 	sunxi_flash_write_end();
 	sunxi_flash_flush();
+	sunxi_sprite_diff_report(name, &diff);
 	printf("sunxi fastboot: successed in downloading partition '%s'\n",
 	       name);
 	sprintf(response, "OKAY");
@@ -17,6 +17,7 @@
 #include <common.h>
 #include <malloc.h>
 #include <grallocator.h>
+#include <sunxi_dma_memcpy.h>
 #include "boot_gui_config.h"
 #include "fb_con.h"
 #include "canvas_utils.h"
@@ -143,6 +144,12 @@ static void update_dirty_rect(framebuffer_t *fb)
 	p_dst = (char *)(fb->buf_list->addr) + offset;
 	p_dst_e = p_dst + stride * (src_dirty->bottom - src_dirty->top);
 
+	/* full width dirty rect is one contiguous block */
+	if (cp_bytes == stride) {
+		sunxi_dma_memcpy((void *)p_dst, (void *)src_addr,
+				 p_dst_e - p_dst);
+		p_dst = p_dst_e;
+	}
 	for (; p_dst != p_dst_e; p_dst += stride) {
 		memcpy((void *)p_dst, (void *)src_addr, cp_bytes);
 		src_addr += stride;
@@ -45,6 +45,51 @@ static void use_sprite_env(void)
 	return;
 }
 
+/*
+ * every part_get_info() reads the partition table back from the flash, so
+ * remember where the env partitions are after the first lookup
+ */
+static struct {
+	char name[PART_NAME_LEN];
+	lbaint_t start;
+	lbaint_t size;
+} env_part_cache[2];
+
+void env_sunxi_flash_forget_partition(void)
+{
+	memset(env_part_cache, 0, sizeof(env_part_cache));
+}
+
+static int env_sunxi_flash_partition(struct blk_desc *desc, const char *name,
+				     disk_partition_t *info)
+{
+	int i, ret;
+
+	for (i = 0; i < ARRAY_SIZE(env_part_cache); i++) {
+		if (!strcmp(env_part_cache[i].name, name)) {
+			info->start = env_part_cache[i].start;
+			info->size  = env_part_cache[i].size;
+			return 0;
+		}
+	}
+
+	ret = sunxi_flash_try_partition(desc, name, info);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < ARRAY_SIZE(env_part_cache); i++) {
+		if (!env_part_cache[i].name[0]) {
+			strlcpy(env_part_cache[i].name, name,
+				sizeof(env_part_cache[i].name));
+			env_part_cache[i].start = info->start;
+			env_part_cache[i].size  = info->size;
+			break;
+		}
+	}
+
+	return ret;
+}
+
 #if defined(CONFIG_CMD_SAVEENV) && !defined(CONFIG_SPL_BUILD)
 static inline int write_env(struct blk_desc *desc, uint blk_cnt, uint blk_start,
 			    const void *buffer)
@@ -101,7 +146,7 @@ static int env_sunxi_flash_save(void)
 
 	if (gd->env_valid == ENV_VALID) {
 		puts("Writing to redundant env... ");
-		ret = sunxi_flash_try_partition(desc, CONFIG_SUNXI_ENV_REDUNDAND_PARTITION, &info);
+		ret = env_sunxi_flash_partition(desc, CONFIG_SUNXI_ENV_REDUNDAND_PARTITION, &info);
 		if (ret < 0)
 			return -ENODEV;
 
@@ -113,7 +158,7 @@ static int env_sunxi_flash_save(void)
 		}
 	} else {
 		puts("Writing to env... ");
-		ret = sunxi_flash_try_partition(desc, CONFIG_SUNXI_ENV_PARTITION, &info);
+		ret = env_sunxi_flash_partition(desc, CONFIG_SUNXI_ENV_PARTITION, &info);
 		if (ret < 0)
 			return -ENODEV;
 
@@ -147,15 +192,40 @@ static int env_sunxi_flash_save(void)
 	if (desc == NULL)
 		return -ENODEV;
 
-	ret = sunxi_flash_try_partition(desc, "env", &info);
+	ret = env_sunxi_flash_partition(desc, "env", &info);
 	if (ret < 0)
 		return -ENODEV;
 	ret = env_export(env_new);
 	if (ret)
 		goto fini;
 
+#ifdef CONFIG_SUNXI_ENV_BACKUP_REDUND
+	if ((uint)info.size >= ((CONFIG_ENV_SIZE * 2)/512)) {
+		/* overwrite the older copy only, the serial tells them apart */
+		int copy = gd->env_valid == ENV_VALID;
+
+		printf("Writing to %s env...\n", copy ? "backup" : "normal");
+		if (write_env(desc, (CONFIG_ENV_SIZE + 511) / 512,
+			      (uint)info.start + copy * (CONFIG_ENV_SIZE / 512),
+			      (u_char *)env_new)) {
+			puts("failed\n");
+			ret = 1;
+			goto fini;
+		}
+		gd->env_valid = copy ? ENV_REDUND : ENV_VALID;
+	} else {
+		printf("env size is %u\n", (uint)info.size);
+		puts("env partition is too small!\n");
+		puts("can't enabled backup env functions\n");
+		if (write_env(desc, (CONFIG_ENV_SIZE + 511) / 512, (uint)info.start,
+			 (u_char *)env_new)) {
+			puts("failed\n");
+			ret = 1;
+			goto fini;
+		}
+	}
+#elif defined(CONFIG_SUNXI_ENV_BACKUP)
 	printf("Writing to env...\n");
-#ifdef CONFIG_SUNXI_ENV_BACKUP
 	if ((uint)info.size >= ((CONFIG_ENV_SIZE * 2)/512)) {
 		char backup_buf[CONFIG_ENV_SIZE*2];
 		memcpy(backup_buf, env_new, CONFIG_ENV_SIZE);
@@ -178,6 +248,7 @@ static int env_sunxi_flash_save(void)
 		}
 	}
 #else
+	printf("Writing to env...\n");
 	if (write_env(desc, (CONFIG_ENV_SIZE + 511) / 512, (uint)info.start,
 		      (u_char *)env_new)) {
 		puts("failed\n");
@@ -270,7 +341,7 @@ static int env_sunxi_flash_load(void)
 	tmp_env1 = (env_t *)env1_buf;
 	tmp_env2 = (env_t *)env2_buf;
 
-	ret = sunxi_flash_try_partition(desc, CONFIG_SUNXI_ENV_PARTITION, &info);
+	ret = env_sunxi_flash_partition(desc, CONFIG_SUNXI_ENV_PARTITION, &info);
 	if (ret < 0) {
 		printf("Can't find %s partition\n", CONFIG_SUNXI_ENV_PARTITION);
 		ret = -ENODEV;
@@ -282,7 +353,7 @@ static int env_sunxi_flash_load(void)
 		       CONFIG_SUNXI_ENV_PARTITION);
 
 	memset(&info, 0x0, sizeof(disk_partition_t));
-	ret = sunxi_flash_try_partition(desc, CONFIG_SUNXI_ENV_REDUNDAND_PARTITION, &info);
+	ret = env_sunxi_flash_partition(desc, CONFIG_SUNXI_ENV_REDUNDAND_PARTITION, &info);
 	if (ret < 0) {
 		printf("Can't find %s partition\n", CONFIG_SUNXI_ENV_REDUNDAND_PARTITION);
 		ret = -ENODEV;
@@ -312,7 +383,32 @@ err:
 }
 #else
 
-#ifdef CONFIG_SUNXI_ENV_BACKUP
+#if defined(CONFIG_SUNXI_ENV_BACKUP_REDUND)
+/*
+ * an env partition last written without the serial: crc and data, the
+ * same in both copies. import it so the first save starts the pair.
+ */
+static int env_import_backup(const char *buf)
+{
+	extern struct hsearch_data env_htab;
+	uint32_t crc;
+
+	memcpy(&crc, buf, sizeof(crc));
+	if (crc32(0, (const u8 *)buf + sizeof(crc),
+		  CONFIG_ENV_SIZE - sizeof(crc)) != crc)
+		return -EIO;
+
+	if (!himport_r(&env_htab, buf + sizeof(crc),
+		       CONFIG_ENV_SIZE - sizeof(crc), '\0', 0, 0, 0, NULL))
+		return -EIO;
+
+	/* the next save goes to the backup copy, the normal one stays */
+	gd->env_valid = ENV_VALID;
+	gd->flags |= GD_FLG_ENV_READY;
+
+	return 0;
+}
+#elif defined(CONFIG_SUNXI_ENV_BACKUP)
 uint32_t env_calc_crc(const char *buf);
 uint32_t env_get_crc(const char *buf);
 #endif
@@ -344,7 +440,7 @@ static int env_sunxi_flash_load(void)
 		ret = -ENODEV;
 		goto err;
 	}
-	ret = sunxi_flash_try_partition(desc, "env", &info);
+	ret = env_sunxi_flash_partition(desc, "env", &info);
 	/* printf ("name:%s start:0x%x, size: 0x%x\n", info.name, (u32)info.start, (u32)info.size); */
 	if (ret < 0) {
 		ret = -ENODEV;
@@ -367,7 +463,20 @@ static int env_sunxi_flash_load(void)
 		goto err;
 	}
 
-#ifdef CONFIG_SUNXI_ENV_BACKUP
+#ifdef CONFIG_SUNXI_ENV_BACKUP_REDUND
+	if ((uint)info.size >= ((CONFIG_ENV_SIZE * 2)/512)) {
+		ret = env_import_redund(buf, 0, buf + CONFIG_ENV_SIZE, 0);
+		if (ret && !env_import_backup(buf)) {
+			puts("env converted from the backup layout\n");
+			ret = 0;
+		}
+	} else {
+		printf("env size is %u\n", (uint)info.size);
+		puts("env partition is too small!\n");
+		puts("can't enabled backup env functions\n");
+		ret = env_import(buf, 1);
+	}
+#elif defined(CONFIG_SUNXI_ENV_BACKUP)
 	char *normal_buf_p = buf;
 	char *backup_buf_p = buf;
 	//point to backup area
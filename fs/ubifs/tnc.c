@@ -1720,6 +1720,28 @@ out:
 	return err;
 }
 
+/**
+ * ubifs_tnc_bulk_validate - validate data nodes read for bulk-read.
+ * @c: UBIFS file-system description object
+ * @bu: bulk-read parameters, @bu->buf holds the nodes as laid out in the LEB
+ *
+ * This functions returns %0 on success or a negative error code on failure.
+ */
+int ubifs_tnc_bulk_validate(struct ubifs_info *c, struct bu_info *bu)
+{
+	void *buf = bu->buf;
+	int err, i;
+
+	for (i = 0; i < bu->cnt; i++) {
+		err = validate_data_node(c, buf, &bu->zbranch[i]);
+		if (err)
+			return err;
+		buf = buf + ALIGN(bu->zbranch[i].len, 8);
+	}
+
+	return 0;
+}
+
 /**
  * ubifs_tnc_bulk_read - read a number of data nodes in one go.
  * @c: UBIFS file-system description object
@@ -1732,9 +1754,8 @@ out:
  */
 int ubifs_tnc_bulk_read(struct ubifs_info *c, struct bu_info *bu)
 {
-	int lnum = bu->zbranch[0].lnum, offs = bu->zbranch[0].offs, len, err, i;
+	int lnum = bu->zbranch[0].lnum, offs = bu->zbranch[0].offs, len, err;
 	struct ubifs_wbuf *wbuf;
-	void *buf;
 
 	len = bu->zbranch[bu->cnt - 1].offs;
 	len += bu->zbranch[bu->cnt - 1].len - offs;
@@ -1763,15 +1784,7 @@ int ubifs_tnc_bulk_read(struct ubifs_info *c, struct bu_info *bu)
 	}
 
 	/* Validate the nodes read */
-	buf = bu->buf;
-	for (i = 0; i < bu->cnt; i++) {
-		err = validate_data_node(c, buf, &bu->zbranch[i]);
-		if (err)
-			return err;
-		buf = buf + ALIGN(bu->zbranch[i].len, 8);
-	}
-
-	return 0;
+	return ubifs_tnc_bulk_validate(c, bu);
 }
 
 /**
@@ -12,6 +12,7 @@
  */
 
 #include <common.h>
+#include <div64.h>
 #include <memalign.h>
 #include "ubifs.h"
 #include <u-boot/zlib.h>
@@ -682,23 +683,13 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+/* decompress data node @dn of @block into @addr, a whole block */
+static int decode_block(struct ubifs_info *c, struct inode *inode, void *addr,
+			unsigned int block, struct ubifs_data_node *dn)
 {
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -729,6 +720,25 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decode_block(c, inode, addr, block, dn);
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -840,6 +850,185 @@ error:
 	return err;
 }
 
+#ifdef CONFIG_UBIFS_BULK_READ
+/*
+ * Bulk-read for file loads. The data nodes of a file that follow each other
+ * in one LEB are found with ubifs_tnc_get_bu_keys() and fetched with a single
+ * read, then decompressed straight into the destination. Reads go through a
+ * small LEB cache that only lives for one ubifs_read(), so a LEB holding more
+ * nodes than one bulk-read covers is still read once, and nothing written to
+ * the volume in between loads can be served stale.
+ */
+#define UBIFS_LEB_CACHE_CNT	2
+
+struct ubifs_leb_cache {
+	int lnum;		/* -1 when empty */
+	int start;		/* [start, end) of the LEB is in buf */
+	int end;
+	unsigned long used;
+	void *buf;		/* c->leb_size */
+};
+
+struct ubifs_bulk {
+	struct bu_info bu;
+	struct ubifs_leb_cache leb[UBIFS_LEB_CACHE_CNT];
+	unsigned long tick;
+};
+
+static struct ubifs_bulk *ubifs_bulk_begin(void)
+{
+	struct ubifs_bulk *b;
+	int i;
+
+	b = calloc(1, sizeof(*b));
+	if (!b)
+		return NULL;
+	for (i = 0; i < UBIFS_LEB_CACHE_CNT; i++)
+		b->leb[i].lnum = -1;
+
+	return b;
+}
+
+static void ubifs_bulk_end(struct ubifs_bulk *b)
+{
+	int i;
+
+	if (!b)
+		return;
+	for (i = 0; i < UBIFS_LEB_CACHE_CNT; i++)
+		free(b->leb[i].buf);
+	free(b);
+}
+
+/*
+ * Return @len bytes at @lnum:@offs from the LEB cache, reading them on a
+ * miss. With @more set the rest of the LEB is read as well, the next
+ * bulk-read of the file is expected to want it.
+ */
+static void *ubifs_leb_cache_read(struct ubifs_info *c, struct ubifs_bulk *b,
+				  int lnum, int offs, int len, int more)
+{
+	struct ubifs_leb_cache *lc, *victim = &b->leb[0];
+	int i, end, err;
+
+	for (i = 0; i < UBIFS_LEB_CACHE_CNT; i++) {
+		lc = &b->leb[i];
+		if (lc->lnum == lnum && offs >= lc->start &&
+		    offs + len <= lc->end) {
+			lc->used = ++b->tick;
+			return lc->buf + offs;
+		}
+		if (lc->used < victim->used)
+			victim = lc;
+	}
+
+	if (!victim->buf) {
+		victim->buf = malloc_cache_aligned(c->leb_size);
+		if (!victim->buf)
+			return ERR_PTR(-ENOMEM);
+	}
+
+	end = more ? c->leb_size : offs + len;
+	err = ubifs_leb_read(c, lnum, victim->buf + offs, offs, end - offs, 0);
+	/* like ubifs_tnc_bulk_read(), -EBADMSG is left to the node crc check */
+	if (err && err != -EBADMSG) {
+		victim->lnum = -1;
+		victim->used = 0;
+		return ERR_PTR(err);
+	}
+	victim->lnum = lnum;
+	victim->start = offs;
+	victim->end = end;
+	victim->used = ++b->tick;
+
+	return victim->buf + offs;
+}
+
+/*
+ * Fill the @nblocks whole blocks from @block on into @addr, holes read as
+ * zeroes. @done returns how many blocks from @block on are complete, the
+ * caller reads the rest block by block.
+ */
+static int bulk_read_blocks(struct ubifs_info *c, struct inode *inode,
+			    struct ubifs_bulk *b, void *addr,
+			    unsigned int block, unsigned int nblocks,
+			    unsigned int *done)
+{
+	struct bu_info *bu = &b->bu;
+	unsigned int first = block, end = block + nblocks, nb;
+	int err, i, offs, len, more;
+	void *buf;
+
+	*done = 0;
+	while (block < end) {
+		data_key_init(c, &bu->key, inode->i_ino, block);
+		bu->buf_len = c->leb_size;
+		err = ubifs_tnc_get_bu_keys(c, bu);
+		if (err)
+			return err;
+
+		i = 0;
+		if (bu->cnt) {
+			offs = bu->zbranch[0].offs;
+			len = bu->zbranch[bu->cnt - 1].offs +
+			      bu->zbranch[bu->cnt - 1].len - offs;
+			/* cut short by the node limit, the file goes on here */
+			more = !bu->eof && (bu->cnt == UBIFS_MAX_BULK_READ ||
+					    bu->blk_cnt >= UBIFS_MAX_BULK_READ);
+			buf = ubifs_leb_cache_read(c, b, bu->zbranch[0].lnum,
+						   offs, len, more);
+			if (IS_ERR(buf))
+				return PTR_ERR(buf);
+			bu->buf = buf;
+			err = ubifs_tnc_bulk_validate(c, bu);
+			if (err)
+				return err;
+
+			for (; i < bu->cnt; i++) {
+				nb = key_block(c, &bu->zbranch[i].key);
+				if (nb >= end)
+					break;
+				if (nb > block)
+					memset(addr + (block - first) *
+					       UBIFS_BLOCK_SIZE, 0,
+					       (nb - block) * UBIFS_BLOCK_SIZE);
+				err = decode_block(c, inode,
+						   addr + (nb - first) *
+						   UBIFS_BLOCK_SIZE, nb,
+						   buf + bu->zbranch[i].offs -
+						   offs);
+				if (err)
+					return err;
+				block = nb + 1;
+				*done = block - first;
+			}
+		}
+		if (i < bu->cnt || bu->eof) {
+			/* no more data nodes before @end, the rest is a hole */
+			memset(addr + (block - first) * UBIFS_BLOCK_SIZE, 0,
+			       (end - block) * UBIFS_BLOCK_SIZE);
+			block = end;
+		} else if (!bu->cnt) {
+			/*
+			 * the lookup gave up on a hole of UBIFS_MAX_BULK_READ
+			 * blocks or more before reaching the next node, skip
+			 * what it counted. anything else is left to the
+			 * caller's per page read.
+			 */
+			if (!bu->blk_cnt)
+				break;
+			nb = min_t(unsigned int, bu->blk_cnt, end - block);
+			memset(addr + (block - first) * UBIFS_BLOCK_SIZE, 0,
+			       nb * UBIFS_BLOCK_SIZE);
+			block += nb;
+		}
+		*done = block - first;
+	}
+
+	return 0;
+}
+#endif
+
 int ubifs_read(const char *filename, void *buf, loff_t offset,
 	       loff_t size, loff_t *actread)
 {
@@ -851,6 +1040,10 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	int i;
 	int count;
 	int last_block_size = 0;
+#ifdef CONFIG_UBIFS_BULK_READ
+	struct ubifs_bulk *bulk;
+	unsigned int done;
+#endif
 
 	*actread = 0;
 
@@ -898,7 +1091,27 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	page.addr = buf;
 	page.index = offset / PAGE_SIZE;
 	page.inode = inode;
-	for (i = 0; i < count; i++) {
+	i = 0;
+#ifdef CONFIG_UBIFS_BULK_READ
+	/*
+	 * Whole blocks go through bulk-read. The partial last block, and
+	 * whatever bulk-read could not do, take the block by block path.
+	 */
+	bulk = ubifs_bulk_begin();
+	if (bulk) {
+		err = bulk_read_blocks(c, inode, bulk, buf, page.index,
+				       size >> UBIFS_BLOCK_SHIFT, &done);
+		if (err)
+			dbg_gen("bulk-read stopped at block %lu, error %d",
+				page.index + done, err);
+		ubifs_bulk_end(bulk);
+		err = 0;
+		i = done;
+		page.addr += done * PAGE_SIZE;
+		page.index += done;
+	}
+#endif
+	for (; i < count; i++) {
 		/*
 		 * Make sure to not read beyond the requested size
 		 */
@@ -936,14 +1149,21 @@ void ubifs_close(void)
 int ubifs_load(char *filename, u32 addr, u32 size)
 {
 	loff_t actread;
+	ulong start, ms;
 	int err;
 
 	printf("Loading file '%s' to addr 0x%08x...\n", filename, addr);
 
+	start = get_timer(0);
 	err = ubifs_read(filename, (void *)(uintptr_t)addr, 0, size, &actread);
 	if (err == 0) {
 		env_set_hex("filesize", actread);
-		printf("Done\n");
+		ms = max(get_timer(start), 1UL);
+		printf("Done, %llu bytes in %lu ms, %lu KiB/s (%s)\n",
+		       (unsigned long long)actread, ms,
+		       (ulong)lldiv((u64)actread * 1000, ms * 1024),
+		       IS_ENABLED(CONFIG_UBIFS_BULK_READ) ? "bulk-read" :
+							    "block read");
 	}
 
 	return err;
@@ -2216,6 +2216,7 @@ int is_idx_node_in_tnc(struct ubifs_info *c, union ubifs_key *key, int level,
 int insert_old_idx_znode(struct ubifs_info *c, struct ubifs_znode *znode);
 int ubifs_tnc_get_bu_keys(struct ubifs_info *c, struct bu_info *bu);
 int ubifs_tnc_bulk_read(struct ubifs_info *c, struct bu_info *bu);
+int ubifs_tnc_bulk_validate(struct ubifs_info *c, struct bu_info *bu);
 
 /* tnc_misc.c */
 struct ubifs_znode *ubifs_tnc_levelorder_next(struct ubifs_znode *zr,
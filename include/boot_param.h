@@ -20,6 +20,7 @@
 #define BOOT_PARAM_MAGIC		"bootpara"
 #define BOOT_PARAM_SIZE			4096
 #define CHECK_SUM			0x5F0A6C39
+#define SPI_SAMP_PATTERN_LEN		256
 
 struct sunxi_boot_parameter_header {
 	u8 magic[8]; //bootpara
@@ -36,7 +37,8 @@ struct sunxi_boot_param_region {
 	char nand_info[256];
 	char spiflash_info[256];
 	char ddr_info[512];
-	u8 reserved[2784];// = 4096 - sdmmc_size - nand_size - spi_size - ddr_size - 32
+	u8 spi_samp_pattern[SPI_SAMP_PATTERN_LEN];/* read back to calibrate spi sample delay */
+	u8 reserved[2528];// = 4096 - sdmmc_size - nand_size - spi_size - ddr_size - pattern_size - 32
 };
 
 #endif
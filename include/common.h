@@ -484,6 +484,7 @@ int gzwrite(unsigned char *src, int len,
 
 /* lib/lz4_wrapper.c */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
+int ulz4fn_block(const void *src, size_t srcn, void *dst, size_t dstn);
 
 /* lib/qsort.c */
 void qsort(void *base, size_t nmemb, size_t size,
@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Batched device tree fixups
+ *
+ * Node enables, property sets and deletes are queued against an unmodified
+ * blob and written out in a single pass over the structure block. The
+ * result is laid out exactly as the same sequence of fdt_setprop() /
+ * fdt_delprop() calls would have left it; only the padding behind property
+ * values differs, libfdt leaves stale bytes there and the batch zeroes it.
+ */
+
+#ifndef __FDT_BATCH_H
+#define __FDT_BATCH_H
+
+#include <linux/libfdt.h>
+#include <linux/string.h>
+
+struct fdt_batch_path {
+	char *path;
+	int offset;
+};
+
+struct fdt_batch {
+	void *fdt;
+	struct fdt_batch_op *ops;
+	int nr_ops;
+	int max_ops;
+	struct fdt_batch_path *paths;
+	int nr_paths;
+	int max_paths;
+	int err;		/* first queueing error, reported by apply */
+	ulong apply_us;		/* time spent in the last fdt_batch_apply() */
+};
+
+#ifdef CONFIG_FDT_BATCH_FIXUP
+/*
+ * queue changes against fdt. the blob must not be modified by anything
+ * else until fdt_batch_apply() or fdt_batch_abort() is called.
+ */
+int fdt_batch_begin(struct fdt_batch *b, void *fdt);
+
+/* cached fdt_path_offset(), the path may also be an alias */
+int fdt_batch_path_offset(struct fdt_batch *b, const char *path);
+
+int fdt_batch_setprop_off(struct fdt_batch *b, int nodeoffset,
+			  const char *name, const void *val, int len);
+int fdt_batch_setprop(struct fdt_batch *b, const char *path,
+		      const char *name, const void *val, int len);
+int fdt_batch_delprop_off(struct fdt_batch *b, int nodeoffset,
+			  const char *name);
+int fdt_batch_delprop(struct fdt_batch *b, const char *path,
+		      const char *name);
+int fdt_batch_enable_node(struct fdt_batch *b, const char *path, int onoff);
+
+/*
+ * write all queued changes. bufsize is the space available at the blob;
+ * totalsize is only raised (once) when the result does not fit in it.
+ * on error the blob is left untouched. the batch is released either way.
+ */
+int fdt_batch_apply(struct fdt_batch *b, int bufsize);
+void fdt_batch_abort(struct fdt_batch *b);
+#else
+/* without the batch engine every change goes straight to the blob */
+static inline int fdt_batch_begin(struct fdt_batch *b, void *fdt)
+{
+	memset(b, 0, sizeof(*b));
+	b->fdt = fdt;
+
+	return fdt_check_header(fdt);
+}
+
+static inline int fdt_batch_path_offset(struct fdt_batch *b, const char *path)
+{
+	return fdt_path_offset(b->fdt, path);
+}
+
+static inline int fdt_batch_setprop_off(struct fdt_batch *b, int nodeoffset,
+					const char *name, const void *val,
+					int len)
+{
+	int ret = fdt_setprop(b->fdt, nodeoffset, name, val, len);
+
+	if (!ret)
+		b->nr_ops++;
+
+	return ret;
+}
+
+static inline int fdt_batch_setprop(struct fdt_batch *b, const char *path,
+				    const char *name, const void *val, int len)
+{
+	return fdt_batch_setprop_off(b, fdt_path_offset(b->fdt, path), name,
+				     val, len);
+}
+
+static inline int fdt_batch_delprop_off(struct fdt_batch *b, int nodeoffset,
+					const char *name)
+{
+	int ret = fdt_delprop(b->fdt, nodeoffset, name);
+
+	if (!ret)
+		b->nr_ops++;
+
+	return ret;
+}
+
+static inline int fdt_batch_delprop(struct fdt_batch *b, const char *path,
+				    const char *name)
+{
+	return fdt_batch_delprop_off(b, fdt_path_offset(b->fdt, path), name);
+}
+
+static inline int fdt_batch_enable_node(struct fdt_batch *b, const char *path,
+					int onoff)
+{
+	const char *status = onoff ? "okay" : "disabled";
+
+	return fdt_batch_setprop(b, path, "status", status,
+				 strlen(status) + 1);
+}
+
+static inline int fdt_batch_apply(struct fdt_batch *b, int bufsize)
+{
+	return 0;
+}
+
+static inline void fdt_batch_abort(struct fdt_batch *b)
+{
+}
+#endif
+
+static inline int fdt_batch_setprop_u32(struct fdt_batch *b, const char *path,
+					const char *name, u32 val)
+{
+	fdt32_t tmp = cpu_to_fdt32(val);
+
+	return fdt_batch_setprop(b, path, name, &tmp, sizeof(tmp));
+}
+
+static inline int fdt_batch_setprop_string(struct fdt_batch *b,
+					   const char *path, const char *name,
+					   const char *str)
+{
+	return fdt_batch_setprop(b, path, name, str, strlen(str) + 1);
+}
+
+#endif /* __FDT_BATCH_H */
@@ -123,6 +123,8 @@
 #define RAWNAND_CMD_MULTIPROG		0x11
 #define RAWNAND_CMD_MULTIPREADSTART	0x32
 #define RAWNAND_CMD_MULTIERASE		0xd1
+#define RAWNAND_CMD_READCACHESEQ	0x31
+#define RAWNAND_CMD_READCACHEEND	0x3f
 
 #define TOGGLE_INTERFACE_CHANGE_ADDR	(0x80)
 
@@ -631,7 +633,6 @@ struct aw_nfc_normal_req _req = {		\
 			.addr[2] = _addr3,	\
 			.addr[3] = _addr4,	\
 			.addr[4] = _addr5,	\
-			.addr[5] = _addr5,	\
 			.addr_cycles = 5,	\
 		}				\
 	}					\
@@ -785,6 +786,33 @@ struct aw_nfc_batch_req {
 	}
 
 
+/*
+ * read a page out of the cache register after 31h/3Fh: 05h-col-E0h, so no
+ * row address is sent. the page is still needed for the randomizer seed.
+ */
+#define BATCH_REQ_CACHE_READ_OUT(_req, _page, _mdata, _mlen)		\
+	struct aw_nfc_batch_req _req = {					\
+		.type = READ,							\
+		.layout = INTERLEAVE,						\
+		.cmd.r = {							\
+			.READ0 = RAWNAND_CMD_RNDOUT,				\
+			.READSTART = RAWNAND_CMD_RNDOUTSTART,			\
+			.RNOUT = RAWNAND_CMD_RNDOUT,				\
+			.RNOUTSTART = RAWNAND_CMD_RNDOUTSTART,			\
+		},								\
+		.addr = {							\
+			.page = _page,						\
+			.row_cycles = 0,					\
+		},								\
+		.data = {							\
+			.type = MAINSPARE,					\
+			.main_len = _mlen,					\
+			.spare_len = 0,						\
+			.main = _mdata,					\
+			.spare = NULL,					\
+		},								\
+	}
+
 #define BATCH_REQ_READ_ONLY_SPARE(_req, _page, _row_cycles, _sdata, _slen)	\
 	struct aw_nfc_batch_req _req = {						\
 		.type = READ,							\
@@ -950,6 +978,21 @@ struct aw_nfc_dma_desc {
 	unsigned int buff;
 	struct aw_nfc_dma_desc *next;
 };
+
+/*
+ * where the cpu time of nand operations goes: spin_us is spent polling the
+ * controller or the chip, overlap_us is spent on other work while a program
+ * or erase submitted with aw_rawnand_*_submit() was running in the chip
+ */
+struct aw_nand_wait_stat {
+	u64 spin_us;
+	u64 overlap_us;
+	u32 spins;
+	u32 rb_irqs;
+	u32 dma_irqs;
+	u32 pe_ops;	/*program/erase operations waited for*/
+};
+
 struct aw_nand_host {
 	struct udevice *dev;
 	void __iomem *base;
@@ -1011,6 +1054,10 @@ struct aw_nand_host {
 	int (*normal_op)(struct aw_nand_chip *chip, struct aw_nfc_normal_req *req);
 	int (*batch_op)(struct aw_nand_chip *chip, struct aw_nfc_batch_req *req);
 	bool (*rb_ready)(struct aw_nand_chip *chip, struct aw_nand_host *host);
+	/*clear rb_ready_flag and let the next B2R interrupt set it*/
+	void (*rb_event_arm)(struct aw_nand_host *host);
+
+	struct aw_nand_wait_stat wait_stat;
 
 	void *priv;
 
@@ -1066,6 +1113,28 @@ struct aw_nand_chip_cache {
 	int chipno;
 };
 
+/*
+ * sequential read-ahead window, filled by cache read (31h/3Fh) so the
+ * array read of the next page overlaps the transfer of the current one
+ */
+struct aw_nand_chip_prefetch {
+	bool enable;
+	/*window: nr pages from page, as passed to read_page/multi_read_page*/
+	int chipno;
+	int page;
+	int nr;
+	bool multi;
+	int page_len;
+	int max_pages;
+	uint8_t *buf;
+	int *ecc;
+	uint8_t *bitflips;
+	/*last page asked for, to detect a sequential stream*/
+	int last_page;
+	unsigned int hits;
+	unsigned int fills;
+};
+
 struct aw_nand_chip {
 	struct mutex lock;
 	/**************************
@@ -1135,6 +1204,7 @@ struct aw_nand_chip {
 	struct ce_info ceinfo[MAX_CHIPS];
 
 	struct aw_nand_chip_cache simu_chip_buffer;
+	struct aw_nand_chip_prefetch prefetch;
 
 	struct rawnand_data_interface data_interface;
 #define BBT_B_INVALID	(2)
@@ -1362,6 +1432,41 @@ extern int rawslcnand_write_boot0_page(struct mtd_info *mtd, struct aw_nand_chip
 extern int rawslcnand_read_boot0_page(struct mtd_info *mtd, struct aw_nand_chip *chip,
 		uint8_t *mdata, int mlen, uint8_t *sdata, int slen, int page);
 
+/*
+ * handle of a program/erase left running in the chip, the caller must
+ * aw_rawnand_op_wait() on it before it touches the chip again
+ */
+struct aw_nand_op {
+	bool pending;
+	int page;
+	ulong submit_us;
+};
+
+static inline void aw_nand_wait_stat_spin(struct aw_nand_host *host,
+		ulong start_us)
+{
+	host->wait_stat.spin_us += timer_get_us() - start_us;
+	host->wait_stat.spins++;
+}
+
+extern int aw_rawnand_chip_erase_submit(struct mtd_info *mtd, int page,
+		struct aw_nand_op *op);
+extern int aw_rawnand_chip_write_page_submit(struct mtd_info *mtd,
+		struct aw_nand_chip *chip, uint8_t *mdata, int mlen,
+		uint8_t *sdata, int slen, int page, struct aw_nand_op *op);
+extern bool aw_rawnand_op_done(struct mtd_info *mtd, struct aw_nand_op *op);
+extern int aw_rawnand_op_wait(struct mtd_info *mtd, struct aw_nand_op *op);
+extern void rawnand_mtd_wait_stat(int reset);
+
+#ifdef CONFIG_AW_RAWNAND_READ_PREFETCH
+extern void aw_rawnand_prefetch_drop(struct aw_nand_chip *chip);
+extern int rawnand_mtd_read_bench(loff_t from, size_t len);
+#else
+static inline void aw_rawnand_prefetch_drop(struct aw_nand_chip *chip)
+{
+}
+#endif
+
 extern void DISPLAY_VERSION(void);
 extern int aw_rawnand_probe(struct udevice *dev);
 extern int aw_rawnand_remove(struct udevice *dev);
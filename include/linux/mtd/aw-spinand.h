@@ -57,6 +57,16 @@ struct aw_spinand_info;
 struct aw_spinand_phy_info;
 struct aw_spinand_chip_ops;
 
+/*
+ * spi nand has no ready line or interrupt, the end of every reset, read,
+ * program and erase is found by polling the status register
+ */
+struct aw_spinand_wait_stat {
+	u64 spin_us;
+	u32 waits;
+	u32 polls;
+};
+
 struct aw_spinand_chip {
 	struct aw_spinand_chip_ops *ops;
 	struct aw_spinand_ecc *ecc;
@@ -67,6 +77,7 @@ struct aw_spinand_chip {
 	unsigned int rx_bit;
 	unsigned int tx_bit;
 	unsigned int freq;
+	struct aw_spinand_wait_stat wait_stat;
 	void *priv;
 };
 
@@ -302,4 +313,5 @@ extern int spinand_mtd_secure_storage_read(int item, char *buf,
 extern int spinand_mtd_secure_storage_write(int item, char *buf,
 		unsigned int len);
 extern uint64_t spinand_sys_part_offset(void);
+extern void spinand_mtd_wait_stat(int reset);
 #endif
@@ -222,6 +222,7 @@ static inline bool mmc_is_tuning_cmd(uint cmdidx)
 #define EXT_CSD_MODE_CONFIG		30	/* R/W/E_P */
 #define EXT_CSD_ENH_START_ADDR		136	/* R/W */
 #define EXT_CSD_ENH_SIZE_MULT		140	/* R/W */
+#define EXT_CSD_DATA_SECTOR_SIZE	61	/* RO */
 #define EXT_CSD_GP_SIZE_MULT		143	/* R/W */
 #define EXT_CSD_PARTITION_SETTING	155	/* R/W */
 #define EXT_CSD_PARTITIONS_ATTRIBUTE	156	/* R/W */
@@ -246,6 +247,7 @@ static inline bool mmc_is_tuning_cmd(uint cmdidx)
 #define EXT_CSD_CARD_TYPE		196	/* RO */
 #define EXT_CSD_SEC_CNT			212	/* RO, 4 bytes */
 #define EXT_CSD_HC_WP_GRP_SIZE		221	/* RO */
+#define EXT_CSD_REL_WR_SEC_C		222	/* RO */
 #define EXT_CSD_ERASE_TIMEOUT_MULT      223     /* RO */
 #define EXT_CSD_HC_ERASE_GRP_SIZE	224	/* RO */
 #define EXT_CSD_BOOT_MULT		226	/* RO */
@@ -256,6 +258,7 @@ static inline bool mmc_is_tuning_cmd(uint cmdidx)
 #define EXT_CSD_POWER_OFF_LONG_TIME     247     /* RO */
 #define EXT_CSD_GENERIC_CMD6_TIME       248     /* RO */
 #define EXT_CSD_SUPPORTED_MODES       	493     /* RO */
+#define EXT_CSD_MAX_PACKED_WRITES	500	/* RO */
 #define EXT_CSD_BKOPS_SUPPORT		502	/* RO */
 
 /*
@@ -337,10 +340,17 @@ static inline bool mmc_is_tuning_cmd(uint cmdidx)
 #define EXT_CSD_ENH_GP(x)	(1 << ((x)+1))	/* GP part (x+1) is enhanced */
 
 #define EXT_CSD_HS_CTRL_REL	(1 << 0)	/* host controlled WR_REL_SET */
+#define EXT_CSD_EN_REL_WR	(1 << 2)	/* any size reliable write */
 
 #define EXT_CSD_WR_DATA_REL_USR		(1 << 0)	/* user data area WR_REL */
 #define EXT_CSD_WR_DATA_REL_GP(x)	(1 << ((x)+1))	/* GP part (x+1) WR_REL */
 
+/* mmc->wr_caps */
+#define MMC_WR_CAP_PROBED	(1 << 0)
+#define MMC_WR_CAP_SBC		(1 << 1)	/* CMD23 ahead of CMD25 */
+#define MMC_WR_CAP_REL		(1 << 2)	/* reliable write of any size */
+#define MMC_WR_CAP_PACKED	(1 << 3)	/* packed write commands */
+
 #define R1_ILLEGAL_COMMAND		(1 << 22)
 #define R1_APP_CMD			(1 << 5)
 
@@ -828,6 +838,8 @@ struct mmc {
 	u32 do_tuning;
 	u32 msglevel;
 	int manual_stop_flag;
+	int sbc_flag;		/* CMD23 was sent, no stop for the data command */
+	u32 wr_caps;		/* MMC_WR_CAP_*, probed by the first write */
 
 	uint erase_timeout; /*default erasetimeout or hc_erase_timeout*/
 	uint trim_discard_timeout;
@@ -1093,6 +1105,31 @@ int sunxi_write_tuning(struct mmc *mmc);
 int sunxi_bus_tuning(struct mmc *mmc);
 int sunxi_mmc_tuning_exit(void);
 int sunxi_switch_to_best_bus(struct mmc *mmc);
+/* idmac setup and dma vs fifo read times, sets the pio cutoff */
+int sunxi_mmc_dma_bench(struct mmc *mmc, lbaint_t start);
+
+#ifdef CONFIG_MMC_SUNXI_SBC_WRITE
+/* reliable (power fail atomic) write, plain writes without CMD23 */
+ulong mmc_write_reliable(struct mmc *mmc, lbaint_t start, lbaint_t blkcnt,
+			 const void *src);
+/* legacy, CMD23 and packed write speed, the data is read and put back */
+int mmc_write_bench(struct mmc *mmc, lbaint_t start, lbaint_t blkcnt);
+#endif
+#if defined(CONFIG_MMC_SUNXI_PACKED_WRITE) && CONFIG_IS_ENABLED(MMC_WRITE)
+/*
+ * queue a small write for the next packed command. the data is copied,
+ * large writes go straight to the card. every read, write or erase of
+ * the device flushes the queue first.
+ */
+ulong mmc_packed_write(struct mmc *mmc, lbaint_t start, lbaint_t blkcnt,
+		       const void *src);
+int mmc_packed_flush(struct mmc *mmc);
+#else
+static inline int mmc_packed_flush(struct mmc *mmc)
+{
+	return 0;
+}
+#endif
 
 int mmc_exit(void);
 void mmc_update_config_for_dragonboard(int card_no);
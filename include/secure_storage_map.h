@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * In-memory index of the secure storage item map
+ *
+ * Item 0 of the secure storage holds a text map, "name:len\0" per item,
+ * where the position of an entry is the storage slot of its data. Erased
+ * items are replaced by SECURE_STORAGE_DUMMY_KEY_NAME with length 0 so the
+ * following slots do not move. The index is built from that text once,
+ * looked up by name hash and only turned back into text when the map is
+ * saved.
+ */
+
+#ifndef __SECURE_STORAGE_MAP_H
+#define __SECURE_STORAGE_MAP_H
+
+#include <linux/types.h>
+
+#define SECMAP_NAME_SIZE	64
+
+/* secmap_item.flags */
+#define SECMAP_ITEM_DUMMY	(1 << 0)	/* slot freed by an erase */
+
+struct secmap_item {
+	char name[SECMAP_NAME_SIZE];
+	u32 hash;
+	int len;
+	int next;	/* next slot on the same hash chain, 0 ends it */
+	u32 flags;
+};
+
+struct secmap {
+	struct secmap_item *items;	/* items[1..nr_items] */
+	int nr_items;
+	int max_items;
+	int nr_dummy;
+	int *buckets;
+	int nr_buckets;
+	int text_len;	/* bytes the text map takes, terminators included */
+	int text_max;
+	int corrupt;	/* the text had garbage after items[nr_items] */
+};
+
+/* room for slots 1..max_items and a text map of text_max bytes */
+int secmap_init(struct secmap *m, int max_items, int text_max);
+void secmap_free(struct secmap *m);
+void secmap_clear(struct secmap *m);
+
+/*
+ * build the index from a text map. on garbage the items in front of it
+ * are kept, -1 is returned and the next secmap_add() starts a new map.
+ */
+int secmap_load(struct secmap *m, const char *text);
+/* write the text map, zero padded to text_max bytes */
+int secmap_store(struct secmap *m, char *text);
+
+/* all of these return the slot of the item, or -1 */
+int secmap_find(struct secmap *m, const char *name, int *len);
+/* an existing item keeps its slot and length, else the first dummy is used */
+int secmap_add(struct secmap *m, const char *name, int len);
+int secmap_discard(struct secmap *m, const char *name);
+
+#endif /* __SECURE_STORAGE_MAP_H */
@@ -30,4 +30,57 @@ extern int sprite_form_sysrecovery(void);
 extern int sprite_led_init(void);
 extern int sprite_led_exit(int status);
 extern int sprite_erase_for_androidrecovery(void);
+
+/* sectors written and skipped by the differential partition writes */
+struct sprite_diff_stat {
+	u64 written;
+	u64 skipped;
+	ulong read_us;
+	ulong write_us;
+};
+
+typedef int (*sprite_diff_rw_t)(uint start_block, uint nblock, void *buffer);
+
+#ifdef CONFIG_SUNXI_SPRITE_DIFF_WRITE
+/*
+ * write nblock sectors through write(), leaving out the extents read()
+ * returns unchanged. returns nblock on success and 0 on failure, like
+ * the flash ops.
+ */
+extern int sunxi_sprite_diff_write(sprite_diff_rw_t read, sprite_diff_rw_t write,
+				   uint start, uint nblock, void *buffer,
+				   struct sprite_diff_stat *st);
+extern void sunxi_sprite_diff_report(const char *name,
+				     struct sprite_diff_stat *st);
+/* off while the flash has just been erased and nothing can match */
+extern void sunxi_sprite_diff_enable(int on);
+extern int sunxi_sprite_diff_enabled(void);
+#else
+static inline int sunxi_sprite_diff_write(sprite_diff_rw_t read,
+					  sprite_diff_rw_t write, uint start,
+					  uint nblock, void *buffer,
+					  struct sprite_diff_stat *st)
+{
+	int ret = write(start, nblock, buffer);
+
+	if (st && ret == nblock)
+		st->written += nblock;
+
+	return ret;
+}
+
+static inline void sunxi_sprite_diff_report(const char *name,
+					    struct sprite_diff_stat *st)
+{
+}
+
+static inline void sunxi_sprite_diff_enable(int on)
+{
+}
+
+static inline int sunxi_sprite_diff_enabled(void)
+{
+	return 0;
+}
+#endif
 #endif /* __SPRITE_SYS_H */
@@ -41,6 +41,14 @@ extern int sunxi_board_run_fel(void);
 extern int sunxi_board_run_fel_eraly(void);
 extern int sunxi_flash_try_partition(struct blk_desc *desc, const char *str,
 				     disk_partition_t *info);
+#ifdef CONFIG_ENV_IS_IN_SUNXI_FLASH
+/* drop the env partition offsets after the partition table changed */
+extern void env_sunxi_flash_forget_partition(void);
+#else
+static inline void env_sunxi_flash_forget_partition(void)
+{
+}
+#endif
 
 extern void sunxi_update_subsequent_processing(int next_work);
 extern void fastboot_partition_init(void);
@@ -229,6 +237,7 @@ extern int board_mmc_get_num(void);
 extern void board_mmc_pre_init(int card_num);
 extern struct mmc *sunxi_mmc_init(int sdc_no);
 extern int sunxi_mmcno_to_devnum(int sdc_no);
+void sunxi_mmc_set_dma_wait_hook(void (*hook)(void *data), void *data);
 extern int sunxi_flash_write_end(void);
 int board_env_late_init(void);
 
@@ -256,6 +265,7 @@ int sunxi_dsp_init(u32 img_addr, u32 run_ddr, u32 dsp_id);
 
 #ifdef CONFIG_RISCV_E907
 int sunxi_riscv_init(u32 img_addr, u32 run_ddr, u32 riscv_id);
+int sunxi_riscv_boot_part(const char *part_name, u32 run_ddr, u32 riscv_id);
 #endif
 
 #ifdef CONFIG_SUNXI_USB_DETECT
@@ -0,0 +1,116 @@
+/*
+ * (C) Copyright 2007-2026
+ * Allwinner Technology Co., Ltd. <www.allwinnertech.com>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Boot stage records. Every boot takes the next run of a small fixed
+ * ring, each run holds stage id, start time, duration and bytes moved.
+ * The ring sits in reserved dram so warm reboots keep it, and can be
+ * copied to a flash partition at kernel handoff so cold boots keep it
+ * too. tools/sunxi_bootrec.py decodes and compares runs.
+ */
+
+#ifndef __SUNXI_BOOT_RECORD_H__
+#define __SUNXI_BOOT_RECORD_H__
+
+#include <linux/types.h>
+
+/* stage ids, stored in the ring: only ever append */
+enum sunxi_boot_stage {
+	BOOT_REC_NONE = 0,
+	BOOT_REC_FLASH_PROBE,
+	BOOT_REC_GPT_PARSE,
+	BOOT_REC_ENV,
+	BOOT_REC_LOGO,
+	BOOT_REC_IMAGE_READ,
+	BOOT_REC_VERIFY,
+	BOOT_REC_DECOMP,
+	BOOT_REC_FDT_FIXUP,
+	BOOT_REC_HANDOFF,
+	BOOT_REC_MAX,
+};
+
+#define SUNXI_BOOT_REC_MAGIC	(0x43455242)	/* "BREC" */
+#define SUNXI_BOOT_REC_VERSION	(1)
+#define SUNXI_BOOT_REC_RUNS	(4)
+#define SUNXI_BOOT_REC_PER_RUN	(30)
+/* the whole ring, in dram and on flash */
+#define SUNXI_BOOT_REC_SIZE	(2048)
+
+/* sunxi_boot_rec.flags */
+#define SUNXI_BOOT_REC_FAIL	(1 << 0)
+
+struct sunxi_boot_rec {
+	u16 stage;
+	u16 flags;
+	u32 start_us;	/* timer_get_us() when the stage began */
+	u32 time_us;
+	u32 bytes;	/* data the stage moved, 0 if it does not apply */
+};
+
+struct sunxi_boot_run {
+	u32 seq;	/* boot counter, 0 for an unused run */
+	u16 count;
+	u16 lost;	/* records dropped because the run was full */
+	struct sunxi_boot_rec recs[SUNXI_BOOT_REC_PER_RUN];
+};
+
+struct sunxi_boot_rec_ring {
+	u32 magic;
+	u16 version;
+	u16 nr_runs;
+	u16 nr_recs;
+	u16 cur;	/* run of this boot */
+	u32 seq;	/* seq of runs[cur] */
+	struct sunxi_boot_run runs[SUNXI_BOOT_REC_RUNS];
+};
+
+#ifdef CONFIG_SUNXI_BOOT_RECORD
+int sunxi_boot_record_init(void);
+/* pick up the runs kept on flash when dram did not survive */
+int sunxi_boot_record_load(void);
+/* make the ring survive: flush it, and write it to flash if configured */
+int sunxi_boot_record_save(void);
+int sunxi_boot_record_fdt_reserve(void *blob);
+
+/*
+ *	ulong rec = sunxi_boot_record_begin();
+ *	ret = do_stage();
+ *	sunxi_boot_record(BOOT_REC_xxx, rec, bytes, ret);
+ */
+ulong sunxi_boot_record_begin(void);
+void sunxi_boot_record(int stage, ulong start, ulong bytes, int err);
+#else
+static inline int sunxi_boot_record_init(void)
+{
+	return 0;
+}
+
+static inline int sunxi_boot_record_load(void)
+{
+	return 0;
+}
+
+static inline int sunxi_boot_record_save(void)
+{
+	return 0;
+}
+
+static inline int sunxi_boot_record_fdt_reserve(void *blob)
+{
+	return 0;
+}
+
+static inline ulong sunxi_boot_record_begin(void)
+{
+	return 0;
+}
+
+static inline void sunxi_boot_record(int stage, ulong start, ulong bytes,
+				     int err)
+{
+}
+#endif
+
+#endif /* __SUNXI_BOOT_RECORD_H__ */
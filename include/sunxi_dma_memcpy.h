@@ -0,0 +1,68 @@
+/*
+ * (C) Copyright 2007-2026
+ * Allwinner Technology Co., Ltd. <www.allwinnertech.com>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * memory to memory copy/fill through the sunxi dma engine
+ */
+
+#ifndef __SUNXI_DMA_MEMCPY_H__
+#define __SUNXI_DMA_MEMCPY_H__
+
+#include <linux/types.h>
+#include <linux/string.h>
+
+/* xfer->status */
+#define SUNXI_DMA_XFER_DONE	(0)
+#define SUNXI_DMA_XFER_BUSY	(1)
+
+struct sunxi_dma_xfer;
+typedef void (*sunxi_dma_xfer_cb_t)(struct sunxi_dma_xfer *xfer, void *data);
+
+/*
+ * one outstanding copy or fill. hdma is 0 when the whole request was done
+ * by the cpu (too small, bad alignment or no free channel).
+ */
+struct sunxi_dma_xfer {
+	ulong hdma;
+	void *desc;
+	ulong dma_dst;
+	ulong dma_len;
+	ulong start;
+	int status;
+	sunxi_dma_xfer_cb_t complete;
+	void *data;
+};
+
+#ifdef CONFIG_SUNXI_DMA_MEMCPY
+/*
+ * the async calls return as soon as the engine is running; the unaligned
+ * head/tail are copied by the cpu before they return. complete() is run
+ * from sunxi_dma_xfer_poll()/sunxi_dma_xfer_wait(), or straight away when
+ * the request did not need the engine.
+ */
+int sunxi_dma_memcpy_async(struct sunxi_dma_xfer *xfer, void *dst,
+			   const void *src, size_t len,
+			   sunxi_dma_xfer_cb_t complete, void *data);
+int sunxi_dma_memset_async(struct sunxi_dma_xfer *xfer, void *dst, int c,
+			   size_t len, sunxi_dma_xfer_cb_t complete,
+			   void *data);
+int sunxi_dma_xfer_poll(struct sunxi_dma_xfer *xfer);
+int sunxi_dma_xfer_wait(struct sunxi_dma_xfer *xfer);
+
+void *sunxi_dma_memcpy(void *dst, const void *src, size_t len);
+void *sunxi_dma_memset(void *dst, int c, size_t len);
+#else
+static inline void *sunxi_dma_memcpy(void *dst, const void *src, size_t len)
+{
+	return memcpy(dst, src, len);
+}
+
+static inline void *sunxi_dma_memset(void *dst, int c, size_t len)
+{
+	return memset(dst, c, len);
+}
+#endif
+
+#endif /* __SUNXI_DMA_MEMCPY_H__ */
@@ -59,8 +59,12 @@ int sunxi_sprite_read(unsigned int start_block, unsigned int nblock,
 int sunxi_sprite_write(unsigned int start_block, unsigned int nblock,
 		       void *buffer);
 int sunxi_sprite_flush(void);
+/* like sunxi_sprite_write, the data may be queued until flush_packed */
+int sunxi_sprite_write_packed(uint start_block, uint nblock, void *buffer);
+int sunxi_sprite_flush_packed(void);
 int sunxi_sprite_erase(int erase, void *mbr_buffer);
 int sunxi_sprite_force_erase(void);
+int sunxi_sprite_erase_area(uint start_block, uint nblock);
 int sunxi_sprite_write_end(void);
 
 int sunxi_sprite_phyread(unsigned int start_block, unsigned int nblock,
@@ -78,6 +82,28 @@ int sunxi_sprite_download_spl(unsigned char *buf, int len, unsigned int ext);
 int sunxi_sprite_download_toc(unsigned char *buf, int len, unsigned int ext);
 
 int sunxi_flash_probe(void);
+
+/* sequential read-ahead, see sunxi_spinor_read_stream() */
+typedef int (*sunxi_flash_stream_cb)(void *priv, void *buf, u32 len);
+
+struct sunxi_flash_stream_stat {
+	u64 bytes;
+	ulong total_us;
+	ulong wait_us;		/* cpu idle waiting for the bus */
+	ulong cb_us;		/* time spent in the consumer */
+	u32 bus_hz;
+	int buswidth;		/* data lines */
+};
+
+int sunxi_spinor_read_stream(uint start_block, uint nblock,
+			     sunxi_flash_stream_cb cb, void *priv,
+			     struct sunxi_flash_stream_stat *stat);
+uint sunxi_spinor_sector_blocks(void);
+/* raw nand read speed with and without the cache read read-ahead */
+int rawnand_mtd_read_bench(loff_t from, size_t len);
+/* cpu time spent polling nand vs overlapped with program/erase */
+void rawnand_mtd_wait_stat(int reset);
+void spinand_mtd_wait_stat(int reset);
 int sunxi_flash_init_ext(void);
 
 int sunxi_flash_boot_init(int storage_type, int workmode);
@@ -28,10 +28,17 @@ extern int verify_image_by_vbmeta(const char *image_name,
 extern int sunxi_verify_dsp(ulong img_addr, u32 img_len, u32 dsp_id);
 #endif
 
+#ifdef CONFIG_SUNXI_VERIFY_RISCV
+extern int sunxi_verify_riscv(ulong img_addr, u32 image_len, u32 riscv_id);
+extern int sunxi_verify_riscv_hash(u8 *hash, const void *tlv, u32 riscv_id);
+#endif
+
 int sunxi_verify_mips(void *buff, uint len, void *cert, unsigned cert_len);
 
 #ifdef CONFIG_SUNXI_IMAGE_HEADER
 int sunxi_image_verify(ulong src, const char *cert_name);
+int sunxi_image_verify_tlv(const void *tlv_buf, uint8_t *hash_of_file,
+			   const char *cert_name);
 #endif
 
 #ifdef CONFIG_SUNXI_DM_VERITY
@@ -166,4 +166,9 @@ int fdt_set_normal_gpio(user_gpio_set_t  *gpio_list, int gpio_count);
 int script_parser_fetch(char *node_path, char *prop_name, int value[], int def_val);
 const char *fdt_get_regulator_name(int nodeoffset, const char *name);
 
+/* forget cached offsets, call when working_fdt is replaced or rebuilt */
+void sys_config_cache_invalidate(void);
+/* print the time spent in sys_config fdt lookups so far */
+void sys_config_lookup_report(void);
+
 #endif
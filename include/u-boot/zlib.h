@@ -724,6 +724,11 @@ ZEXTERN int ZEXPORT inflateInit2_ OF((z_streamp strm, int  windowBits,
 extern void *gzalloc(void *, unsigned, unsigned);
 extern void gzfree(void *, void *, unsigned);
 
+#ifdef CONFIG_ZLIB_INFLATE_FAST
+/* clear to run inflate on the generic zlib fast path */
+extern int inflate_fast_wide;
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -136,3 +136,18 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 	*dstn = out - dst;
 	return ret;
 }
+
+/*
+ * Decompress a single block of a frame, for callers that walk the frame
+ * themselves (e.g. while it is still streaming in). Returns the number of
+ * bytes written to dst or a negative error.
+ */
+int ulz4fn_block(const void *src, size_t srcn, void *dst, size_t dstn)
+{
+	int ret;
+
+	ret = LZ4_decompress_generic(src, dst, srcn, dstn, endOnInputSize,
+				     full, 0, noDict, dst, NULL, 0);
+
+	return ret < 0 ? -EPROTO : ret;
+}
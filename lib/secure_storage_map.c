@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * (C) Copyright 2007-2026
+ * Allwinner Technology Co., Ltd. <www.allwinnertech.com>
+ *
+ * Hashed index of the secure storage "name:len" item map.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <securestorage.h>
+#include <secure_storage_map.h>
+
+/* digits of the length field, as written by "%d" */
+#define SECMAP_LEN_SIZE		32
+
+static u32 secmap_hash(const char *name)
+{
+	u32 hash = 2166136261u;
+
+	while (*name)
+		hash = (hash ^ (u8)*name++) * 16777619u;
+
+	return hash;
+}
+
+static int secmap_is_dummy(const char *name, int len)
+{
+	return !len && !strcmp(name, SECURE_STORAGE_DUMMY_KEY_NAME);
+}
+
+/* size of "name:len\0" */
+static int secmap_entry_size(const char *name, int len)
+{
+	char tmp[SECMAP_LEN_SIZE];
+
+	return strlen(name) + 1 + sprintf(tmp, "%d", len) + 1;
+}
+
+static void secmap_link(struct secmap *m, int slot)
+{
+	struct secmap_item *item = &m->items[slot];
+	int *head;
+
+	if (item->flags & SECMAP_ITEM_DUMMY) {
+		m->nr_dummy++;
+		return;
+	}
+	item->hash = secmap_hash(item->name);
+	head = &m->buckets[item->hash & (m->nr_buckets - 1)];
+	item->next = *head;
+	*head = slot;
+}
+
+static void secmap_unlink(struct secmap *m, int slot)
+{
+	struct secmap_item *item = &m->items[slot];
+	int *p;
+
+	if (item->flags & SECMAP_ITEM_DUMMY) {
+		m->nr_dummy--;
+		return;
+	}
+	p = &m->buckets[item->hash & (m->nr_buckets - 1)];
+	while (*p && *p != slot)
+		p = &m->items[*p].next;
+	if (*p)
+		*p = item->next;
+	item->next = 0;
+}
+
+static void secmap_set(struct secmap *m, int slot, const char *name, int len)
+{
+	struct secmap_item *item = &m->items[slot];
+
+	strlcpy(item->name, name, sizeof(item->name));
+	item->len = len;
+	item->flags = secmap_is_dummy(name, len) ? SECMAP_ITEM_DUMMY : 0;
+	secmap_link(m, slot);
+}
+
+int secmap_init(struct secmap *m, int max_items, int text_max)
+{
+	memset(m, 0, sizeof(*m));
+	m->max_items = max_items;
+	m->text_max = text_max;
+	m->nr_buckets = 1;
+	while (m->nr_buckets < 2 * max_items)
+		m->nr_buckets <<= 1;
+
+	m->items = calloc(max_items + 1, sizeof(*m->items));
+	m->buckets = calloc(m->nr_buckets, sizeof(*m->buckets));
+	if (!m->items || !m->buckets) {
+		secmap_free(m);
+		return -1;
+	}
+
+	return 0;
+}
+
+void secmap_free(struct secmap *m)
+{
+	free(m->items);
+	free(m->buckets);
+	m->items = NULL;
+	m->buckets = NULL;
+}
+
+void secmap_clear(struct secmap *m)
+{
+	memset(m->buckets, 0, m->nr_buckets * sizeof(*m->buckets));
+	m->nr_items = 0;
+	m->nr_dummy = 0;
+	m->text_len = 0;
+	m->corrupt = 0;
+}
+
+int secmap_load(struct secmap *m, const char *text)
+{
+	char name[SECMAP_NAME_SIZE], length[SECMAP_LEN_SIZE];
+	const char *p = text, *end = text + m->text_max;
+	int i, j;
+
+	secmap_clear(m);
+	while (p < end && *p) {
+		for (i = 0, j = 0; p + i < end && p[i] != ':' && p[i] &&
+		     j < SECMAP_NAME_SIZE - 1; i++, j++)
+			name[j] = p[i];
+		name[j] = '\0';
+		if (p + i >= end || p[i] != ':')
+			goto corrupt;
+
+		for (i++, j = 0; p + i < end && p[i] != ' ' && p[i] &&
+		     j < SECMAP_LEN_SIZE - 1; i++, j++)
+			length[j] = p[i];
+		length[j] = '\0';
+		if (p + i >= end || (p[i] && p[i] != ' '))
+			goto corrupt;
+		if (m->nr_items == m->max_items)
+			goto corrupt;
+
+		secmap_set(m, ++m->nr_items, name,
+			   simple_strtoul(length, NULL, 10));
+		i = strnlen(p, end - p) + 1;
+		m->text_len += i;
+		p += i;
+	}
+
+	return 0;
+
+corrupt:
+	m->corrupt = 1;
+	return -1;
+}
+
+int secmap_store(struct secmap *m, char *text)
+{
+	struct secmap_item *item;
+	int slot, off = 0;
+
+	if (m->text_len >= m->text_max)
+		return -1;
+
+	for (slot = 1; slot <= m->nr_items; slot++) {
+		item = &m->items[slot];
+		off += sprintf(text + off, "%s:%d", item->name, item->len) + 1;
+	}
+	memset(text + off, 0, m->text_max - off);
+
+	return 0;
+}
+
+int secmap_find(struct secmap *m, const char *name, int *len)
+{
+	u32 hash = secmap_hash(name);
+	int slot = m->buckets[hash & (m->nr_buckets - 1)];
+
+	for (; slot; slot = m->items[slot].next) {
+		if (m->items[slot].hash == hash &&
+		    !strcmp(m->items[slot].name, name)) {
+			if (len)
+				*len = m->items[slot].len;
+			return slot;
+		}
+	}
+
+	return -1;
+}
+
+int secmap_add(struct secmap *m, const char *name, int len)
+{
+	int slot, size;
+
+	if (strlen(name) >= SECMAP_NAME_SIZE)
+		return -1;
+	if (m->corrupt) {
+		pr_msg("secure storage map: dirty map, start a new one\n");
+		secmap_clear(m);
+	}
+
+	slot = secmap_find(m, name, NULL);
+	if (slot > 0)
+		return slot;
+
+	size = secmap_entry_size(name, len);
+	if (m->nr_dummy) {
+		for (slot = 1; slot <= m->nr_items; slot++)
+			if (m->items[slot].flags & SECMAP_ITEM_DUMMY)
+				break;
+		size -= secmap_entry_size(m->items[slot].name,
+					  m->items[slot].len);
+		if (m->text_len + size >= m->text_max)
+			return -1;
+		secmap_unlink(m, slot);
+	} else {
+		if (m->nr_items == m->max_items ||
+		    m->text_len + size >= m->text_max)
+			return -1;
+		slot = ++m->nr_items;
+	}
+
+	m->text_len += size;
+	secmap_set(m, slot, name, len);
+
+	return slot;
+}
+
+int secmap_discard(struct secmap *m, const char *name)
+{
+	int slot = secmap_find(m, name, NULL);
+
+	if (slot < 0)
+		return -1;
+
+	m->text_len += secmap_entry_size(SECURE_STORAGE_DUMMY_KEY_NAME, 0) -
+		       secmap_entry_size(name, m->items[slot].len);
+	secmap_unlink(m, slot);
+	secmap_set(m, slot, SECURE_STORAGE_DUMMY_KEY_NAME, 0);
+
+	return slot;
+}
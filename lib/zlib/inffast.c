@@ -66,7 +66,11 @@
       requires strm->avail_out >= 258 for each loop to avoid checking for
       output space.
  */
+#ifdef CONFIG_ZLIB_INFLATE_FAST
+local void inflate_fast_generic(z_streamp strm, unsigned start)
+#else
 void inflate_fast(z_streamp strm, unsigned start)
+#endif
 /* start: inflate()'s starting value for strm->avail_out */
 {
     struct inflate_state FAR *state;
@@ -339,6 +343,281 @@ void inflate_fast(z_streamp strm, unsigned start)
     return;
 }
 
+#ifdef CONFIG_ZLIB_INFLATE_FAST
+/*
+   Wide variant of inflate_fast() for 32 and 64 bit ARM, with the same entry
+   and exit conditions and the same output:
+
+    - The bit buffer is 64 bits and is refilled from aligned 32 bit words,
+      a single ldr on ARM even when built with -mno-unaligned-access.  The
+      first bytes are taken one at a time until the input is word aligned.
+      A refill before the literal/length code and one before the distance
+      code keep at least 32 bits in the buffer, more than either code with
+      its extra bits needs (20 and 28 bits, see above), so no input checks
+      are needed until the next literal or match.
+
+    - Matches at least 16 bytes back in the output are copied 16 bytes at a
+      time and may write up to 15 bytes past their end.  Closer ones are
+      copied 8 bytes at a time, after the first bytes of a period shorter
+      than 8 have been written one by one; distance 1 is a memset.
+
+    - inflate() builds the literal/length table with 10 root bits instead of
+      9 (see inflate_fast_lenbits()), so fewer codes need a second lookup.
+
+   A literal or match reads at most two words and matches write ahead, so
+   the loop stops INFLATE_FAST_IN_SLACK/OUT_SLACK bytes before the end of
+   the buffers (the input slack also covers the alignment bytes) and
+   inflate_fast_generic() handles buffers too short for it.
+
+   inflate_fast_wide can be cleared to benchmark the generic code.
+ */
+#define INFLATE_FAST_CHUNK	16
+#define INFLATE_FAST_IN_SLACK	12
+#define INFLATE_FAST_OUT_SLACK	(258 + INFLATE_FAST_CHUNK - 1)
+
+int inflate_fast_wide = 1;
+
+local unsigned inflate_fast_lenbits(void)
+{
+    return inflate_fast_wide ? 10 : 9;
+}
+
+/* the bytes above bits are always zero, so a word can simply be or-ed in */
+#define INFLATE_FAST_PULLWORD() \
+    do { \
+        hold |= (u64)le32_to_cpup((const __le32 *)in) << bits; \
+        in += 4; \
+        bits += 32; \
+    } while (0)
+
+/* copy a len byte match from dist bytes back, may overrun by CHUNK - 1 */
+local inline unsigned char FAR *inflate_fast_copy(unsigned char FAR *out,
+                                                  unsigned dist, unsigned len)
+{
+    unsigned char FAR *from = out - dist;
+    unsigned char FAR *end = out + len;
+    unsigned n;
+
+    if (dist >= INFLATE_FAST_CHUNK) {
+        do {
+            __builtin_memcpy(out, from, INFLATE_FAST_CHUNK);
+            out += INFLATE_FAST_CHUNK;
+            from += INFLATE_FAST_CHUNK;
+        } while (out < end);
+    }
+    else if (dist == 1) {
+        memset(out, *from, len);
+    }
+    else {
+        if (dist < 8) {
+            /* write whole periods until a multiple of dist is >= 8 */
+            n = min(len, (8 + dist - 1) / dist * dist);
+            dist = n;
+            while (n--)
+                *out++ = *from++;
+            from = out - dist;
+        }
+        while (out < end) {
+            __builtin_memcpy(out, from, 8);
+            out += 8;
+            from += 8;
+        }
+    }
+    return end;
+}
+
+void inflate_fast(z_streamp strm, unsigned start)
+/* start: inflate()'s starting value for strm->avail_out */
+{
+    struct inflate_state FAR *state;
+    unsigned char FAR *in;      /* local strm->next_in */
+    unsigned char FAR *last;    /* while in < last, 8 bytes can be loaded */
+    unsigned char FAR *out;     /* local strm->next_out */
+    unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
+    unsigned char FAR *end;     /* while out < end, a match plus overrun fits */
+#ifdef INFLATE_STRICT
+    unsigned dmax;              /* maximum distance from zlib header */
+#endif
+    unsigned wsize;             /* window size or zero if not using window */
+    unsigned whave;             /* valid bytes in the window */
+    unsigned write;             /* window write index */
+    unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+    u64 hold;                   /* local strm->hold */
+    unsigned bits;              /* local strm->bits */
+    code const FAR *lcode;      /* local strm->lencode */
+    code const FAR *dcode;      /* local strm->distcode */
+    unsigned lmask;             /* mask for first level of length codes */
+    unsigned dmask;             /* mask for first level of distance codes */
+    code this;                  /* retrieved table entry */
+    unsigned op;                /* code bits, operation, extra bits, or */
+                                /*  window position, window bytes to copy */
+    unsigned len;               /* match length, unused bytes */
+    unsigned dist;              /* match distance */
+    unsigned char FAR *from;    /* where to copy match from */
+
+    if (!inflate_fast_wide ||
+        strm->avail_in <= INFLATE_FAST_IN_SLACK ||
+        strm->avail_out <= INFLATE_FAST_OUT_SLACK ||
+        strm->next_in + strm->avail_in < strm->next_in) {
+        inflate_fast_generic(strm, start);
+        return;
+    }
+
+    /* copy state to local variables */
+    state = (struct inflate_state FAR *)strm->state;
+    in = strm->next_in;
+    last = in + (strm->avail_in - INFLATE_FAST_IN_SLACK);
+    out = strm->next_out;
+    beg = out - (start - strm->avail_out);
+    end = out + (strm->avail_out - INFLATE_FAST_OUT_SLACK);
+#ifdef INFLATE_STRICT
+    dmax = state->dmax;
+#endif
+    wsize = state->wsize;
+    whave = state->whave;
+    write = state->write;
+    window = state->window;
+    hold = state->hold;
+    bits = state->bits;
+    lcode = state->lencode;
+    dcode = state->distcode;
+    lmask = (1U << state->lenbits) - 1;
+    dmask = (1U << state->distbits) - 1;
+
+    /* inflate() hands over at most 32 bits, room for the alignment bytes */
+    while ((unsigned long)in & 3) {
+        hold |= (u64)*in++ << bits;
+        bits += 8;
+    }
+
+    /* decode literals and length/distances until end-of-block or not enough
+       input data or output space */
+    do {
+        if (bits < 32)
+            INFLATE_FAST_PULLWORD();
+        this = lcode[hold & lmask];
+      dolen:
+        op = (unsigned)(this.bits);
+        hold >>= op;
+        bits -= op;
+        op = (unsigned)(this.op);
+        if (op == 0) {                          /* literal */
+            Tracevv((stderr, this.val >= 0x20 && this.val < 0x7f ?
+                    "inflate:         literal '%c'\n" :
+                    "inflate:         literal 0x%02x\n", this.val));
+            *out++ = (unsigned char)(this.val);
+        }
+        else if (op & 16) {                     /* length base */
+            len = (unsigned)(this.val);
+            op &= 15;                           /* number of extra bits */
+            len += (unsigned)hold & ((1U << op) - 1);
+            hold >>= op;
+            bits -= op;
+            Tracevv((stderr, "inflate:         length %u\n", len));
+            if (bits < 32)
+                INFLATE_FAST_PULLWORD();
+            this = dcode[hold & dmask];
+          dodist:
+            op = (unsigned)(this.bits);
+            hold >>= op;
+            bits -= op;
+            op = (unsigned)(this.op);
+            if (op & 16) {                      /* distance base */
+                dist = (unsigned)(this.val);
+                op &= 15;                       /* number of extra bits */
+                dist += (unsigned)hold & ((1U << op) - 1);
+#ifdef INFLATE_STRICT
+                if (dist > dmax) {
+                    strm->msg = (char *)"invalid distance too far back";
+                    state->mode = BAD;
+                    break;
+                }
+#endif
+                hold >>= op;
+                bits -= op;
+                Tracevv((stderr, "inflate:         distance %u\n", dist));
+                op = (unsigned)(out - beg);     /* max distance in output */
+                if (dist > op) {                /* see if copy from window */
+                    op = dist - op;             /* distance back in window */
+                    if (op > whave) {
+                        strm->msg = (char *)"invalid distance too far back";
+                        state->mode = BAD;
+                        break;
+                    }
+                    from = window;
+                    if (write == 0) {           /* very common case */
+                        from += wsize - op;
+                    }
+                    else if (write < op) {      /* wrap around window */
+                        from += wsize + write - op;
+                        op -= write;
+                        if (op < len) {         /* some from end of window */
+                            memcpy(out, from, op);
+                            out += op;
+                            len -= op;
+                            from = window;
+                            op = write;
+                        }
+                    }
+                    else {                      /* contiguous in window */
+                        from += write - op;
+                    }
+                    if (op >= len) {            /* all of it from window */
+                        memcpy(out, from, len);
+                        out += len;
+                    }
+                    else {                      /* rest from output */
+                        memcpy(out, from, op);
+                        out = inflate_fast_copy(out + op, dist, len - op);
+                    }
+                }
+                else {
+                    out = inflate_fast_copy(out, dist, len);
+                }
+            }
+            else if ((op & 64) == 0) {          /* 2nd level distance code */
+                this = dcode[this.val + (hold & ((1U << op) - 1))];
+                goto dodist;
+            }
+            else {
+                strm->msg = (char *)"invalid distance code";
+                state->mode = BAD;
+                break;
+            }
+        }
+        else if ((op & 64) == 0) {              /* 2nd level length code */
+            this = lcode[this.val + (hold & ((1U << op) - 1))];
+            goto dolen;
+        }
+        else if (op & 32) {                     /* end-of-block */
+            Tracevv((stderr, "inflate:         end of block\n"));
+            state->mode = TYPE;
+            break;
+        }
+        else {
+            strm->msg = (char *)"invalid literal/length code";
+            state->mode = BAD;
+            break;
+        }
+    } while (in < last && out < end);
+
+    /* return unused bytes */
+    len = bits >> 3;
+    in -= len;
+    bits -= len << 3;
+    hold &= (1U << bits) - 1;
+
+    /* update state and return */
+    strm->next_in = in;
+    strm->next_out = out;
+    strm->avail_in = (unsigned)(last - in) + INFLATE_FAST_IN_SLACK;
+    strm->avail_out = (unsigned)(end - out) + INFLATE_FAST_OUT_SLACK;
+    state->hold = (unsigned long)hold;
+    state->bits = bits;
+    return;
+}
+#endif /* CONFIG_ZLIB_INFLATE_FAST */
+
 /*
    inflate_fast() speedups that turned out slower (on a PowerPC G3 750CXe):
    - Using bit fields for code structure
@@ -701,7 +701,11 @@ int ZEXPORT inflate(z_streamp strm, int flush)
             /* build code tables */
             state->next = state->codes;
             state->lencode = (code const FAR *)(state->next);
+#ifdef CONFIG_ZLIB_INFLATE_FAST
+            state->lenbits = inflate_fast_lenbits();
+#else
             state->lenbits = 9;
+#endif
             ret = inflate_table(LENS, state->lens, state->nlen, &(state->next),
                                 &(state->lenbits), state->work);
             if (ret) {
@@ -8,6 +8,7 @@
 #include <common.h>
 #include <malloc.h>
 #include <sunxi_flash.h>
+#include <sunxi_dma_memcpy.h>
 #include "imgdecode.h"
 #include "imagefile_new.h"
 #include "../sprite_card.h"
@@ -462,7 +463,7 @@ uint Img_ReadItem(HIMAGE hImage, HIMAGEITEM hItem, void *buffer,
 
 		return 0;
 	}
-	memcpy(buffer, tmp, buffer_size);
+	sunxi_dma_memcpy(buffer, tmp, buffer_size);
 	free(tmp);
 
 	return buffer_size;
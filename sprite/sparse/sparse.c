@@ -186,7 +186,7 @@ int unsparse_direct_write(void *pbuf, uint length)
 					0;
 			if (!unenough_length) {
 				//数据足够，直接写入
-				if (!sunxi_sprite_write(flash_start,
+				if (!sunxi_sprite_write_packed(flash_start,
 							chunk_length >> 9,
 							tmp_buf)) {
 					printf("sparse: flash write failed\n");
@@ -272,8 +272,8 @@ int unsparse_direct_write(void *pbuf, uint length)
 				for (ii = 0; ii < sizeof(fillbuf)/sizeof(fillbuf[0]); ii++)
 					fillbuf[ii] = file_val;
 				for (ii = 0; ii < (chunk_length >> 12); ii++) {
-					if (!sunxi_sprite_write(flash_start, 8,
-								fillbuf)) {
+					if (!sunxi_sprite_write_packed(flash_start,
+								       8, fillbuf)) {
 						printf("sparse: fill data write failed\n");
 
 						return -1;
@@ -302,6 +302,14 @@ int unsparse_direct_write(void *pbuf, uint length)
 		}
 	}
 
+	/* the last chunks may still sit in the packed write queue */
+	if (chunk_count == total_chunks &&
+	    sparse_format_type == SPARSE_FORMAT_TYPE_CHUNK_HEAD &&
+	    sunxi_sprite_flush_packed()) {
+		printf("sparse: flash write failed\n");
+		return -1;
+	}
+
 	return 0;
 }
 /*
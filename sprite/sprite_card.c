@@ -277,6 +277,7 @@ static int __download_normal_part(dl_one_part_info *part_info,
 	u8 *down_buffer = source_buff + SPRITE_CARD_HEAD_BUFF;
 
 	int partdata_format;
+	struct sprite_diff_stat diff = { 0 };
 
 	int ret = -1;
 	//*******************************************************************
@@ -361,9 +362,11 @@ static int __download_normal_part(dl_one_part_info *part_info,
 					 partstart_by_sector); //判断数据格式
 	if (partdata_format != ANDROID_FORMAT_DETECT) {
 		//写入第一笔数据
-		if (sunxi_sprite_write(tmp_partstart_by_sector,
-				       onetime_read_sectors,
-				       down_buffer) != onetime_read_sectors) {
+		if (sunxi_sprite_diff_write(sunxi_sprite_read,
+					    sunxi_sprite_write,
+					    tmp_partstart_by_sector,
+					    onetime_read_sectors, down_buffer,
+					    &diff) != onetime_read_sectors) {
 			printf("sunxi sprite error: download rawdata error %s\n",
 			       part_info->dl_filename);
 
@@ -385,9 +388,11 @@ static int __download_normal_part(dl_one_part_info *part_info,
 				goto __download_normal_part_err1;
 			}
 			//写入flash
-			if (sunxi_sprite_write(tmp_partstart_by_sector,
-					       SPRITE_CARD_ONCE_SECTOR_DEAL,
-					       down_buffer) !=
+			if (sunxi_sprite_diff_write(sunxi_sprite_read,
+						    sunxi_sprite_write,
+						    tmp_partstart_by_sector,
+						    SPRITE_CARD_ONCE_SECTOR_DEAL,
+						    down_buffer, &diff) !=
 			    SPRITE_CARD_ONCE_SECTOR_DEAL) {
 				printf("sunxi sprite error: download rawdata error %s, start 0x%x, sectors 0x%x\n",
 				       part_info->dl_filename,
@@ -411,9 +416,11 @@ static int __download_normal_part(dl_one_part_info *part_info,
 				goto __download_normal_part_err1;
 			}
 			//写入flash
-			if (sunxi_sprite_write(tmp_partstart_by_sector,
-					       rest_sectors,
-					       down_buffer) != rest_sectors) {
+			if (sunxi_sprite_diff_write(sunxi_sprite_read,
+						    sunxi_sprite_write,
+						    tmp_partstart_by_sector,
+						    rest_sectors, down_buffer,
+						    &diff) != rest_sectors) {
 				printf("sunxi sprite error: download rawdata error %s, start 0x%x, sectors 0x%x\n",
 				       part_info->dl_filename,
 				       tmp_partstart_by_sector, rest_sectors);
@@ -475,6 +482,7 @@ static int __download_normal_part(dl_one_part_info *part_info,
 	}
 
 	tick_printf("successed in writting part %s\n", part_info->name);
+	sunxi_sprite_diff_report((char *)part_info->name, &diff);
 	ret = 0;
 	if (imgitemhd) {
 		Img_CloseItem(imghd, imgitemhd);
@@ -1456,77 +1464,178 @@ int card_download_standard_mbr(void *buffer)
 #define CARD_ERASE_BLOCK_BYTES (8 * 1024 * 1024)
 #define CARD_ERASE_BLOCK_SECTORS (CARD_ERASE_BLOCK_BYTES / 512)
 
-int card_erase(int erase, void *mbr_buffer)
+/*
+ * partitions that follow each other on the card are erased as one extent,
+ * so the erase group alignment and the zero writes it leaves behind are
+ * only paid at the edges of the extent instead of at every partition.
+ */
+struct card_erase_extent {
+	unsigned int from;
+	unsigned int nr;
+	int first;	/* index into the sorted partition list */
+	int last;
+};
+
+/* the old fallback: zero the head and the tail of a single partition */
+static int card_erase_part_fallback(sunxi_mbr_t *mbr, int i,
+				    char *erase_buffer, unsigned int *zeroed)
 {
-	char *erase_buffer;
-	sunxi_mbr_t *mbr = (sunxi_mbr_t *)mbr_buffer;
 	unsigned int erase_head_sectors;
 	unsigned int erase_head_addr;
 	unsigned int erase_tail_sectors;
 	unsigned int erase_tail_addr;
+
+	// part > 16M
+	if (mbr->array[i].lenlo > CARD_ERASE_BLOCK_SECTORS * 2) {
+		erase_head_sectors = CARD_ERASE_BLOCK_SECTORS;
+		erase_head_addr    = mbr->array[i].addrlo;
+		//erase_tail_sectors = CARD_ERASE_BLOCK_SECTORS;
+		erase_tail_sectors = 2 * 1024 * 1024 / 512;
+		erase_tail_addr    = mbr->array[i].addrlo +
+				  mbr->array[i].lenlo -
+				  CARD_ERASE_BLOCK_SECTORS;
+		// 8M < part <= 16M
+	} else if (mbr->array[i].lenlo > CARD_ERASE_BLOCK_SECTORS) {
+		erase_head_sectors = CARD_ERASE_BLOCK_SECTORS;
+		erase_head_addr    = mbr->array[i].addrlo;
+		//erase_tail_sectors = mbr->array[i].lenlo - CARD_ERASE_BLOCK_SECTORS;
+		erase_tail_sectors = 2 * 1024 * 1024 / 512;
+		erase_tail_addr    = mbr->array[i].addrlo +
+				  mbr->array[i].lenlo -
+				  erase_tail_sectors;
+		// 0 < part <= 8M
+	} else if (mbr->array[i].lenlo > 0) {
+		erase_head_sectors = mbr->array[i].lenlo;
+		erase_head_addr    = mbr->array[i].addrlo;
+		erase_tail_sectors = 0;
+		erase_tail_addr    = mbr->array[i].addrlo;
+	} else {
+		//printf("don't deal prat's length is 0 (%s) \n", mbr->array[i].name);
+		//break;
+		erase_head_sectors = CARD_ERASE_BLOCK_SECTORS;
+		erase_head_addr    = mbr->array[i].addrlo;
+		erase_tail_sectors = 0;
+		erase_tail_addr    = mbr->array[i].addrlo;
+	}
+
+	// erase head for partition
+	if (!sunxi_sprite_write(erase_head_addr,
+			       erase_head_sectors,
+			       erase_buffer)) {
+		debug("card erase fail in erasing part %s\n",
+		       mbr->array[i].name);
+		return -1;
+	}
+	*zeroed += erase_head_sectors;
+	debug("erase prat's head from sector 0x%x to 0x%x\n",
+	       erase_head_addr,
+	       erase_head_addr + erase_head_sectors);
+
+	// erase tail for partition
+	if (erase_tail_sectors) {
+		if (!sunxi_sprite_write(erase_tail_addr,
+				       erase_tail_sectors,
+				       erase_buffer)) {
+			debug("card erase fail in erasing part %s\n",
+			       mbr->array[i].name);
+			return -1;
+		}
+		*zeroed += erase_tail_sectors;
+		debug("erase part's tail from sector 0x%x to 0x%x\n",
+		       erase_tail_addr,
+		       erase_tail_addr + erase_tail_sectors);
+	}
+
+	return 0;
+}
+
+/*
+ * sort the partitions by address into order[] and merge the ones that
+ * touch or overlap into extents. a partition of length 0 runs to the end
+ * of the card and is always kept on its own.
+ */
+static int card_erase_plan(sunxi_mbr_t *mbr, unsigned int offset, int *order,
+			   struct card_erase_extent *ext)
+{
+	struct card_erase_extent *cur = NULL;
+	unsigned int from, end;
+	int i, j, n = 0, count = 0;
+
+	for (i = 1; i < mbr->PartCount; i++) {
+		for (j = n; j > 0 &&
+		     mbr->array[order[j - 1]].addrlo > mbr->array[i].addrlo; j--)
+			order[j] = order[j - 1];
+		order[j] = i;
+		n++;
+	}
+
+	for (j = 0; j < n; j++) {
+		i    = order[j];
+		from = mbr->array[i].addrlo + offset;
+		end  = from + mbr->array[i].lenlo;
+		if (cur && cur->nr && mbr->array[i].lenlo &&
+		    from <= cur->from + cur->nr) {
+			if (end > cur->from + cur->nr)
+				cur->nr = end - cur->from;
+			cur->last = j;
+			continue;
+		}
+		cur = &ext[count++];
+		cur->from  = from;
+		cur->nr    = mbr->array[i].lenlo;
+		cur->first = j;
+		cur->last  = j;
+	}
+
+	return count;
+}
+
+int card_erase(int erase, void *mbr_buffer)
+{
+	char *erase_buffer;
+	sunxi_mbr_t *mbr = (sunxi_mbr_t *)mbr_buffer;
+	struct card_erase_extent *ext;
 	unsigned int skip_space[1 + 2 * 2] = { 0 };
-	unsigned int from, nr;
+	unsigned int from, nr, erased = 0, zeroed = 0;
+	ulong time;
+	int *order;
 	int k, ret = 0;
-	int i;
+	int i, j, count;
 
 	tick_printf("erase all part start\n");
 	if (!erase) {
 		return 0;
 	}
+	time = get_timer(0);
 	erase_buffer = (char *)memalign(CONFIG_SYS_CACHELINE_SIZE, ALIGN(CARD_ERASE_BLOCK_BYTES, CONFIG_SYS_CACHELINE_SIZE));
-	if (!erase_buffer) {
+	order = malloc(mbr->PartCount * sizeof(*order));
+	ext = malloc(mbr->PartCount * sizeof(*ext));
+	if (!erase_buffer || !order || !ext) {
 		debug("card erase fail: unable to malloc memory for card erase\n");
-
-		return -1;
+		ret = -1;
+		goto out;
 	}
 	memset(erase_buffer, 0, ALIGN(CARD_ERASE_BLOCK_BYTES, CONFIG_SYS_CACHELINE_SIZE));
 
 	//erase boot0,write 0x00
 	if (card_erase_boot0(32 * 1024, erase_buffer, get_boot_storage_type())) {
-		return -1;
+		ret = -1;
+		goto out;
 	}
 
-	for (i = 1; i < mbr->PartCount; i++) {
-		printf("erase %s part\n", mbr->array[i].name);
-		// part > 16M
-		if (mbr->array[i].lenlo > CARD_ERASE_BLOCK_SECTORS * 2) {
-			erase_head_sectors = CARD_ERASE_BLOCK_SECTORS;
-			erase_head_addr    = mbr->array[i].addrlo;
-			//erase_tail_sectors = CARD_ERASE_BLOCK_SECTORS;
-			erase_tail_sectors = 2 * 1024 * 1024 / 512;
-			erase_tail_addr    = mbr->array[i].addrlo +
-					  mbr->array[i].lenlo -
-					  CARD_ERASE_BLOCK_SECTORS;
-			// 8M < part <= 16M
-		} else if (mbr->array[i].lenlo > CARD_ERASE_BLOCK_SECTORS) {
-			erase_head_sectors = CARD_ERASE_BLOCK_SECTORS;
-			erase_head_addr    = mbr->array[i].addrlo;
-			//erase_tail_sectors = mbr->array[i].lenlo - CARD_ERASE_BLOCK_SECTORS;
-			erase_tail_sectors = 2 * 1024 * 1024 / 512;
-			erase_tail_addr    = mbr->array[i].addrlo +
-					  mbr->array[i].lenlo -
-					  erase_tail_sectors;
-			// 0 < part <= 8M
-		} else if (mbr->array[i].lenlo > 0) {
-			erase_head_sectors = mbr->array[i].lenlo;
-			erase_head_addr    = mbr->array[i].addrlo;
-			erase_tail_sectors = 0;
-			erase_tail_addr    = mbr->array[i].addrlo;
-		} else {
-			//printf("don't deal prat's length is 0 (%s) \n", mbr->array[i].name);
-			//break;
-			erase_head_sectors = CARD_ERASE_BLOCK_SECTORS;
-			erase_head_addr    = mbr->array[i].addrlo;
-			erase_tail_sectors = 0;
-			erase_tail_addr    = mbr->array[i].addrlo;
-		}
+	count = card_erase_plan(mbr, sunxi_flashmap_logical_offset(FLASHMAP_SDMMC, LINUX_LOGIC_OFFSET),
+				order, ext);
+	for (i = 0; i < count; i++) {
+		printf("erase part");
+		for (j = ext[i].first; j <= ext[i].last; j++)
+			printf(" %s", mbr->array[order[j]].name);
+		printf(": sector 0x%x, count 0x%x\n", ext[i].from, ext[i].nr);
 
-		from = mbr->array[i].addrlo + sunxi_flashmap_logical_offset(FLASHMAP_SDMMC, LINUX_LOGIC_OFFSET);
-		nr   = mbr->array[i].lenlo;
-		ret  = sunxi_sprite_phyerase(from, nr, skip_space);
+		ret = sunxi_sprite_phyerase(ext[i].from, ext[i].nr, skip_space);
 		if (ret == 0) {
-			//printf("erase part from sector 0x%x to 0x%x ok\n", from, (from+nr-1));
+			erased += ext[i].nr;
 		} else if (ret == 1) {
+			erased += ext[i].nr;
 			for (k = 0; k < 2; k++) {
 				if (skip_space[0] & (1 << k)) {
 					debug("write zeros-%d: from 0x%x to 0x%x\n",
@@ -1538,48 +1647,37 @@ int card_erase(int erase, void *mbr_buffer)
 					if (!sunxi_sprite_phywrite(
 						    from, nr, erase_buffer)) {
 						debug("card erase fail in erasing part %s\n",
-						       mbr->array[i].name);
-						free(erase_buffer);
-						return -1;
+						       mbr->array[order[ext[i].first]].name);
+						ret = -1;
+						goto out;
 					}
+					erased -= nr;
+					zeroed += nr;
 				}
 			}
 		} else if (ret == -1) {
-			// erase head for partition
-			if (!sunxi_sprite_write(erase_head_addr,
-					       erase_head_sectors,
-					       erase_buffer)) {
-				debug("card erase fail in erasing part %s\n",
-				       mbr->array[i].name);
-				free(erase_buffer);
-				return -1;
-			}
-			debug("erase prat's head from sector 0x%x to 0x%x\n",
-			       erase_head_addr,
-			       erase_head_addr + erase_head_sectors);
-
-			// erase tail for partition
-			if (erase_tail_sectors) {
-				if (!sunxi_sprite_write(erase_tail_addr,
-						       erase_tail_sectors,
-						       erase_buffer)) {
-					debug("card erase fail in erasing part %s\n",
-					       mbr->array[i].name);
-					free(erase_buffer);
-					return -1;
+			for (j = ext[i].first; j <= ext[i].last; j++) {
+				if (card_erase_part_fallback(mbr, order[j],
+							     erase_buffer,
+							     &zeroed)) {
+					ret = -1;
+					goto out;
 				}
-				debug("erase part's tail from sector 0x%x to 0x%x\n",
-				       erase_tail_addr,
-				       erase_tail_addr + erase_tail_sectors);
 			}
 		}
 	}
-	printf("card erase all\n");
-	free(erase_buffer);
+	ret = 0;
+	printf("card erase all: %d parts in %d extents, erased 0x%x sectors, "
+	       "zeroed 0x%x sectors, %lu ms\n", mbr->PartCount - 1, count,
+	       erased, zeroed, get_timer(time));
 
 	//while((*(volatile unsigned int *)0) != 1);
 	//tick_printf("erase all part end\n");
-	return 0;
+out:
+	free(ext);
+	free(order);
+	free(erase_buffer);
+	return ret;
 }
 
 #define BOOT0_MAX_SIZE (32 * 1024)
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * (C) Copyright 2007-2026
+ * Allwinner Technology Co., Ltd. <www.allwinnertech.com>
+ *
+ * Differential partition writes.
+ *
+ * Re-burning or updating a board mostly writes back what flash already
+ * holds. Every extent is read back first and only the ones that differ
+ * are written; neighbouring dirty extents go out as one write so the
+ * flash still sees large requests. Reads cost a fraction of a program
+ * (and nothing in wear), which is what makes this pay off on nand and
+ * nor, and on emmc as soon as a good part of the image is unchanged.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <sprite.h>
+#include <linux/math64.h>
+
+#define DIFF_EXTENT_SECTORS	(64 * 1024 / 512)
+
+static int sprite_diff_on = 1;
+
+void sunxi_sprite_diff_enable(int on)
+{
+	sprite_diff_on = on;
+}
+
+int sunxi_sprite_diff_enabled(void)
+{
+	return sprite_diff_on;
+}
+
+static int sprite_diff_flush(sprite_diff_rw_t write, uint start, uint nblock,
+			     u8 *buf, struct sprite_diff_stat *st)
+{
+	ulong t;
+
+	if (!nblock)
+		return 0;
+
+	t = timer_get_us();
+	if (write(start, nblock, buf) != nblock) {
+		printf("sprite diff: write 0x%x, sectors 0x%x failed\n",
+		       start, nblock);
+		return -1;
+	}
+	st->write_us += timer_get_us() - t;
+	st->written += nblock;
+
+	return 0;
+}
+
+int sunxi_sprite_diff_write(sprite_diff_rw_t read, sprite_diff_rw_t write,
+			    uint start, uint nblock, void *buffer,
+			    struct sprite_diff_stat *st)
+{
+	struct sprite_diff_stat dummy = { 0 };
+	u8 *buf = buffer;
+	u8 *cmp = NULL;
+	uint off, n, run = 0, dirty = 0;
+	ulong t;
+	int same;
+
+	if (!st)
+		st = &dummy;
+
+	if (sprite_diff_on)
+		cmp = memalign(CONFIG_SYS_CACHELINE_SIZE,
+			       DIFF_EXTENT_SECTORS * 512);
+	if (!cmp)
+		return sprite_diff_flush(write, start, nblock, buf, st) ?
+		       0 : nblock;
+
+	for (off = 0; off < nblock; off += n) {
+		n = min(nblock - off, (uint)DIFF_EXTENT_SECTORS);
+
+		/* an extent that cannot be read back is simply written */
+		t = timer_get_us();
+		same = read(start + off, n, cmp) == n &&
+		       !memcmp(cmp, buf + off * 512, n * 512);
+		st->read_us += timer_get_us() - t;
+
+		if (!same) {
+			if (!dirty)
+				run = off;
+			dirty += n;
+			continue;
+		}
+
+		if (sprite_diff_flush(write, start + run, dirty,
+				      buf + run * 512, st))
+			goto fail;
+		dirty = 0;
+		st->skipped += n;
+	}
+
+	if (sprite_diff_flush(write, start + run, dirty, buf + run * 512, st))
+		goto fail;
+
+	free(cmp);
+	return nblock;
+
+fail:
+	free(cmp);
+	return 0;
+}
+
+void sunxi_sprite_diff_report(const char *name, struct sprite_diff_stat *st)
+{
+	u64 total = st->written + st->skipped;
+
+	if (!total)
+		return;
+
+	printf("%s: wrote %llu KB, skipped %llu KB unchanged (%u%%), "
+	       "read %lu ms, write %lu ms\n", name, st->written / 2,
+	       st->skipped / 2, (uint)div64_u64(st->skipped * 100, total),
+	       st->read_us / 1000, st->write_us / 1000);
+}
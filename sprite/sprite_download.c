@@ -143,6 +143,7 @@ int sunxi_sprite_download_mbr(void *buffer, uint buffer_size)
 	}
 	pr_msg("update partition map\n");
 	sunxi_probe_partition_map();
+	env_sunxi_flash_forget_partition();
 
 	return ret;
 
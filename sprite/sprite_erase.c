@@ -35,17 +35,128 @@
 #include "sprite_privatedata.h"
 #include <nand.h>
 #include <sprite_download.h>
+#include <sprite.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/*
+ * storage where everything outside the protected partitions can be erased
+ * without touching them. nand erases its whole logical space at once.
+ */
+static int sprite_erase_can_skip_prvt(void)
+{
+	switch (get_boot_storage_type()) {
+	case STORAGE_NOR:
+	case STORAGE_EMMC:
+	case STORAGE_EMMC0:
+	case STORAGE_EMMC3:
+	case STORAGE_SD:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+#ifdef CONFIG_SUNXI_SPINOR
+/*
+ * the chip erases the whole sector an address falls in, only erase the
+ * sectors that lie completely inside the gap so a kept neighbour is
+ * never touched. from and to are logical, lo is the logical offset.
+ */
+static int sprite_erase_nor_gap(uint from, uint to, uint lo)
+{
+	uint eb = sunxi_spinor_sector_blocks();
+
+	if (!eb)
+		return -1;
+	from = roundup(from + lo, eb) - lo;
+	to = rounddown(to + lo, eb) - lo;
+	if (to <= from)
+		return 0;
+	printf("erase sectors 0x%x - 0x%x\n", from, to);
+
+	return sunxi_sprite_erase_area(from, to - from);
+}
+#endif
+
+/*
+ * erase what a full erase would, minus the keep[] ranges. nor is erased
+ * over the gaps between them; emmc/sd run the usual per partition erase
+ * over a copy of the new table that leaves them out.
+ */
+static int sprite_erase_skip_prvt(int erase, void *img_mbr_buffer,
+				  struct sprite_prvt_range *keep, int nr_keep)
+{
+	sunxi_mbr_t *mbr;
+	int i, j, ret;
+#ifdef CONFIG_SUNXI_SPINOR
+	struct sprite_prvt_range tmp;
+	uint from = 0, end, lo;
+#endif
+
+	if (!erase)
+		return 0;
+
+#ifdef CONFIG_SUNXI_SPINOR
+	if (get_boot_storage_type() == STORAGE_NOR) {
+		for (i = 1; i < nr_keep; i++) {
+			for (j = i; j > 0 && keep[j].start < keep[j - 1].start; j--) {
+				tmp = keep[j];
+				keep[j] = keep[j - 1];
+				keep[j - 1] = tmp;
+			}
+		}
+		lo = sunxi_flashmap_logical_offset(FLASHMAP_SPI_NOR,
+#ifdef CONFIG_SUNXI_RTOS
+						   RTOS_LOGIC_OFFSET
+#else
+						   LINUX_LOGIC_OFFSET
+#endif
+						   );
+		end = sunxi_sprite_size() - lo;
+		for (i = 0; i < nr_keep; i++) {
+			if (sprite_erase_nor_gap(from, keep[i].start, lo))
+				return -1;
+			from = keep[i].start + keep[i].sectors;
+		}
+
+		return sprite_erase_nor_gap(from, end, lo);
+	}
+#endif
+
+	mbr = memalign(CONFIG_SYS_CACHELINE_SIZE, sizeof(sunxi_mbr_t));
+	if (!mbr)
+		return -1;
+	memcpy(mbr, img_mbr_buffer, sizeof(sunxi_mbr_t));
+	for (i = 0; i < nr_keep; i++) {
+		for (j = 1; j < mbr->PartCount; j++) {
+			if (strncmp((const char *)mbr->array[j].name,
+				    keep[i].name, sizeof(mbr->array[j].name)))
+				continue;
+			memmove(&mbr->array[j], &mbr->array[j + 1],
+				(mbr->PartCount - j - 1) * sizeof(sunxi_partition));
+			mbr->PartCount--;
+			break;
+		}
+	}
+	ret = sunxi_sprite_erase(erase, mbr);
+	free(mbr);
+
+	return ret;
+}
+
 int sunxi_sprite_erase_flash(void *img_mbr_buffer)
 {
 
 	int nodeoffset;
 	uint32_t need_erase_flag = 0;
 	int mbr_num = SUNXI_MBR_COPY_NUM;
+	struct sprite_prvt_range keep[SUNXI_SPRITE_PROTECT_DATA_MAX];
+	int nr_keep;
 	char buf[SUNXI_MBR_SIZE * SUNXI_MBR_COPY_NUM];
 
+	sunxi_sprite_diff_enable(0);
+
 	/* nand will erase boot block at this stage */
 	if (sunxi_sprite_erase(0, img_mbr_buffer) > 0) {
 		printf("flash already erased\n");
@@ -56,6 +167,9 @@ int sunxi_sprite_erase_flash(void *img_mbr_buffer)
 	fdt_getprop_u32(working_fdt, nodeoffset, "eraseflag", &need_erase_flag);
 
 	printf("need erase flash: %d\n", need_erase_flag);
+	/* without an erase the old image is still there to compare against */
+	sunxi_sprite_diff_enable(!need_erase_flag &&
+				 get_boot_storage_type() != STORAGE_NAND);
 
 	if (need_erase_flag == 0x12) {
 #ifdef CONFIG_SUNXI_UBIFS
@@ -114,6 +228,29 @@ int sunxi_sprite_erase_flash(void *img_mbr_buffer)
 		printf("the mbr on flash is bad\n");
 		goto __ERROR_END;
 	}
+
+	/*
+	 * protected partitions the new table leaves where they are need no
+	 * copy at all, erase around them and only rewrite the mbr
+	 */
+	nr_keep = sprite_erase_can_skip_prvt() ?
+		  sunxi_sprite_prvt_in_place(buf, img_mbr_buffer, keep,
+					     ARRAY_SIZE(keep)) : -1;
+	if (nr_keep >= 0) {
+		printf("begin to erase around %d protected parts\n", nr_keep);
+		if (sprite_erase_skip_prvt(need_erase_flag, img_mbr_buffer,
+					   keep, nr_keep)) {
+			printf("erase around protected parts failed\n");
+			return -1;
+		}
+		printf("rewrite\n");
+		sunxi_sprite_download_mbr(img_mbr_buffer, ALIGN(sizeof(sunxi_mbr_t) * mbr_num, CONFIG_SYS_CACHELINE_SIZE));
+		sunxi_flash_write_end();
+		sunxi_flash_flush();
+
+		return 0;
+	}
+
 	printf("begin to store data\n");
 	if (sunxi_sprite_store_part_data(buf) < 0) {
 		get_boot_storage_type() == STORAGE_NAND ? sunxi_sprite_exit(1) : 0;
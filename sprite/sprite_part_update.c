@@ -37,7 +37,17 @@
  * */
 
 /*define the buf size of file that will be read from sdcard */
-#define BUFFSIZE 16 * 1024 * 1024
+#define BUFFSIZE (16 * 1024 * 1024)
+
+/*
+ * partitions are streamed UPDATE_CHUNK at a time through three slots of
+ * the same buffer: one keeps the first chunk until the whole image has
+ * been summed, the other two take turns as read and write buffers
+ */
+#define UPDATE_CHUNK (BUFFSIZE / 4)
+#define UPDATE_SLOT ALIGN(UPDATE_CHUNK + 512, CONFIG_SYS_CACHELINE_SIZE)
+/* summed per call from the mmc dma wait loop */
+#define UPDATE_SUM_SLICE (64 * 1024)
 
 /*define it,that will update uboot*/
 #define UPDATE_UBOOT
@@ -51,9 +61,11 @@ extern int sunxi_sprite_download_uboot(void *buffer, int production_media,
 				       int generate_checksum);
 extern int sunxi_sprite_download_boot0(void *buffer, int production_media);
 
-static int update_write_flash(uint start, uint nblock, void *buffer)
+static int update_write_flash(uint start, uint nblock, void *buffer,
+			      struct sprite_diff_stat *diff)
 {
-	return sunxi_flash_write(start, nblock, buffer);
+	return sunxi_sprite_diff_write(sunxi_flash_read, sunxi_flash_write,
+				       start, nblock, buffer, diff);
 }
 
 static int update_get_partition_info(int index, disk_partition_t *info)
@@ -176,12 +188,30 @@ static int fat_read(const char *filename, void *buf, int offset, int len)
 	return len_read;
 }
 
-static int check_file_checksum(const char *part_name, void *buf,
-			       unsigned int len, unsigned int *sum_val)
+static int fat_size(const char *filename)
+{
+	loff_t size;
+
+	if (fs_set_blk_dev("mmc", mmc_part, FS_TYPE_FAT)) {
+		printf("fs set mmc blk dev fail!\n");
+		return -1;
+	}
+	if (fs_size(filename, &size) < 0 || size > INT_MAX)
+		return -1;
+
+	return size;
+}
+
+/*
+ * fetch the expected checksum of part_name from its .sum file. returns 1
+ * when <part>_sum in env says flash already holds that image, 0 when it
+ * needs updating and -1 without a usable .sum file.
+ */
+static int check_file_checksum(const char *part_name, unsigned int *sum_val)
 {
 	int ret;
 	char file_sum[32] = {0};
-	unsigned int a_sum_val, env_sum_val;
+	unsigned int env_sum_val;
 	char env_sum_name[32] = {0};
 	char *env_sum = NULL;
 	unsigned int *f_sum_val = NULL;
@@ -205,17 +235,7 @@ static int check_file_checksum(const char *part_name, void *buf,
 	if (ret <= 0)
 		goto fail;
 
-	/*get buf checksum*/
-	a_sum_val = add_sum(buf, len);
-	part_debug("f_sum:%08x a_sum:%08x \n", *f_sum_val, a_sum_val);
-
-	/*comparison checksum*/
-	if (a_sum_val != *f_sum_val) {
-		printf("comparison %s.sum fail \n", part_name);
-		goto fail;
-	}
-
-	*sum_val = a_sum_val;
+	*sum_val = *f_sum_val;
 
 	/*checking env checksum*/
 	/*get env checksum*/
@@ -226,11 +246,13 @@ static int check_file_checksum(const char *part_name, void *buf,
 
 	/*comparison checksum*/
 	env_sum_val = simple_strtoul(env_sum, NULL, 16);
-	part_debug("env_sum:%08x file_sum:%08x \n", env_sum_val, a_sum_val);
-	if (env_sum_val != a_sum_val)
+	part_debug("env_sum:%08x file_sum:%08x \n", env_sum_val, *sum_val);
+	if (env_sum_val != *sum_val)
 		goto update;
-	else
-		goto fail;
+
+	/* flash already holds this image, nothing to read or write */
+	free(f_sum_val);
+	return 1;
 
 fail:
 	if (f_sum_val)
@@ -256,8 +278,25 @@ static void save_checksum_env(const char *part_name, unsigned int sum_val)
 	env_save();
 }
 
+/*
+ * forget the checksum of a partition that is about to be overwritten, so
+ * that an update cut short by a reset or a bad image is tried again
+ */
+static void clear_checksum_env(const char *part_name)
+{
+	char env_name[32] = {0};
+
+	sprintf(env_name, "%s_sum", part_name);
+	if (!env_get(env_name))
+		return;
+
+	env_set(env_name, NULL);
+	env_save();
+}
+
 #ifdef ERASE_PART
-static int erase_flash_by_part_name(const char *part_name)
+/* the first keep sectors are about to be rewritten and are left alone */
+static int erase_flash_by_part_name(const char *part_name, uint keep)
 {
 	int ret;
 	unsigned int part_offset, part_size;
@@ -270,11 +309,14 @@ static int erase_flash_by_part_name(const char *part_name)
 		return -1;
 	}
 
+	if (keep >= part_size)
+		return 0;
+
 	part_debug("erase %s partition, start:%d, size:%d \n", part_name,
-		   part_offset, part_size);
+		   part_offset + keep, part_size - keep);
 
 	/* call erase function*/
-	ret = sunxi_flash_erase_area(part_offset, part_size);
+	ret = sunxi_flash_erase_area(part_offset + keep, part_size - keep);
 
 	return ret;
 }
@@ -298,6 +340,7 @@ static int update_uboot_partition(char *file_buf, int *update_flag)
 {
 	int i;
 	int ret = -1;
+	int sum_ret;
 	char file_name[32] = {0};
 	int file_size;
 	int part_size;
@@ -332,8 +375,11 @@ static int update_uboot_partition(char *file_buf, int *update_flag)
 		}
 
 		/*check_sum file and env*/
-		if (check_file_checksum(uboot_part[i].name, file_buf, file_size,
-					&sum_val)) {
+		sum_ret = check_file_checksum(uboot_part[i].name, &sum_val);
+		if (sum_ret > 0) {
+			printf("%s unchanged, skip\n", uboot_part[i].name);
+			continue;
+		} else if (sum_ret || add_sum(file_buf, file_size) != sum_val) {
 			printf("%s checksum fial \n", uboot_part[i].name);
 			continue;
 		}
@@ -349,17 +395,16 @@ static int update_uboot_partition(char *file_buf, int *update_flag)
 			if (!strncmp("uboot", uboot_part[i].name, 5)) {
 				ret = sunxi_sprite_download_uboot(
 				    (void *)file_buf, storage_type, 0);
-				*update_flag = 1;
 			} else if (!strncmp("boot0", uboot_part[i].name, 5)) {
 				ret = sunxi_sprite_download_boot0(
 				    (void *)file_buf, storage_type);
-				*update_flag = 1;
 			}
 			if (ret < 0) {
 				printf("update %s fail \n", uboot_part[i].name);
 			} else {
 				printf("update %s success \n",
 				       uboot_part[i].name);
+				*update_flag = 1;
 				save_checksum_env(uboot_part[i].name, sum_val);
 			}
 		}
@@ -369,22 +414,38 @@ static int update_uboot_partition(char *file_buf, int *update_flag)
 #endif
 
 #define ENV_UPDATE_OVERWRITE 0 /*whether need to overwrite to update env data*/
+/*
+ * env.img holds one copy: crc and data as mkenvimage makes it, or with a
+ * flags byte after the crc (mkenvimage -r) when the env is redundant, as
+ * with SUNXI_ENV_BACKUP_REDUND. the crc tells the two apart; env_save()
+ * then writes the copies in the layout the env driver uses.
+ */
 static int part_env_import(const char *buf, int check)
 {
 	env_t *ep = (env_t *)buf;
+	const char *data = (const char *)ep->data;
+	uint32_t size = ENV_SIZE;
 
 	if (check) {
 		uint32_t crc;
 
 		memcpy(&crc, &ep->crc, sizeof(crc));
 
-		if (crc32(0, ep->data, ENV_SIZE) != crc) {
-			printf("env date: bad CRC, can't update env \n");
-			return -1;
+		if (crc32(0, (const u8 *)data, size) != crc) {
+#ifdef CONFIG_SYS_REDUNDAND_ENVIRONMENT
+			/* a plain image, no flags byte */
+			data = buf + sizeof(crc);
+			size = CONFIG_ENV_SIZE - sizeof(crc);
+			if (crc32(0, (const u8 *)data, size) != crc)
+#endif
+			{
+				printf("env date: bad CRC, can't update env \n");
+				return -1;
+			}
 		}
 	}
 
-	if (himport_r(&env_htab, (char *)ep->data, ENV_SIZE, '\0',
+	if (himport_r(&env_htab, data, size, '\0',
 			   ENV_UPDATE_OVERWRITE ? 0 : H_NOCLEAR, 0, 0, NULL)) {
 		return 0;
 	}
@@ -394,39 +455,175 @@ static int part_env_import(const char *buf, int check)
 	return -1;
 }
 
-static int update_partition(const char *part_name, void *buf, int size)
+/* sum of a chunk, worked off in slices while the next one is being read */
+struct update_sum {
+	char *buf;
+	int len;
+	unsigned int sum;
+};
+
+static void update_sum_slice(void *data)
 {
-	unsigned int start_block = 0;
-	unsigned int rblock = 0;
-	int ret;
+	struct update_sum *s = data;
+	/* slices are whole words, only the last one may end in a partial */
+	int len = min(s->len, UPDATE_SUM_SLICE);
+
+	s->sum += add_sum(s->buf, len);
+	s->buf += len;
+	s->len -= len;
+}
+
+static void update_sum_finish(struct update_sum *s)
+{
+	while (s->len)
+		update_sum_slice(s);
+}
 
+/* clear <part>_sum and erase the partition, once before the first write */
+static int update_prepare(const char *part_name, int file_size, int *erased)
+{
+	if (*erased)
+		return 0;
+	*erased = 1;
+
+	clear_checksum_env(part_name);
 #ifdef ERASE_PART
-	ret = erase_flash_by_part_name(part_name);
-	if (ret) {
+	/*
+	 * with differential writes the old data is compared against, only
+	 * the part of the partition behind the new image gets erased
+	 */
+	if (erase_flash_by_part_name(part_name, sunxi_sprite_diff_enabled() ?
+				     file_size / 512 : 0)) {
 		printf("erase %s fail \n", part_name);
 		return -1;
 	}
 #endif
+
+	return 0;
+}
+
+/* write len bytes of buf at offset, the last partial sector 0xff padded */
+static int update_write_chunk(unsigned int start_block, char *buf, int offset,
+			      int len, struct sprite_diff_stat *diff)
+{
+	int pad = ALIGN(len, 512) - len;
+	unsigned int nblock;
+	int ret;
+
+	memset(buf + len, 0xff, pad);
+	nblock = (len + pad) / 512;
+
+	ret = update_write_flash(start_block + offset / 512, nblock, buf, diff);
+	part_debug("sunxi flash write :offset %x, %d bytes %s\n",
+		   (start_block + offset / 512) << 9, nblock << 9,
+		   ret ? "OK" : "ERROR");
+
+	return ret ? 0 : -1;
+}
+
+/*
+ * stream file_name into part_name in a single pass. the sum of each chunk
+ * is worked off while the next chunk is read (the sd card dma wait loop
+ * runs update_sum_slice()), then the chunk is written. the first chunk is
+ * held back and only written once the whole image matches its .sum file,
+ * so a bad image never gets its header onto flash, and an image that fits
+ * in one chunk leaves the partition untouched. <part>_sum is cleared
+ * before the first write and only saved again by the caller on success,
+ * so an update that fails half way is retried on the next boot.
+ */
+static int update_partition(const char *part_name, const char *file_name,
+			    char *buf, int file_size, unsigned int sum_val)
+{
+	struct sprite_diff_stat diff = { 0 };
+	struct update_sum pend = { 0 };
+	unsigned int start_block;
+	char *first = buf, *cur, *prev = NULL;
+	int offset, len, first_len = 0, prev_off = 0, prev_len = 0;
+	int erased = 0;
+	int ret = -1;
+	int i;
+
 	/*if the name is env partitions, will write uboot env buf and then save
 	 * to flash. it can save old env var or clear */
 	if (!strncmp(part_name, "env", 3)) {
-		if (!part_env_import(buf, 1))
-			/* save env to flash */
-			env_save();
-		else
+		if (file_size > BUFFSIZE ||
+		    fat_read(file_name, buf, 0, 0) != file_size ||
+		    add_sum(buf, file_size) != sum_val) {
+			printf("comparison %s.sum fail \n", part_name);
 			return -1;
+		}
+#ifdef ERASE_PART
+		if (erase_flash_by_part_name(part_name, 0)) {
+			printf("erase %s fail \n", part_name);
+			return -1;
+		}
+#endif
+		if (part_env_import(buf, 1))
+			return -1;
+		/* save env to flash */
+		env_save();
+		return 0;
+	}
 
-	} else { /*other paritions update*/
-		start_block =
-		    sunxi_partition_get_offset_byname((const char *)part_name);
-		rblock = size / 512;
+	/*other paritions update*/
+	start_block = sunxi_partition_get_offset_byname(part_name);
+#ifdef CONFIG_MMC_SUNXI
+	sunxi_mmc_set_dma_wait_hook(update_sum_slice, &pend);
+#endif
+	for (offset = 0, i = 0; offset < file_size; offset += len, i++) {
+		len = min(file_size - offset, UPDATE_CHUNK);
+		/* slot 0 keeps the first chunk, 1 and 2 alternate */
+		cur = i ? buf + (1 + (i & 1)) * UPDATE_SLOT : first;
 
-		ret = update_write_flash(start_block, rblock, (void *)buf);
-		part_debug("sunxi flash write :offset %x, %d bytes %s\n",
-			   start_block << 9, rblock << 9, ret ? "OK" : "ERROR");
-		return ret == 0 ? -1 : 0;
+		if (fat_read(file_name, cur, offset, len) != len) {
+			printf("load %s error \n", file_name);
+			goto out;
+		}
+		update_sum_finish(&pend);
+		pend.buf = cur;
+		pend.len = len;
+		if (!i)
+			first_len = len;
+
+		if (prev && prev != first) {
+			if (update_prepare(part_name, file_size, &erased) ||
+			    update_write_chunk(start_block, prev, prev_off,
+					       prev_len, &diff))
+				goto out;
+		}
+		prev = cur;
+		prev_off = offset;
+		prev_len = len;
 	}
-	return 0;
+	update_sum_finish(&pend);
+
+	if (prev != first) {
+		if (update_prepare(part_name, file_size, &erased) ||
+		    update_write_chunk(start_block, prev, prev_off, prev_len,
+				       &diff))
+			goto out;
+	}
+
+	if (pend.sum != sum_val) {
+		printf("comparison %s.sum fail \n", part_name);
+		if (erased)
+			printf("%s is left without its first %d bytes\n",
+			       part_name, first_len);
+		goto out;
+	}
+
+	/* the image checked out, commit its first chunk */
+	if (update_prepare(part_name, file_size, &erased) ||
+	    update_write_chunk(start_block, first, 0, first_len, &diff))
+		goto out;
+	sunxi_sprite_diff_report(part_name, &diff);
+	ret = 0;
+
+out:
+#ifdef CONFIG_MMC_SUNXI
+	sunxi_mmc_set_dma_wait_hook(NULL, NULL);
+#endif
+	return ret;
 }
 
 int update_main(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
@@ -456,7 +653,7 @@ int update_main(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 	* and performance will suffer for the load.
 	*/
 	file_buf =
-	    (char *)memalign(CONFIG_SYS_CACHELINE_SIZE, ALIGN(BUFFSIZE,
+	    (char *)memalign(CONFIG_SYS_CACHELINE_SIZE, ALIGN(BUFFSIZE + 512,
 						    CONFIG_SYS_CACHELINE_SIZE));
 	if (file_buf == NULL) {
 		printf("can not malloc %d byte size \n", BUFFSIZE);
@@ -486,51 +683,40 @@ int update_main(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 		if (check_file_exsit(file_name))
 			continue;
 
-		/*loading the img file to buf
-		 * and checking the size whether if over part_size*/
-		file_size = fat_read(file_name, file_buf, 0, 0);
-		part_debug("read file size:%d \n", file_size);
-		if (file_size <= 0) {
-			printf("load %s error \n", file_name);
-			continue;
-		}
-
 		/*check_sum file and env*/
-		if (check_file_checksum(part_name, file_buf, file_size,
-					&sum_val)) {
+		ret = check_file_checksum(part_name, &sum_val);
+		if (ret > 0) {
+			printf("%s unchanged, skip\n", part_name);
+			continue;
+		} else if (ret) {
 			printf("%s checksum fial \n", part_name);
 			continue;
 		}
 
-		/*check the part size and file size*/
+		/*checking the size whether if over part_size*/
+		file_size = fat_size(file_name);
+		part_debug("file size:%d \n", file_size);
+		if (file_size <= 0) {
+			printf("load %s error \n", file_name);
+			continue;
+		}
 		if (file_size > part_size) {
 			printf("%s.img size > %s partition size, will not be "
 			       "update\n",
 			       part_name, part_name);
 			continue;
-		} else {
-			/*wirte down the file to flash, there will 512 byte
-			 * aligned*/
-
-			if ((file_size + 512) <= part_size) {
-				/* set 0xff to the file_date end */
-				memset((file_buf + file_size), 0xff, 512);
-				ret = update_partition(part_name, file_buf,
-						       (file_size + 512));
-			} else {
-				/* set 0xff to the file_date end */
-				memset((file_buf + file_size), 0xff,
-						       (part_size - file_size));
-				ret = update_partition(part_name, file_buf,
-						       part_size);
-			}
-			/*if updated, need reboot*/
-			update_flag = 1;
-
-			/*save the file checksum to env */
-			if (!ret)
-				save_checksum_env(part_name, sum_val);
 		}
+
+		/*wirte down the file to flash, there will 512 byte aligned*/
+		ret = update_partition(part_name, file_name, file_buf,
+				       file_size, sum_val);
+		if (ret)
+			continue;
+
+		/*if updated, need reboot*/
+		update_flag = 1;
+		/*save the file checksum to env */
+		save_checksum_env(part_name, sum_val);
 	}
 
 #ifdef UPDATE_UBOOT
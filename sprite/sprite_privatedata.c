@@ -16,7 +16,8 @@
 #include <sys_partition.h>
 #include <sprite_download.h>
 
-#define  SUNXI_SPRITE_PROTECT_DATA_MAX    (16)
+#include "sprite_privatedata.h"
+
 #define  SUNXI_SPRITE_PROTECT_PART        "private"
 
 struct private_part_info
@@ -202,6 +203,77 @@ int sunxi_sprite_probe_prvt(void  *buffer)
 	return 0;
 }
 
+/*
+ * find the protected partitions of the local gpt in buffer that the new
+ * table img_mbr keeps at the same start and size, so an erase can simply
+ * go around them. returns how many were stored in keep[], or -1 when one
+ * is moved or resized and its data has to be copied out and back instead.
+ * protected partitions the new table drops are not kept, the same as the
+ * restore path does.
+ */
+int sunxi_sprite_prvt_in_place(void *buffer, void *img_mbr,
+			       struct sprite_prvt_range *keep, int max)
+{
+	gpt_header *gpt_head = (gpt_header *)(buffer + GPT_HEAD_OFFSET);
+	gpt_entry  *entry    = (gpt_entry *)(buffer + GPT_ENTRY_OFFSET);
+	sunxi_mbr_t *mbr     = (sunxi_mbr_t *)img_mbr;
+	char part_name[PARTNAME_SZ];
+	int storage_type = get_boot_storage_type();
+	u32 logic_offset = 0;
+	u32 part_start, part_len;
+	int i, j, index, count = 0;
+
+	if (gpt_head->signature != GPT_HEADER_SIGNATURE)
+		return -1;
+
+	/* same convention as sunxi_sprite_store_part_data() */
+	if (storage_type == STORAGE_EMMC || storage_type == STORAGE_EMMC3 ||
+	    storage_type == STORAGE_SD || storage_type == STORAGE_EMMC0)
+		logic_offset = 40960;
+
+	for (i = 0; i < gpt_head->num_partition_entries; i++) {
+		memset(part_name, 0x0, sizeof(part_name));
+		for (index = 0; index < PARTNAME_SZ - 1; index++)
+			part_name[index] = (char)(entry[i].partition_name[index]);
+		if (strcmp(part_name, SUNXI_SPRITE_PROTECT_PART) &&
+		    entry[i].attributes.fields.keydata != 0x1)
+			continue;
+
+		part_start = entry[i].starting_lba - logic_offset;
+		part_len   = entry[i].ending_lba - entry[i].starting_lba + 1;
+		for (j = 0; j < mbr->PartCount; j++) {
+			if (!strncmp((const char *)mbr->array[j].name,
+				     part_name, sizeof(mbr->array[j].name)))
+				break;
+		}
+		if (j >= mbr->PartCount)
+			continue;
+
+		/* the erase walks the new table from its second entry */
+		if (j == 0 || mbr->array[j].addrlo != part_start ||
+		    (mbr->array[j].lenlo != part_len &&
+		     !(mbr->array[j].lenlo == 0 && j == mbr->PartCount - 1))) {
+			printf("keypart %s moves: 0x%x+0x%x -> 0x%x+0x%x\n",
+			       part_name, part_start, part_len,
+			       mbr->array[j].addrlo, mbr->array[j].lenlo);
+			return -1;
+		}
+		if (count >= max)
+			return -1;
+
+		keep[count].start   = part_start;
+		keep[count].sectors = part_len;
+		strncpy(keep[count].name, part_name,
+			sizeof(keep[count].name) - 1);
+		keep[count].name[sizeof(keep[count].name) - 1] = 0;
+		printf("keypart %s stays at 0x%x, sectors 0x%x\n",
+		       keep[count].name, part_start, part_len);
+		count++;
+	}
+
+	return count;
+}
+
 int sunxi_sprite_erase_private_key(void *buffer)
 {
 	int count       = 0;
@@ -24,6 +24,14 @@
 #ifndef  __SPRITE_PRIVATEDATA_H__
 #define  __SPRITE_PRIVATEDATA_H__
 
+#define  SUNXI_SPRITE_PROTECT_DATA_MAX    (16)
+
+/* a protected partition, in logical sectors */
+struct sprite_prvt_range {
+	uint start;
+	uint sectors;
+	char name[16];
+};
 
 extern int sunxi_sprite_store_part_data(void  *mbr);
 
@@ -32,6 +40,9 @@ extern int sunxi_sprite_restore_part_data(void  *mbr);
 extern int sunxi_sprite_probe_prvt(void  *mbr);
 
 extern int sunxi_sprite_erase_private_key(void *buffer);
+
+extern int sunxi_sprite_prvt_in_place(void *buffer, void *img_mbr,
+				      struct sprite_prvt_range *keep, int max);
 #endif
 
 
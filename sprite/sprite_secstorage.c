@@ -12,6 +12,7 @@
 #include <sunxi_flash.h>
 #include <memalign.h>
 #include <securestorage.h>
+#include <secure_storage_map.h>
 
 int sunxi_secure_storage_erase(const char *item_name);
 int sunxi_secure_storage_erase_data_only(const char *item_name);
@@ -34,237 +35,10 @@ static inline int try_map_dirty(void)
 }
 
 static struct map_info secure_storage_map = { { 0 } };
+/* slots 1..31 hold the items, slot 0 is the map itself */
+#define SEC_MAP_MAX_ITEMS	(31)
 
-/*
-************************************************************************************************************
-*
-*                                             function
-*
-*    name          :  __probe_name_in_map secure storage mapвָ
-*
-*parmeters     :  buffer :
-*
-*    return        :
-*
-*    note          :
-*
-*
-************************************************************************************************************
-*/
-static int __probe_name_in_map(unsigned char *buffer, const char *item_name,
-			       int *len)
-{
-	unsigned char *buf_start = buffer;
-	int index		 = 1;
-	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, name, MAP_KEY_NAME_SIZE);
-	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, length, MAP_KEY_DATA_SIZE);
-	int i, j;
-
-	while (*buf_start != '\0' && (buf_start - buffer) < SEC_BLK_SIZE) {
-		memset(name, 0, 64);
-		memset(length, 0, 32);
-		i = j = 0;
-		while (buf_start[i] != ':' && (buf_start[i] != '\0') &&
-		       (&buf_start[i] - buffer) < SEC_BLK_SIZE &&
-		       j < MAP_KEY_NAME_SIZE) {
-			name[j] = buf_start[i];
-			i++;
-			j++;
-		}
-
-		if (j >= MAP_KEY_NAME_SIZE)
-			return -1;
-
-		i++;
-		j = 0;
-		while ((buf_start[i] != ' ') && (buf_start[i] != '\0') &&
-		       (&buf_start[i] - buffer) < SEC_BLK_SIZE &&
-		       j < MAP_KEY_DATA_SIZE) {
-			length[j] = buf_start[i];
-			i++;
-			j++;
-		}
-
-		/* deal dirty data */
-		if ((&buf_start[i] - buffer) >= SEC_BLK_SIZE ||
-		    j >= MAP_KEY_DATA_SIZE) {
-			return -1;
-		}
-
-		if (!strcmp(item_name, (const char *)name)) {
-			buf_start += strlen(item_name) + 1;
-			*len = simple_strtoul((const char *)length, NULL, 10);
-
-			if (strlen(item_name) ==
-				    strlen(SECURE_STORAGE_DUMMY_KEY_NAME) &&
-			    !memcmp(item_name, SECURE_STORAGE_DUMMY_KEY_NAME,
-				    strlen(SECURE_STORAGE_DUMMY_KEY_NAME)) &&
-			    *len == 0) {
-				/*
-				 * if *len == 0 it is a actual DUMMY_KEY,
-				 * a key happen to has same name should have a non-zero len
-				 */
-			} else {
-				pr_msg("name in map %s\n", name);
-				return index;
-			}
-		}
-		index++;
-		buf_start += strlen((const char *)buf_start) + 1;
-	}
-
-	return -1;
-}
-/*
-************************************************************************************************************
-*
-*                                             function
-*
-*    name          :
-*
-*    parmeters     :
-*
-*    return        :
-*
-*    note          :
-*
-*
-************************************************************************************************************
-*/
-static int __fill_name_in_map(unsigned char *buffer, const char *item_name,
-			      int length)
-{
-	unsigned char *buf_start = buffer;
-	int index		 = 1;
-	int name_len;
-	uint8_t write_back_buf[sizeof(struct map_info)];
-	int dummy_key_index		= -1;
-	unsigned char *dummy_key_start	= NULL;
-	unsigned char *write_back_start = NULL;
-
-	while (*buf_start != '\0' && (buf_start - buffer) < SEC_BLK_SIZE) {
-		name_len = 0;
-		while (buf_start[name_len] != ':' &&
-		       (&buf_start[name_len] - buffer) < SEC_BLK_SIZE &&
-		       name_len < MAP_KEY_NAME_SIZE)
-			name_len++;
-
-		/* deal dirty data */
-		if ((&buf_start[name_len] - buffer) >= SEC_BLK_SIZE ||
-		    name_len >= MAP_KEY_NAME_SIZE) {
-			pr_msg("__fill_name_in_map: dirty map, memset 0\n");
-			memset(buffer, 0x0, SEC_BLK_SIZE);
-			buf_start = buffer;
-			index     = 1;
-			break;
-		}
-
-		if (!memcmp((const char *)buf_start, item_name, name_len) &&
-		    strlen(item_name) == name_len) {
-			pr_msg("name in map %s\n", buf_start);
-			return index;
-		}
-
-		if (name_len == strlen(SECURE_STORAGE_DUMMY_KEY_NAME) &&
-		    !memcmp((const char *)buf_start,
-			    SECURE_STORAGE_DUMMY_KEY_NAME, name_len) &&
-		    dummy_key_index == -1) {
-			/*
-			 * DUMMY_KEY could be replaced with the input key,
-			 * but we dont know whether to do so at this point,
-			 * save relate info first
-			 */
-			pr_msg("found dummy_key %s\n", buf_start);
-			dummy_key_index	 = index;
-			dummy_key_start	 = buf_start;
-			write_back_start = dummy_key_start +
-					   strlen((const char *)buf_start) + 1;
-			memset(write_back_buf, 0, sizeof(write_back_buf));
-			memcpy((char *)write_back_buf, write_back_start,
-			       4096 - (write_back_start - buffer));
-		}
-		index++;
-		buf_start += strlen((const char *)buf_start) + 1;
-	}
-	if ((index >= 32) && (dummy_key_index == -1))
-		return -1;
-
-	if (dummy_key_index != -1) {
-		/*use index reserved by DUMMY_KEY*/
-		sprintf((char *)dummy_key_start, "%s:%d", item_name, length);
-		write_back_start = dummy_key_start +
-				   strlen((const char *)dummy_key_start) + 1;
-		memcpy(write_back_start, write_back_buf,
-		       4096 - (write_back_start - buffer));
-		return dummy_key_index;
-	} else {
-		/* add new index */
-		sprintf((char *)buf_start, "%s:%d", item_name, length);
-		return index;
-	}
-}
-/*
-************************************************************************************************************
-*
-*                                             function
-*
-*    name          :
-*
-*    parmeters     :
-*
-*    return        :
-*
-*    note          :
-*
-*
-************************************************************************************************************
-*/
-static int __discard_name_in_map(unsigned char *buffer, const char *item_name)
-{
-	unsigned char *buf_start = buffer, *last_start;
-	int index		 = 1;
-	int name_len;
-	uint8_t write_back_buf[sizeof(struct map_info)];
-
-	while (*buf_start != '\0' && (buf_start - buffer) < SEC_BLK_SIZE) {
-		name_len = 0;
-		while (buf_start[name_len] != ':' &&
-		       (&buf_start[name_len] - buffer) < SEC_BLK_SIZE &&
-		       name_len < MAP_KEY_NAME_SIZE)
-			name_len++;
-
-		/* deal dirty data */
-		if ((&buf_start[name_len] - buffer) >= SEC_BLK_SIZE ||
-		    name_len >= MAP_KEY_NAME_SIZE) {
-			return -1;
-		}
-
-		if (!memcmp((const char *)buf_start, item_name, name_len) &&
-		    strlen(item_name) == name_len) {
-			/*
-			 * replace discarded key with DUMMY_KEY, so following
-			 * keys do not need to change their index
-			 */
-			memset(write_back_buf, 0, sizeof(write_back_buf));
-			last_start =
-				buf_start + strlen((const char *)buf_start) + 1;
-			memcpy(write_back_buf, last_start,
-			       4096 - (last_start - buffer));
-			sprintf((char *)buf_start, "%s:%d",
-				SECURE_STORAGE_DUMMY_KEY_NAME, 0);
-
-			last_start =
-				buf_start + strlen((const char *)buf_start) + 1;
-			memcpy((char *)last_start, (char *)write_back_buf,
-			       4096 - (last_start - buffer));
-			return index;
-		}
-		index++;
-		buf_start += strlen((const char *)buf_start) + 1;
-	}
-
-	return -1;
-}
+static struct secmap secure_storage_index;
 
 int check_secure_storage_map(void *buffer)
 {
@@ -324,6 +98,17 @@ int sunxi_secure_storage_init(void)
 				/* no things */
 			}
 		}
+
+		if (!secure_storage_index.items &&
+		    secmap_init(&secure_storage_index, SEC_MAP_MAX_ITEMS,
+				sizeof(secure_storage_map.data))) {
+			pr_err("no memory for secure storage map index\n");
+
+			return -1;
+		}
+		if (secmap_load(&secure_storage_index,
+				(const char *)secure_storage_map.data))
+			pr_msg("secure storage map has dirty data\n");
 	}
 	secure_storage_inited = 1;
 
@@ -356,6 +141,12 @@ int sunxi_secure_storage_exit(void)
 		return -1;
 	}
 	if (try_map_dirty()) {
+		if (secmap_store(&secure_storage_index,
+				 (char *)secure_storage_map.data)) {
+			pr_err("secure storage map overflow\n");
+
+			return -1;
+		}
 		secure_storage_map.magic = STORE_OBJECT_MAGIC;
 		secure_storage_map.crc   = crc32(0, (void *)&secure_storage_map,
 					       sizeof(struct map_info) - 4);
@@ -391,8 +182,8 @@ int sunxi_secure_storage_exit(void)
 */
 int sunxi_secure_storage_list(void)
 {
-	int	    ret, index = 1;
-	unsigned char *buf_start = (unsigned char *)&secure_storage_map;
+	struct secmap_item *item;
+	int ret, index;
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, buffer, 4096);
 
 	if (sunxi_secure_storage_init()) {
@@ -401,35 +192,12 @@ int sunxi_secure_storage_list(void)
 		return -1;
 	}
 
-	char name[64], length[32];
-	int  i, j, len;
-
-	while (*buf_start != '\0') {
-		memset(name, 0, 64);
-		memset(length, 0, 32);
-		i = 0;
-		while (buf_start[i] != ':') {
-			name[i] = buf_start[i];
-			i++;
-		}
-		i++;
-		j = 0;
-		while ((buf_start[i] != ' ') && (buf_start[i] != '\0')) {
-			length[j] = buf_start[i];
-			i++;
-			j++;
-		}
-
-		pr_msg("name in map %s\n", name);
-		len = simple_strtoul((const char *)length, NULL, 10);
-
-		if (strlen(name) == strlen(SECURE_STORAGE_DUMMY_KEY_NAME) &&
-		    !memcmp(name, SECURE_STORAGE_DUMMY_KEY_NAME,
-			    strlen(SECURE_STORAGE_DUMMY_KEY_NAME)) &&
-		    len == 0) {
-			/*dummy key, not used, goto next key*/
-			goto next_key;
-		}
+	for (index = 1; index <= secure_storage_index.nr_items; index++) {
+		item = &secure_storage_index.items[index];
+		pr_msg("name in map %s\n", item->name);
+		/*dummy key, not used, goto next key*/
+		if (item->flags & SECMAP_ITEM_DUMMY)
+			continue;
 
 		ret = sunxi_secstorage_read(index, buffer, 4096);
 		if (ret < 0) {
@@ -442,12 +210,8 @@ int sunxi_secure_storage_list(void)
 			return -1;
 		} else {
 			pr_force("%d data:\n", index);
-			sunxi_dump(buffer, len);
+			sunxi_dump(buffer, item->len);
 		}
-
-next_key:
-		index++;
-		buf_start += strlen((const char *)buf_start) + 1;
 	}
 
 	return 0;
@@ -479,8 +243,7 @@ int sunxi_secure_storage_probe(const char *item_name)
 
 		return -1;
 	}
-	ret = __probe_name_in_map((unsigned char *)&secure_storage_map,
-				  item_name, &len);
+	ret = secmap_find(&secure_storage_index, item_name, &len);
 	if (ret < 0) {
 		pr_err("no item name %s in the map\n", item_name);
 
@@ -518,8 +281,7 @@ int sunxi_secure_storage_read(const char *item_name, char *buffer,
 
 		return -1;
 	}
-	index = __probe_name_in_map((unsigned char *)&secure_storage_map,
-				    item_name, &len_in_store);
+	index = secmap_find(&secure_storage_index, item_name, &len_in_store);
 	if (index < 0) {
 		pr_msg("no item name %s in the map\n", item_name);
 
@@ -572,11 +334,9 @@ int sunxi_secure_storage_write(const char *item_name, char *buffer, int length)
 		return -1;
 	}
 
-	index = __probe_name_in_map((unsigned char *)&secure_storage_map,
-				    item_name, &len);
+	index = secmap_find(&secure_storage_index, item_name, &len);
 	if (index < 0) {
-		index = __fill_name_in_map((unsigned char *)&secure_storage_map,
-					   item_name, length);
+		index = secmap_add(&secure_storage_index, item_name, length);
 		if (index < 0) {
 			pr_err("write secure storage block %d name %s overrage\n",
 			       index, item_name);
@@ -638,8 +398,7 @@ int sunxi_secure_storage_erase_data_only(const char *item_name)
 
 		return -1;
 	}
-	index = __probe_name_in_map((unsigned char *)&secure_storage_map,
-				    item_name, &len);
+	index = secmap_find(&secure_storage_index, item_name, &len);
 	if (index < 0) {
 		pr_err("no item name %s in the map\n", item_name);
 
@@ -687,8 +446,7 @@ int sunxi_secure_storage_erase(const char *item_name)
 
 		return -1;
 	}
-	index = __discard_name_in_map((unsigned char *)&secure_storage_map,
-				      item_name);
+	index = secmap_discard(&secure_storage_index, item_name);
 	if (index < 0) {
 		pr_err("no item name %s in the map\n", item_name);
 
@@ -727,6 +485,8 @@ int sunxi_secure_storage_erase_all(void)
 	}
 
 	memset(&secure_storage_map, 0x00, 4096);
+	if (secure_storage_index.items)
+		secmap_clear(&secure_storage_index);
 	ret = sunxi_secstorage_write(0, (unsigned char *)&secure_storage_map,
 				     4096);
 	if (ret < 0) {
@@ -9,6 +9,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#include <asm/sections.h>
 
 #include <u-boot/zlib.h>
 #include <bzlib.h>
@@ -22,6 +23,8 @@
 #include <test/suites.h>
 #include <test/ut.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 static const char plain[] =
 	"I am a highly compressable bit of text.\n"
 	"I am a highly compressable bit of text.\n"
@@ -436,6 +439,174 @@ static int compression_test_lz4(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_lz4, 0);
 
+#ifdef CONFIG_ZLIB_INFLATE_FAST
+#define INFLATE_TEST_KERNEL_SIZE	(4 << 20)
+#define INFLATE_TEST_RAMDISK_SIZE	(8 << 20)
+
+/* real machine code for a kernel sized image: copies of u-boot itself */
+static void inflate_test_fill_kernel(u8 *buf, ulong size)
+{
+#ifdef CONFIG_SANDBOX
+	const u8 *image = (const u8 *)_init;
+#else
+	const u8 *image = (const u8 *)gd->relocaddr;
+#endif
+	ulong i, n;
+
+	for (i = 0; i < size; i += n) {
+		n = min(size - i, gd->mon_len);
+		memcpy(buf + i, image, n);
+	}
+}
+
+/*
+ * something shaped like a ramdisk: little endian instruction words from a
+ * small set of opcodes, runs of strings and zero padding
+ */
+static void inflate_test_fill(u8 *buf, ulong size)
+{
+	static const char *const words[] = {
+		"kernel ", "probe ", "failed ", "device ", "%s: ", "\n",
+		"driver ", "irq ", "clock ", "0x%08x ", "memory ",
+	};
+	u32 seed = 0x2545f491;
+	ulong i = 0, n;
+
+	while (i < size) {
+		seed = seed * 1103515245 + 12345;
+		switch ((seed >> 16) & 7) {
+		case 0:
+			n = min(size - i, (ulong)((seed >> 20) & 0xff));
+			memset(buf + i, 0, n);
+			break;
+		case 1:
+		case 2:
+			n = min(size - i, (ulong)strlen(words[(seed >> 20) %
+						ARRAY_SIZE(words)]));
+			memcpy(buf + i, words[(seed >> 20) % ARRAY_SIZE(words)],
+			       n);
+			break;
+		default:
+			n = min(size - i, (ulong)4);
+			buf[i] = (seed >> 8) & 0x1f;
+			if (n > 1)
+				buf[i + 1] = (seed >> 24) & 0x3;
+			if (n > 2)
+				buf[i + 2] = 0x90 + ((seed >> 13) & 0x3);
+			if (n > 3)
+				buf[i + 3] = (seed & 0x100) ? 0xe5 : 0xeb;
+			break;
+		}
+		i += n;
+	}
+}
+
+/* inflate in small steps so that the fast path keeps hitting its limits */
+static int inflate_test_chunked(u8 *dst, ulong dst_size, u8 *src,
+				ulong src_size, uint step)
+{
+	z_stream s;
+	int r, offset;
+
+	offset = gzip_parse_header(src, src_size);
+	if (offset < 0)
+		return -1;
+
+	memset(&s, 0, sizeof(s));
+	if (inflateInit2(&s, -MAX_WBITS) != Z_OK)
+		return -1;
+
+	s.next_in = src + offset;
+	s.next_out = dst;
+	r = Z_OK;
+	while (r == Z_OK) {
+		s.avail_in = min((ulong)step, src_size - offset - s.total_in);
+		s.avail_out = min((ulong)step, dst_size - s.total_out);
+		r = inflate(&s, Z_SYNC_FLUSH);
+	}
+	inflateEnd(&s);
+
+	return (r == Z_STREAM_END && s.total_out == dst_size) ? 0 : -1;
+}
+
+/*
+ * inflate comp one-shot with the generic and the wide fast path, starting
+ * at each word alignment, and in small steps. the wide output must match
+ * the generic one byte for byte, and the generic one the original.
+ */
+static int inflate_test_image(struct unit_test_state *uts, const char *name,
+			      void (*fill)(u8 *buf, ulong size), ulong size)
+{
+	static const uint steps[] = { 1, 7, 300, 4096 };
+	ulong comp_max = size + size / 8 + 1024;
+	ulong comp_size, out_size, start, us[2];
+	u8 *buf, *comp, *out[2];
+	int wide, align, i, ret = -1;
+	u32 crc;
+
+	buf = malloc(comp_max + 4);
+	out[0] = malloc(size);
+	out[1] = malloc(size);
+	errcheck(buf && out[0] && out[1]);
+
+	/* out[0] holds the original until it is compressed */
+	fill(out[0], size);
+	crc = crc32(0, out[0], size);
+	comp_size = comp_max;
+	errcheck(gzip(buf, &comp_size, out[0], size) == 0);
+
+	for (align = 0; align < 4; align++) {
+		comp = buf + align;
+		if (align)
+			memmove(comp, comp - 1, comp_size);
+
+		for (wide = 0; wide <= 1; wide++) {
+			inflate_fast_wide = wide;
+			memset(out[wide], 0, size);
+			out_size = comp_size;
+			start = timer_get_us();
+			errcheck(gunzip(out[wide], size, comp, &out_size) == 0);
+			us[wide] = max(timer_get_us() - start, 1UL);
+			errcheck(out_size == size);
+		}
+		errcheck(crc32(0, out[0], size) == crc);
+		errcheck(!memcmp(out[0], out[1], size));
+	}
+	printf("\t%s: %lu -> %lu bytes, generic %lu KB/s, wide %lu KB/s\n",
+	       name, comp_size, size,
+	       (ulong)((u64)size * 1000000 / 1024 / us[0]),
+	       (ulong)((u64)size * 1000000 / 1024 / us[1]));
+
+	for (i = 0; i < ARRAY_SIZE(steps); i++) {
+		inflate_fast_wide = 1;
+		memset(out[1], 0, size);
+		errcheck(inflate_test_chunked(out[1], size, comp, comp_size,
+					      steps[i]) == 0);
+		errcheck(!memcmp(out[0], out[1], size));
+	}
+	ret = 0;
+
+out:
+	inflate_fast_wide = 1;
+	free(out[1]);
+	free(out[0]);
+	free(buf);
+
+	return ret;
+}
+
+static int compression_test_inflate_fast(struct unit_test_state *uts)
+{
+	if (inflate_test_image(uts, "kernel", inflate_test_fill_kernel,
+			       INFLATE_TEST_KERNEL_SIZE))
+		return -1;
+
+	return inflate_test_image(uts, "ramdisk", inflate_test_fill,
+				  INFLATE_TEST_RAMDISK_SIZE);
+}
+COMPRESSION_TEST(compression_test_inflate_fast, 0);
+#endif
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the batched fdt fixups
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <fdt_batch.h>
+#include <malloc.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define FDT_BATCH_TEST_ROOM	0x1000
+
+struct fdt_batch_test_op {
+	int node;		/* 0: root, 1: first subnode */
+	const char *name;
+	const char *val;	/* NULL deletes the property */
+};
+
+/*
+ * replace, add, delete, delete then add again, add then delete, a new
+ * name shared by two nodes and one that is the tail of an existing name
+ */
+static const struct fdt_batch_test_op fdt_batch_test_ops[] = {
+	{ 0, "compatible", "sandbox,batch" },
+	{ 1, "status", "okay" },
+	{ 0, "batch-new", "one" },
+	{ 1, "batch-new", "two" },
+	{ 1, "compatible", NULL },
+	{ 1, "compatible", "readded" },
+	{ 0, "batch-tmp", "x" },
+	{ 0, "batch-tmp", NULL },
+	{ 0, "patible", "tail" },
+	{ 0, "batch-new", "three, a longer value" },
+	{ 0, "model", NULL },
+};
+
+static int fdt_batch_test_node(void *fdt, int node)
+{
+	return node ? fdt_first_subnode(fdt, 0) : 0;
+}
+
+/* libfdt leaves stale bytes behind resized property values */
+static void fdt_batch_test_clear_padding(void *fdt)
+{
+	const struct fdt_property *prop;
+	int offset = 0, next, len;
+	uint32_t tag;
+
+	do {
+		tag = fdt_next_tag(fdt, offset, &next);
+		if (tag == FDT_PROP) {
+			prop = fdt_offset_ptr(fdt, offset, sizeof(*prop));
+			len = fdt32_to_cpu(prop->len);
+			memset((char *)prop->data + len, 0,
+			       ALIGN(len, FDT_TAGSIZE) - len);
+		}
+		offset = next;
+	} while (tag != FDT_END && next >= 0);
+}
+
+static int dm_test_fdt_batch(struct unit_test_state *uts)
+{
+	const struct fdt_batch_test_op *op;
+	struct fdt_batch batch;
+	void *seq, *bat;
+	int size, node, i;
+	ulong start, seq_us;
+
+	size = fdt_totalsize(gd->fdt_blob) + FDT_BATCH_TEST_ROOM;
+	seq = malloc(size);
+	bat = malloc(size);
+	ut_assertnonnull(seq);
+	ut_assertnonnull(bat);
+	ut_assertok(fdt_open_into(gd->fdt_blob, seq, size));
+	ut_assertok(fdt_open_into(gd->fdt_blob, bat, size));
+
+	start = timer_get_us();
+	for (i = 0; i < ARRAY_SIZE(fdt_batch_test_ops); i++) {
+		op = &fdt_batch_test_ops[i];
+		node = fdt_batch_test_node(seq, op->node);
+		if (op->val) {
+			ut_assertok(fdt_setprop_string(seq, node, op->name,
+						       op->val));
+		} else {
+			fdt_delprop(seq, node, op->name);
+		}
+	}
+	seq_us = timer_get_us() - start;
+
+	ut_assertok(fdt_batch_begin(&batch, bat));
+	for (i = 0; i < ARRAY_SIZE(fdt_batch_test_ops); i++) {
+		op = &fdt_batch_test_ops[i];
+		node = fdt_batch_test_node(bat, op->node);
+		if (op->val) {
+			ut_assertok(fdt_batch_setprop_off(&batch, node,
+					op->name, op->val,
+					strlen(op->val) + 1));
+		} else {
+			ut_assertok(fdt_batch_delprop_off(&batch, node,
+							  op->name));
+		}
+	}
+	ut_assertok(fdt_batch_apply(&batch, size));
+	printf("fdt batch: sequential %lu us, batched %lu us\n", seq_us,
+	       batch.apply_us);
+
+	fdt_batch_test_clear_padding(seq);
+	ut_asserteq(fdt_totalsize(seq), fdt_totalsize(bat));
+	ut_asserteq(fdt_off_dt_strings(seq) + fdt_size_dt_strings(seq),
+		    fdt_off_dt_strings(bat) + fdt_size_dt_strings(bat));
+	ut_assertok(memcmp(seq, bat, fdt_off_dt_strings(seq) +
+				     fdt_size_dt_strings(seq)));
+
+	free(bat);
+	free(seq);
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_batch, DM_TESTF_SCAN_FDT);
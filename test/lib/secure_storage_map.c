@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the secure storage item map index
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <securestorage.h>
+#include <secure_storage_map.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+#define SECMAP_TEST_ITEMS	500
+#define SECMAP_TEST_TEXT	(32 * 1024)
+
+static void secmap_test_name(char *name, int i)
+{
+	/* names that share prefixes and lengths, to exercise the chains */
+	sprintf(name, "key_%d_%s", i, (i & 1) ? "widevine" : "hdcp");
+}
+
+static int secmap_test_fill(struct unit_test_state *uts, struct secmap *m)
+{
+	char name[SECMAP_NAME_SIZE];
+	int i;
+
+	for (i = 1; i <= SECMAP_TEST_ITEMS; i++) {
+		secmap_test_name(name, i);
+		ut_asserteq(i, secmap_add(m, name, i * 3));
+	}
+
+	return 0;
+}
+
+/* the text layout is the one the storage already holds */
+static int lib_test_secmap_text(struct unit_test_state *uts)
+{
+	static const char text[] = "rotpk:32\0hdcp:288\0"
+				   SECURE_STORAGE_DUMMY_KEY_NAME ":0\0"
+				   "widevine:1024\0";
+	struct secmap m;
+	char *out;
+	int len;
+
+	ut_assertok(secmap_init(&m, 31, 4088));
+	out = calloc(1, 4088);
+	ut_assertnonnull(out);
+	memcpy(out, text, sizeof(text));
+
+	ut_assertok(secmap_load(&m, out));
+	ut_asserteq(4, m.nr_items);
+	ut_asserteq(1, m.nr_dummy);
+	ut_asserteq(2, secmap_find(&m, "hdcp", &len));
+	ut_asserteq(288, len);
+	ut_asserteq(4, secmap_find(&m, "widevine", &len));
+	ut_asserteq(1024, len);
+	ut_asserteq(-1, secmap_find(&m, SECURE_STORAGE_DUMMY_KEY_NAME, &len));
+	ut_asserteq(-1, secmap_find(&m, "hdc", &len));
+
+	/* the dummy slot is reused, an existing name keeps its slot */
+	ut_asserteq(3, secmap_add(&m, "oem_key", 16));
+	ut_asserteq(2, secmap_add(&m, "hdcp", 100));
+	ut_asserteq(5, secmap_add(&m, "attest", 7));
+	ut_asserteq(1, secmap_discard(&m, "rotpk"));
+	ut_asserteq(-1, secmap_discard(&m, "rotpk"));
+
+	memset(out, 0xaa, 4088);
+	ut_assertok(secmap_store(&m, out));
+	ut_assert(!memcmp(SECURE_STORAGE_DUMMY_KEY_NAME ":0\0hdcp:288\0"
+			  "oem_key:16\0widevine:1024\0attest:7\0\0",
+			  out, sizeof(SECURE_STORAGE_DUMMY_KEY_NAME) + 46));
+	ut_asserteq(m.text_len, sizeof(SECURE_STORAGE_DUMMY_KEY_NAME) + 45);
+	ut_asserteq(0, out[4087]);
+
+	free(out);
+	secmap_free(&m);
+
+	return 0;
+}
+DM_TEST(lib_test_secmap_text, 0);
+
+static int lib_test_secmap_many(struct unit_test_state *uts)
+{
+	char name[SECMAP_NAME_SIZE];
+	struct secmap m, n;
+	char *text;
+	int i, len;
+
+	ut_assertok(secmap_init(&m, SECMAP_TEST_ITEMS, SECMAP_TEST_TEXT));
+	ut_assertok(secmap_init(&n, SECMAP_TEST_ITEMS, SECMAP_TEST_TEXT));
+	text = malloc(SECMAP_TEST_TEXT);
+	ut_assertnonnull(text);
+
+	ut_assertok(secmap_test_fill(uts, &m));
+	ut_asserteq(-1, secmap_add(&m, "one_too_many", 1));
+
+	for (i = 1; i <= SECMAP_TEST_ITEMS; i++) {
+		secmap_test_name(name, i);
+		ut_asserteq(i, secmap_find(&m, name, &len));
+		ut_asserteq(i * 3, len);
+	}
+
+	/* erase every third item, the others must not move */
+	for (i = 3; i <= SECMAP_TEST_ITEMS; i += 3) {
+		secmap_test_name(name, i);
+		ut_asserteq(i, secmap_discard(&m, name));
+	}
+	ut_asserteq(SECMAP_TEST_ITEMS / 3, m.nr_dummy);
+	for (i = 1; i <= SECMAP_TEST_ITEMS; i++) {
+		secmap_test_name(name, i);
+		ut_asserteq(i % 3 ? i : -1, secmap_find(&m, name, &len));
+	}
+
+	/* round trip through the text form */
+	ut_assertok(secmap_store(&m, text));
+	ut_assertok(secmap_load(&n, text));
+	ut_asserteq(m.nr_items, n.nr_items);
+	ut_asserteq(m.nr_dummy, n.nr_dummy);
+	ut_asserteq(m.text_len, n.text_len);
+	for (i = 1; i <= SECMAP_TEST_ITEMS; i++) {
+		secmap_test_name(name, i);
+		ut_asserteq(secmap_find(&m, name, NULL),
+			    secmap_find(&n, name, NULL));
+	}
+
+	/* new items fill the freed slots from the lowest one */
+	for (i = 3; i <= SECMAP_TEST_ITEMS; i += 3) {
+		sprintf(name, "new_%d", i);
+		ut_asserteq(i, secmap_add(&n, name, 1));
+	}
+	ut_asserteq(0, n.nr_dummy);
+	ut_asserteq(-1, secmap_add(&n, "still_full", 1));
+
+	free(text);
+	secmap_free(&n);
+	secmap_free(&m);
+
+	return 0;
+}
+DM_TEST(lib_test_secmap_many, 0);
+
+/* garbage ends the map, the next add starts over like the old parser did */
+static int lib_test_secmap_dirty(struct unit_test_state *uts)
+{
+	struct secmap m;
+	char *text;
+	int len;
+
+	ut_assertok(secmap_init(&m, 31, 4088));
+	text = malloc(4088);
+	ut_assertnonnull(text);
+
+	memset(text, 0, 4088);
+	strcpy(text, "rotpk:32");
+	memset(text + 9, 'x', 100);
+	ut_asserteq(-1, secmap_load(&m, text));
+	ut_asserteq(1, secmap_find(&m, "rotpk", &len));
+	ut_asserteq(32, len);
+	ut_asserteq(1, secmap_add(&m, "hdcp", 288));
+	ut_asserteq(-1, secmap_find(&m, "rotpk", &len));
+
+	/* an erased flash reads back as 0xff */
+	memset(text, 0xff, 4088);
+	ut_asserteq(-1, secmap_load(&m, text));
+	ut_asserteq(0, m.nr_items);
+
+	/* a key that only shares the dummy name is a real key */
+	memset(text, 0, 4088);
+	memcpy(text, SECURE_STORAGE_DUMMY_KEY_NAME ":4",
+	       sizeof(SECURE_STORAGE_DUMMY_KEY_NAME) + 1);
+	ut_assertok(secmap_load(&m, text));
+	ut_asserteq(1, secmap_find(&m, SECURE_STORAGE_DUMMY_KEY_NAME, &len));
+	ut_asserteq(4, len);
+
+	free(text);
+	secmap_free(&m);
+
+	return 0;
+}
+DM_TEST(lib_test_secmap_dirty, 0);
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Decode and compare the sunxi boot stage record ring
+#
+# The ring is the SUNXI_BOOT_REC_SIZE bytes at CONFIG_SUNXI_BOOT_RECORD_ADDR,
+# or the start of CONFIG_SUNXI_BOOT_RECORD_PART, see
+# include/sunxi_boot_record.h for the layout. Grab it with e.g.
+#    dd if=/dev/by-name/bootrec of=bootrec.bin bs=2048 count=1
+#
+# Usage:
+#    ./tools/sunxi_bootrec.py dump bootrec.bin
+#    ./tools/sunxi_bootrec.py diff bootrec.bin
+#    ./tools/sunxi_bootrec.py diff baseline.bin bootrec.bin
+#
+# "diff" with one file compares the two newest runs in it, with two files
+# the newest run of each, the first file being the baseline. It exits with
+# 1 when a stage got slower than --threshold percent and --min-us.
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x43455242
+VERSION = 1
+REC_FAIL = 1 << 0
+
+# must match enum sunxi_boot_stage
+STAGES = [
+    'none',
+    'flash_probe',
+    'gpt_parse',
+    'env',
+    'logo',
+    'image_read',
+    'verify',
+    'decompress',
+    'fdt_fixup',
+    'handoff',
+]
+
+RING_HDR = struct.Struct('<IHHHHI')
+RUN_HDR = struct.Struct('<IHH')
+REC = struct.Struct('<HHIII')
+
+
+class Record:
+    def __init__(self, stage, flags, start_us, time_us, nbytes):
+        self.stage = stage
+        self.flags = flags
+        self.start_us = start_us
+        self.time_us = time_us
+        self.nbytes = nbytes
+
+    def name(self):
+        if self.stage < len(STAGES):
+            return STAGES[self.stage]
+        return 'stage%d' % self.stage
+
+
+class Run:
+    def __init__(self, seq, lost, recs):
+        self.seq = seq
+        self.lost = lost
+        self.recs = recs
+
+    def keyed(self):
+        """Return {(stage, occurrence): record}, the same stage can run twice"""
+        seen = {}
+        out = {}
+        for rec in self.recs:
+            n = seen.get(rec.stage, 0)
+            seen[rec.stage] = n + 1
+            out[(rec.stage, n)] = rec
+        return out
+
+
+def read_ring(fname):
+    """Read a ring image and return its used runs, oldest first"""
+    with open(fname, 'rb') as fd:
+        data = fd.read()
+    if len(data) < RING_HDR.size:
+        raise ValueError('%s: too short for a boot record ring' % fname)
+    magic, version, nr_runs, nr_recs, cur, _ = RING_HDR.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError('%s: bad magic %#x' % (fname, magic))
+    if version != VERSION:
+        raise ValueError('%s: unknown version %d' % (fname, version))
+    run_size = RUN_HDR.size + nr_recs * REC.size
+    if cur >= nr_runs or len(data) < RING_HDR.size + nr_runs * run_size:
+        raise ValueError('%s: truncated or corrupt ring' % fname)
+
+    runs = []
+    for i in range(1, nr_runs + 1):
+        slot = (cur + i) % nr_runs
+        off = RING_HDR.size + slot * run_size
+        seq, count, lost = RUN_HDR.unpack_from(data, off)
+        if not seq:
+            continue
+        off += RUN_HDR.size
+        recs = [Record(*REC.unpack_from(data, off + j * REC.size))
+                for j in range(min(count, nr_recs))]
+        runs.append(Run(seq, lost, recs))
+    return runs
+
+
+def dump(runs):
+    for run in runs:
+        total = sum(rec.time_us for rec in run.recs)
+        print('run %d: %d records, %d lost, %d us' %
+              (run.seq, len(run.recs), run.lost, total))
+        for rec in run.recs:
+            print('  %-12s start %10d us  %8d us  %10d bytes%s' %
+                  (rec.name(), rec.start_us, rec.time_us, rec.nbytes,
+                   '  FAIL' if rec.flags & REC_FAIL else ''))
+
+
+def diff(old, new, threshold, min_us):
+    """Print old against new per stage, return the number of regressions"""
+    old_recs = old.keyed()
+    new_recs = new.keyed()
+    regressions = 0
+
+    print('run %d -> run %d' % (old.seq, new.seq))
+    print('  %-14s %10s %10s %10s' % ('stage', 'old us', 'new us', 'delta'))
+    for key in sorted(set(old_recs) | set(new_recs)):
+        o = old_recs.get(key)
+        n = new_recs.get(key)
+        rec = n or o
+        name = rec.name() + ('#%d' % key[1] if key[1] else '')
+        if not o or not n:
+            print('  %-14s %10s %10s %10s' %
+                  (name, o.time_us if o else '-', n.time_us if n else '-',
+                   'only ' + ('new' if n else 'old')))
+            continue
+        delta = n.time_us - o.time_us
+        mark = ''
+        if (n.time_us > o.time_us * (1 + threshold / 100.0) and
+                delta > min_us):
+            mark = '  REGRESSION'
+            regressions += 1
+        if n.flags & REC_FAIL and not o.flags & REC_FAIL:
+            mark += '  FAIL'
+        print('  %-14s %10d %10d %+10d%s' %
+              (name, o.time_us, n.time_us, delta, mark))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode and compare sunxi boot stage records')
+    sub = parser.add_subparsers(dest='cmd')
+    p = sub.add_parser('dump', help='list the runs in a ring, oldest first')
+    p.add_argument('file')
+    p = sub.add_parser('diff', help='compare two runs, flag slower stages')
+    p.add_argument('file')
+    p.add_argument('file2', nargs='?',
+                   help='compare the newest run of file2 against file')
+    p.add_argument('-t', '--threshold', type=float, default=10,
+                   help='percent slower that counts as a regression (10)')
+    p.add_argument('-m', '--min-us', type=int, default=1000,
+                   help='ignore regressions below this many us (1000)')
+    args = parser.parse_args()
+
+    if not args.cmd:
+        parser.print_help()
+        return 2
+
+    try:
+        runs = read_ring(args.file)
+        if args.cmd == 'dump':
+            dump(runs)
+            return 0
+        if args.file2:
+            new_runs = read_ring(args.file2)
+            if not runs or not new_runs:
+                raise ValueError('no runs to compare')
+            old, new = runs[-1], new_runs[-1]
+        else:
+            if len(runs) < 2:
+                raise ValueError('%s: need two runs to compare' % args.file)
+            old, new = runs[-2], runs[-1]
+    except (IOError, ValueError) as e:
+        print(e, file=sys.stderr)
+        return 2
+
+    return 1 if diff(old, new, args.threshold, args.min_us) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())